@@ -0,0 +1,48 @@
+#include "bench.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+#include "../brick_game/common/perf_counters.h"
+#include "../tests/alloc_counter.h"
+
+namespace {
+
+/**
+ * Получение аппаратных счетчиков процесса. Открываются при первом замере,
+ * если задана переменная окружения BRICK_GAME_PERF
+ */
+PerfCounters* getPerfCounters() {
+  static PerfCounters counters = {{-1, -1, -1, -1, -1}, {}};
+  static bool opened = false;
+  if (!opened && std::getenv(PERF_COUNTERS_ENV)) {
+    opened = true;
+    if (!openPerfCounters(&counters))
+      std::fprintf(stderr, "perf counters are not available\n");
+  }
+  return &counters;
+}
+
+}  // namespace
+
+RegionCounters::RegionCounters() : allocs_(getAllocCount()) {
+  startPerfCounters(getPerfCounters());
+}
+
+/**
+ * Остановка счетчиков и запись значений на итерацию в отчет замера
+ *
+ * @param bench состояние замера
+ */
+void RegionCounters::report(benchmark::State& bench) {
+  PerfCounters* counters = getPerfCounters();
+  stopPerfCounters(counters);
+  bench.counters["allocs"] = benchmark::Counter(
+      getAllocCount() - allocs_, benchmark::Counter::kAvgIterations);
+  for (int i = 0; i < PERF_COUNTERS; i++)
+    if (perfCounterAvailable(counters, i))
+      bench.counters[perfCounterName(i)] = benchmark::Counter(
+          counters->values[i], benchmark::Counter::kAvgIterations);
+}
+
+BENCHMARK_MAIN();
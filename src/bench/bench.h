@@ -0,0 +1,21 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <benchmark/benchmark.h>
+
+/**
+ * Счетчики вокруг цикла замера: обращения к куче и, если задана переменная
+ * окружения BRICK_GAME_PERF, аппаратные счетчики процессора. Создается
+ * перед циклом, report() вызывается сразу после него, в отчет попадают
+ * значения на одну итерацию
+ */
+class RegionCounters {
+ public:
+  RegionCounters();
+  void report(benchmark::State& bench);
+
+ private:
+  unsigned long allocs_;
+};
+
+#endif  // BENCH_H
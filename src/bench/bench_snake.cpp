@@ -0,0 +1,199 @@
+#include "bench.h"
+
+#include "../brick_game/snake/batch.h"
+#include "../brick_game/snake/planner.h"
+
+namespace {
+
+/**
+ * Длины змейки для пустого, заполненного наполовину и почти заполненного
+ * поля
+ */
+const int kLengths[] = {4, FIELD_WIDTH * FIELD_HEIGHT / 2,
+                        FIELD_WIDTH * FIELD_HEIGHT - FIELD_WIDTH};
+
+/**
+ * Клетка змейковой траектории снизу вверх по строкам
+ *
+ * @param i номер клетки от нижнего левого угла
+ *
+ * @return координаты клетки
+ */
+std::pair<int, int> serpentine(int i) {
+  int row = i / FIELD_WIDTH;
+  int column = i % FIELD_WIDTH;
+  if (row % 2) column = FIELD_WIDTH - 1 - column;
+  return {column, FIELD_HEIGHT - 1 - row};
+}
+
+/**
+ * Состояние игры со змейкой заданной длины, уложенной змейкой от нижней
+ * строки. Голова смотрит вверх на свободную клетку, яблоко лежит в левом
+ * верхнем углу
+ *
+ * @param length длина змейки
+ *
+ * @return снимок состояния
+ */
+s21::SnakeState makeState(int length) {
+  s21::Game& game = s21::Game::getGame();
+  game.resetGame();
+  s21::SnakeState state = game.snapshot();
+  if (length > 4) {
+    for (int i = 0; i < length; i++) state.snake.pushFront(serpentine(i));
+    for (int i = 0; i < 4; i++) state.snake.popBack();
+  }
+  state.field.resetField();
+  for (size_t i = 0; i < state.snake.getLength(); i++) {
+    std::pair<int, int> segment = state.snake.getSegment(i);
+    state.field.setBlock(segment.first, segment.second, i ? 1 : 2);
+  }
+  state.appleX = 0;
+  state.appleY = 0;
+  state.field.setBlock(0, 0, 3);
+  return state;
+}
+
+/**
+ * Набор полей для замеров
+ */
+void boards(benchmark::internal::Benchmark* bench) {
+  bench->ArgName("length");
+  for (int length : kLengths) bench->Arg(length);
+}
+
+}  // namespace
+
+/**
+ * Базовая стоимость восстановления снимка, входящая в замеры ниже
+ */
+static void BM_SnakeRestore(benchmark::State& bench) {
+  s21::Game& game = s21::Game::getGame();
+  s21::SnakeState state = makeState(bench.range(0));
+  RegionCounters counters;
+  for (auto _ : bench) {
+    game.restore(state);
+    benchmark::ClobberMemory();
+  }
+  counters.report(bench);
+}
+BENCHMARK(BM_SnakeRestore)->Apply(boards);
+
+/**
+ * Перемещение змейки на одну клетку: Game::move через updateSnake
+ */
+static void BM_SnakeUpdateSnake(benchmark::State& bench) {
+  s21::Game& game = s21::Game::getGame();
+  s21::SnakeState state = makeState(bench.range(0));
+  RegionCounters counters;
+  for (auto _ : bench) {
+    game.restore(state);
+    game.resetSnake();
+    game.updateSnake();
+  }
+  counters.report(bench);
+}
+BENCHMARK(BM_SnakeUpdateSnake)->Apply(boards);
+
+/**
+ * Выбор случайной свободной клетки для яблока
+ */
+static void BM_SnakeAddApple(benchmark::State& bench) {
+  s21::Game& game = s21::Game::getGame();
+  s21::SnakeState state = makeState(bench.range(0));
+  RegionCounters counters;
+  for (auto _ : bench) {
+    game.restore(state);
+    game.addApple();
+  }
+  counters.report(bench);
+}
+BENCHMARK(BM_SnakeAddApple)->Apply(boards);
+
+/**
+ * Проверка столкновения головы с границами и телом
+ */
+static void BM_SnakeCollision(benchmark::State& bench) {
+  s21::Game& game = s21::Game::getGame();
+  game.restore(makeState(bench.range(0)));
+  RegionCounters counters;
+  for (auto _ : bench) benchmark::DoNotOptimize(game.snakeCollision());
+  counters.report(bench);
+}
+BENCHMARK(BM_SnakeCollision)->Apply(boards);
+
+/**
+ * Кадр интерфейса, на котором змейка делает шаг
+ */
+static void BM_SnakeUpdateCurrentState(benchmark::State& bench) {
+  s21::Game& game = s21::Game::getGame();
+  s21::SnakeState state = makeState(bench.range(0));
+  RegionCounters counters;
+  for (auto _ : bench) {
+    game.restore(state);
+    game.setLastActionTime(std::chrono::steady_clock::time_point());
+    benchmark::DoNotOptimize(updateCurrentState());
+  }
+  counters.report(bench);
+  game.resetGame();
+}
+BENCHMARK(BM_SnakeUpdateCurrentState)->Apply(boards);
+
+/**
+ * Шаг на копии состояния, из которого складываются партии планировщика
+ */
+static void BM_SnakeAdvanceState(benchmark::State& bench) {
+  s21::SnakeState state = makeState(bench.range(0));
+  RegionCounters counters;
+  for (auto _ : bench) {
+    s21::SnakeState copy = state;
+    s21::advanceState(copy);
+    benchmark::DoNotOptimize(copy);
+  }
+  counters.report(bench);
+}
+BENCHMARK(BM_SnakeAdvanceState)->Apply(boards);
+
+/**
+ * Решение планировщика Монте-Карло на разном числе потоков: нагрузка на
+ * все ядра, в которой видно масштабирование шага движка
+ */
+static void BM_SnakePlannerDecide(benchmark::State& bench) {
+  s21::SnakeState state = makeState(FIELD_WIDTH * FIELD_HEIGHT / 2);
+  s21::MonteCarloPlanner planner(bench.range(0), PLANNER_PLAYOUTS,
+                                 PLANNER_DEPTH, std::chrono::seconds(10));
+  RegionCounters counters;
+  for (auto _ : bench) benchmark::DoNotOptimize(planner.decide(state));
+  counters.report(bench);
+  bench.counters["playouts"] = benchmark::Counter(
+      planner.getPlayouts(), benchmark::Counter::kIsRate);
+  s21::Game::getGame().resetGame();
+}
+BENCHMARK(BM_SnakePlannerDecide)
+    ->ArgName("threads")
+    ->RangeMultiplier(2)
+    ->Range(1, 8)
+    ->UseRealTime();
+
+/**
+ * Шаг пакета сред случайными направлениями: сравнивается с advanceState
+ * в пересчете на одну среду
+ */
+static void BM_SnakeBatchStep(benchmark::State& bench) {
+  unsigned int count = bench.range(0);
+  s21::SnakeBatch batch(count, RANDOM_DEFAULT_SEED);
+  std::vector<uint8_t> actions(count), dones(count);
+  std::vector<float> rewards(count);
+  std::vector<s21::SnakeObservation> observations(count);
+  uint32_t random = RANDOM_DEFAULT_SEED;
+  for (uint8_t& action : actions) action = nextRandom(&random) % 4;
+  RegionCounters counters;
+  for (auto _ : bench) {
+    batch.step(actions.data(), rewards.data(), dones.data(),
+               observations.data());
+    benchmark::ClobberMemory();
+  }
+  counters.report(bench);
+  bench.SetItemsProcessed(bench.iterations() * count);
+}
+BENCHMARK(BM_SnakeBatchStep)->ArgName("envs")->Arg(64)->Arg(1024)->Arg(4096);
@@ -0,0 +1,155 @@
+#include <vector>
+
+#include "bench.h"
+
+extern "C" {
+#include "../brick_game/tetris/tetris_vec.h"
+}
+
+namespace {
+
+enum Board { EMPTY, MID, NEAR_FULL };
+
+/**
+ * Состояние игры с заполненной нижней частью поля. В каждой строке есть
+ * дыра, поэтому строки не стираются, кроме полных нижних строк lines
+ *
+ * @param board заполненность поля
+ * @param lines количество полных нижних строк
+ *
+ * @return снимок состояния
+ */
+TetrisState makeState(int board, int lines) {
+  static const int kTops[] = {FIELD_HEIGHT, FIELD_HEIGHT / 2, 6};
+  seedGame(RANDOM_DEFAULT_SEED);
+  Field* field = &getGame()->field;
+  for (int i = kTops[board]; i < FIELD_HEIGHT; i++)
+    for (int j = 0; j < FIELD_WIDTH; j++)
+      field->blocks[i * FIELD_WIDTH + j] = j != i * 3 % FIELD_WIDTH;
+  for (int i = FIELD_HEIGHT - lines; i < FIELD_HEIGHT; i++)
+    memset(field->blocks + i * FIELD_WIDTH, 1, FIELD_WIDTH);
+  TetrisState state;
+  snapshotGame(&state);
+  return state;
+}
+
+/**
+ * Набор полей для замеров
+ */
+void boards(benchmark::internal::Benchmark* bench) {
+  bench->ArgName("board")->DenseRange(EMPTY, NEAR_FULL);
+}
+
+}  // namespace
+
+/**
+ * Базовая стоимость восстановления снимка, входящая в замеры ниже
+ */
+static void BM_TetrisRestore(benchmark::State& bench) {
+  TetrisState state = makeState(bench.range(0), 0);
+  RegionCounters counters;
+  for (auto _ : bench) {
+    restoreGame(&state);
+    benchmark::ClobberMemory();
+  }
+  counters.report(bench);
+}
+BENCHMARK(BM_TetrisRestore)->Apply(boards);
+
+/**
+ * Проверка столкновения фигуры с границами и блоками поля
+ */
+static void BM_TetrisFigureCollision(benchmark::State& bench) {
+  TetrisState state = makeState(bench.range(0), 0);
+  restoreGame(&state);
+  RegionCounters counters;
+  for (auto _ : bench) benchmark::DoNotOptimize(figureCollision());
+  counters.report(bench);
+}
+BENCHMARK(BM_TetrisFigureCollision)->Apply(boards);
+
+/**
+ * Вращение текущей фигуры
+ */
+static void BM_TetrisRotateFigure(benchmark::State& bench) {
+  TetrisState state = makeState(bench.range(0), 0);
+  restoreGame(&state);
+  RegionCounters counters;
+  for (auto _ : bench) benchmark::DoNotOptimize(rotateFigure());
+  counters.report(bench);
+}
+BENCHMARK(BM_TetrisRotateFigure)->Apply(boards);
+
+/**
+ * Удаление заполненных строк
+ */
+static void BM_TetrisEraseLines(benchmark::State& bench) {
+  TetrisState state = makeState(bench.range(0), bench.range(1));
+  RegionCounters counters;
+  for (auto _ : bench) {
+    restoreGame(&state);
+    benchmark::DoNotOptimize(eraseLines());
+  }
+  counters.report(bench);
+}
+BENCHMARK(BM_TetrisEraseLines)
+    ->ArgNames({"board", "lines"})
+    ->ArgsProduct({{EMPTY, MID, NEAR_FULL}, {0, 4}});
+
+/**
+ * Мгновенное падение фигуры с фиксацией и выбором следующей
+ */
+static void BM_TetrisHardDrop(benchmark::State& bench) {
+  TetrisState state = makeState(bench.range(0), 0);
+  RegionCounters counters;
+  for (auto _ : bench) {
+    restoreGame(&state);
+    userInput(Down, 0);
+  }
+  counters.report(bench);
+}
+BENCHMARK(BM_TetrisHardDrop)->Apply(boards);
+
+/**
+ * Кадр интерфейса, на котором фигура делает шаг
+ */
+static void BM_TetrisUpdateCurrentState(benchmark::State& bench) {
+  TetrisState state = makeState(bench.range(0), 0);
+  RegionCounters counters;
+  for (auto _ : bench) {
+    restoreGame(&state);
+    *getFrameDelayLeft() = 0;
+    benchmark::DoNotOptimize(updateCurrentState());
+  }
+  counters.report(bench);
+  resetSingletones();
+}
+BENCHMARK(BM_TetrisUpdateCurrentState)->Apply(boards);
+
+/**
+ * Шаг пакета сред со случайными действиями в одном и в нескольких потоках
+ */
+static void BM_TetrisVecStep(benchmark::State& bench) {
+  unsigned int count = bench.range(0);
+  TetrisVec* vec = createTetrisVec(count, RANDOM_DEFAULT_SEED, bench.range(1));
+  std::vector<UserAction_t> actions(count);
+  std::vector<uint8_t> dones(count);
+  std::vector<float> rewards(count);
+  std::vector<TetrisObservation> observations(count);
+  const UserAction_t moves[] = {Left, Right, Action, Up, Down};
+  uint32_t random = RANDOM_DEFAULT_SEED;
+  for (UserAction_t& action : actions) action = moves[nextRandom(&random) % 5];
+  RegionCounters counters;
+  for (auto _ : bench) {
+    stepTetrisVec(vec, actions.data(), rewards.data(), dones.data(),
+                  observations.data());
+    benchmark::ClobberMemory();
+  }
+  counters.report(bench);
+  bench.SetItemsProcessed(bench.iterations() * count);
+  freeTetrisVec(vec);
+}
+BENCHMARK(BM_TetrisVecStep)
+    ->ArgNames({"envs", "threads"})
+    ->ArgsProduct({{64, 1024}, {1, 4}})
+    ->UseRealTime();
@@ -0,0 +1,120 @@
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "engine_stats.h"
+
+#include <string.h>
+#include <time.h>
+
+/**
+ * Инициализация статистики
+ *
+ * @param stats статистика
+ * @param names названия фаз
+ * @param phaseCount количество фаз, не больше ENGINE_STATS_MAX_PHASES
+ */
+void initEngineStats(EngineStats* stats, const char* const* names,
+                     unsigned int phaseCount) {
+  memset(stats, 0, sizeof(*stats));
+  if (phaseCount > ENGINE_STATS_MAX_PHASES)
+    phaseCount = ENGINE_STATS_MAX_PHASES;
+  stats->phaseCount = phaseCount;
+  for (unsigned int i = 0; i < phaseCount; i++)
+    stats->phases[i].name = names[i];
+}
+
+/**
+ * Обнуление счетчиков с сохранением названий фаз
+ *
+ * @param stats статистика
+ */
+void resetEngineStats(EngineStats* stats) {
+  for (unsigned int i = 0; i < stats->phaseCount; i++) {
+    const char* name = stats->phases[i].name;
+    memset(&stats->phases[i], 0, sizeof(stats->phases[i]));
+    stats->phases[i].name = name;
+  }
+}
+
+/**
+ * Текущее время монотонных часов
+ *
+ * @return время в наносекундах
+ */
+uint64_t engineStatsNow(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t)now.tv_sec * 1000000000u + (uint64_t)now.tv_nsec;
+}
+
+/**
+ * Номер корзины гистограммы: двоичный логарифм длительности
+ *
+ * @param ns длительность в наносекундах
+ *
+ * @return номер корзины
+ */
+unsigned int engineStatsBucket(uint64_t ns) {
+  unsigned int bucket = 0;
+  while (ns > 1 && bucket < ENGINE_STATS_BUCKETS - 1) {
+    ns >>= 1;
+    bucket++;
+  }
+  return bucket;
+}
+
+/**
+ * Учет одного вызова фазы
+ *
+ * @param stats статистика
+ * @param phase номер фазы
+ * @param ns длительность в наносекундах
+ */
+void recordEnginePhase(EngineStats* stats, unsigned int phase, uint64_t ns) {
+  EnginePhaseStats* p = &stats->phases[phase];
+  p->count++;
+  p->totalNs += ns;
+  if (p->maxNs < ns) p->maxNs = ns;
+  p->histogram[engineStatsBucket(ns)]++;
+}
+
+/**
+ * Оценка перцентиля по гистограмме
+ *
+ * @param phase статистика фазы
+ * @param percentile перцентиль от 0 до 1
+ *
+ * @return верхняя граница корзины, в которую попал перцентиль, в
+ * наносекундах, но не больше максимума
+ */
+uint64_t engineStatsPercentile(const EnginePhaseStats* phase,
+                               double percentile) {
+  uint64_t target = (uint64_t)(percentile * phase->count + 0.5);
+  uint64_t seen = 0, bound = 0;
+  for (unsigned int i = 0; i < ENGINE_STATS_BUCKETS && seen < target; i++) {
+    seen += phase->histogram[i];
+    bound = (uint64_t)2 << i;
+  }
+  return bound < phase->maxNs ? bound : phase->maxNs;
+}
+
+/**
+ * Вывод таблицы статистики
+ *
+ * @param stats статистика
+ * @param file поток вывода
+ */
+void printEngineStats(const EngineStats* stats, FILE* file) {
+  fprintf(file, "%-16s %10s %10s %10s %10s %10s\n", "phase", "count",
+          "mean ns", "p50 ns", "p99 ns", "max ns");
+  for (unsigned int i = 0; i < stats->phaseCount; i++) {
+    const EnginePhaseStats* p = &stats->phases[i];
+    fprintf(file, "%-16s %10llu %10llu %10llu %10llu %10llu\n", p->name,
+            (unsigned long long)p->count,
+            (unsigned long long)(p->count ? p->totalNs / p->count : 0),
+            (unsigned long long)engineStatsPercentile(p, 0.5),
+            (unsigned long long)engineStatsPercentile(p, 0.99),
+            (unsigned long long)p->maxNs);
+  }
+}
@@ -0,0 +1,61 @@
+#ifndef ENGINE_STATS_H
+#define ENGINE_STATS_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#define ENGINE_STATS_MAX_PHASES 8
+#define ENGINE_STATS_BUCKETS 32
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Статистика одной фазы такта: число вызовов, суммарное и максимальное
+ * время и гистограмма длительностей. Корзина i содержит вызовы длительностью
+ * от 2^i до 2^(i+1) наносекунд
+ */
+typedef struct EnginePhaseStats {
+  const char* name;
+  uint64_t count;
+  uint64_t totalNs;
+  uint64_t maxNs;
+  uint32_t histogram[ENGINE_STATS_BUCKETS];
+} EnginePhaseStats;
+
+/**
+ * Статистика движка по фазам. Пишется потоком движка без блокировок,
+ * поэтому читать ее из другого потока можно только для приблизительной
+ * оценки
+ */
+typedef struct EngineStats {
+  unsigned int phaseCount;
+  EnginePhaseStats phases[ENGINE_STATS_MAX_PHASES];
+} EngineStats;
+
+void initEngineStats(EngineStats* stats, const char* const* names,
+                     unsigned int phaseCount);
+void resetEngineStats(EngineStats* stats);
+uint64_t engineStatsNow(void);
+unsigned int engineStatsBucket(uint64_t ns);
+void recordEnginePhase(EngineStats* stats, unsigned int phase, uint64_t ns);
+uint64_t engineStatsPercentile(const EnginePhaseStats* phase,
+                               double percentile);
+void printEngineStats(const EngineStats* stats, FILE* file);
+
+#ifdef __cplusplus
+}
+#endif
+
+// Сборка с -DENGINE_STATS_DISABLED убирает замеры из движков полностью
+#ifdef ENGINE_STATS_DISABLED
+#define ENGINE_STATS_BEGIN(start)
+#define ENGINE_STATS_END(stats, phase, start)
+#else
+#define ENGINE_STATS_BEGIN(start) uint64_t start = engineStatsNow()
+#define ENGINE_STATS_END(stats, phase, start) \
+  recordEnginePhase((stats), (phase), engineStatsNow() - (start))
+#endif
+
+#endif  // ENGINE_STATS_H
@@ -0,0 +1,90 @@
+#include "latency.h"
+
+#include <stdatomic.h>
+
+/**
+ * Ввод, примененный движком к кадру generation
+ */
+typedef struct LatencySample {
+  uint64_t inputNs;
+  uint64_t applyNs;
+  uint64_t generation;
+} LatencySample;
+
+/**
+ * Очередь вводов от потока движка к потоку вывода. В консольных
+ * интерфейсах это один поток, в Qt - поток движка и графический поток
+ */
+typedef struct LatencyProbe {
+  LatencySample samples[LATENCY_PENDING];
+  _Atomic unsigned int head;
+  _Atomic unsigned int tail;
+  EngineStats stats;
+} LatencyProbe;
+
+/**
+ * Получение единственного измерителя задержки. Инициализируется статически,
+ * так что первое обращение из любого потока безопасно
+ */
+static LatencyProbe* getLatencyProbe(void) {
+  static LatencyProbe probe = {
+      .stats = {LATENCY_PHASES,
+                {{.name = "inputToApply"},
+                 {.name = "applyToPresent"},
+                 {.name = "inputToPresent"}}}};
+  return &probe;
+}
+
+/**
+ * Учет ввода, примененного движком. Вызывается потоком движка сразу после
+ * userInput()
+ *
+ * @param inputNs время поступления ввода в обработчик клавиш
+ * @param generation номер первого кадра, в котором виден результат ввода
+ */
+void recordInputApplied(uint64_t inputNs, uint64_t generation) {
+  LatencyProbe* probe = getLatencyProbe();
+  unsigned int head = atomic_load_explicit(&probe->head, memory_order_relaxed);
+  unsigned int tail = atomic_load_explicit(&probe->tail, memory_order_acquire);
+  // Если вывод отстал, новые вводы не учитываются
+  if (head - tail == LATENCY_PENDING) return;
+  LatencySample* sample = &probe->samples[head % LATENCY_PENDING];
+  sample->inputNs = inputNs;
+  sample->applyNs = engineStatsNow();
+  sample->generation = generation;
+  atomic_store_explicit(&probe->head, head + 1, memory_order_release);
+}
+
+/**
+ * Учет выведенного кадра: для всех вводов, видимых в этом кадре, задержка
+ * заносится в гистограммы. Вызывается потоком вывода после вывода кадра
+ *
+ * @param generation номер выведенного кадра
+ */
+void recordFramePresented(uint64_t generation) {
+  LatencyProbe* probe = getLatencyProbe();
+  uint64_t now = engineStatsNow();
+  unsigned int tail = atomic_load_explicit(&probe->tail, memory_order_relaxed);
+  unsigned int head = atomic_load_explicit(&probe->head, memory_order_acquire);
+  for (; tail != head; tail++) {
+    const LatencySample* sample = &probe->samples[tail % LATENCY_PENDING];
+    if (sample->generation > generation) break;
+    recordEnginePhase(&probe->stats, LATENCY_INPUT_TO_APPLY,
+                      sample->applyNs - sample->inputNs);
+    recordEnginePhase(&probe->stats, LATENCY_APPLY_TO_PRESENT,
+                      now - sample->applyNs);
+    recordEnginePhase(&probe->stats, LATENCY_INPUT_TO_PRESENT,
+                      now - sample->inputNs);
+  }
+  atomic_store_explicit(&probe->tail, tail, memory_order_release);
+}
+
+/**
+ * Получение гистограмм задержки по отрезкам
+ */
+EngineStats* getLatencyStats(void) { return &getLatencyProbe()->stats; }
+
+/**
+ * Сброс гистограмм. Очередь не трогается, чтобы не мешать потоку движка
+ */
+void resetLatency(void) { resetEngineStats(&getLatencyProbe()->stats); }
@@ -0,0 +1,36 @@
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include <stdint.h>
+
+#include "engine_stats.h"
+
+#define LATENCY_FLAG "--latency"
+
+// Количество вводов, ожидающих вывода на экран, степень двойки
+#define LATENCY_PENDING 256
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Отрезки задержки ввода
+ */
+enum LATENCY_PHASE {
+  LATENCY_INPUT_TO_APPLY,
+  LATENCY_APPLY_TO_PRESENT,
+  LATENCY_INPUT_TO_PRESENT,
+  LATENCY_PHASES
+};
+
+void recordInputApplied(uint64_t inputNs, uint64_t generation);
+void recordFramePresented(uint64_t generation);
+EngineStats* getLatencyStats(void);
+void resetLatency(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // LATENCY_H
@@ -0,0 +1,295 @@
+#include "npy_writer.h"
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Ширина наибольшего количества записей: место под него оставляется в
+// заголовке при открытии, а настоящее количество пишется при закрытии
+#define NPY_COUNT_WIDTH 20
+
+struct NpyWriter {
+  FILE* file;
+  char descr[NPY_MAX_HEADER];
+  size_t headerSize;
+  size_t recordSize;
+  size_t offsets[NPY_MAX_COLUMNS];
+  size_t sizes[NPY_MAX_COLUMNS];
+  unsigned int columnCount;
+  char* buffers[2];
+  unsigned int chunkRecords;
+  // Заполняемый буфер и записи в нем
+  unsigned int filling;
+  unsigned int filled;
+  unsigned long records;
+  unsigned long stalls;
+  pthread_t thread;
+  pthread_mutex_t mutex;
+  pthread_cond_t wake;
+  pthread_cond_t done;
+  // Буфер, отданный фоновому потоку, -1 - поток свободен
+  int pending;
+  size_t pendingBytes;
+  bool stop;
+  bool failed;
+};
+
+/**
+ * Размер элемента типа numpy: число после порядка байтов и вида, "<f4" - 4
+ *
+ * @return размер, 0 - тип не распознан
+ */
+static size_t typeSize(const char* type) {
+  if (!type || !type[0] || !strchr("<>|=", type[0]) || !type[1]) return 0;
+  return strtoul(type + 2, NULL, 10);
+}
+
+/**
+ * Описание типа записи для заголовка: список столбцов numpy
+ *
+ * @return 0 - OK
+ * @return -1 - описание не помещается в заголовок
+ */
+static int formatDescr(NpyWriter* writer, const NpyColumn* columns) {
+  size_t length = 0;
+  for (unsigned int i = 0; i < writer->columnCount; i++) {
+    const NpyColumn* column = &columns[i];
+    int written =
+        column->count == 1
+            ? snprintf(writer->descr + length, NPY_MAX_HEADER - length,
+                       "%s('%s', '%s')", i ? ", " : "", column->name,
+                       column->type)
+            : snprintf(writer->descr + length, NPY_MAX_HEADER - length,
+                       "%s('%s', '%s', (%u,))", i ? ", " : "", column->name,
+                       column->type, column->count);
+    if (written < 0 || (size_t)written >= NPY_MAX_HEADER - length) return -1;
+    length += written;
+  }
+  return 0;
+}
+
+/**
+ * Запись заголовка версии 1.0: магия, версия, длина словаря и сам
+ * словарь, дополненный пробелами до headerSize
+ *
+ * @param records количество записей в массиве
+ *
+ * @return 0 - OK
+ * @return -1 - ошибка записи
+ */
+static int writeHeader(NpyWriter* writer, unsigned long records) {
+  char header[NPY_MAX_HEADER];
+  memcpy(header, NPY_MAGIC, 6);
+  header[6] = 1;
+  header[7] = 0;
+  size_t dictSize = writer->headerSize - 10;
+  header[8] = dictSize & 0xff;
+  header[9] = dictSize >> 8;
+  int length = snprintf(header + 10, NPY_MAX_HEADER - 10,
+                        "{'descr': [%s], 'fortran_order': False, "
+                        "'shape': (%lu,), }",
+                        writer->descr, records);
+  memset(header + 10 + length, ' ', dictSize - length);
+  header[writer->headerSize - 1] = '\n';
+  return fwrite(header, 1, writer->headerSize, writer->file) ==
+                 writer->headerSize
+             ? 0
+             : -1;
+}
+
+/**
+ * Фоновый поток: запись отданных буферов, пока писатель не закрыт
+ */
+static void* writerLoop(void* arg) {
+  NpyWriter* writer = arg;
+  pthread_mutex_lock(&writer->mutex);
+  while (1) {
+    while (writer->pending < 0 && !writer->stop)
+      pthread_cond_wait(&writer->wake, &writer->mutex);
+    if (writer->pending < 0) break;
+    const char* buffer = writer->buffers[writer->pending];
+    size_t bytes = writer->pendingBytes;
+    pthread_mutex_unlock(&writer->mutex);
+    bool written = fwrite(buffer, 1, bytes, writer->file) == bytes;
+    pthread_mutex_lock(&writer->mutex);
+    if (!written) writer->failed = 1;
+    writer->pending = -1;
+    pthread_cond_signal(&writer->done);
+  }
+  pthread_mutex_unlock(&writer->mutex);
+  return NULL;
+}
+
+/**
+ * Передача заполняемого буфера фоновому потоку и переход ко второму.
+ * Ожидание бывает, только если второй буфер еще пишется
+ */
+static void handOff(NpyWriter* writer) {
+  pthread_mutex_lock(&writer->mutex);
+  if (writer->pending >= 0) writer->stalls++;
+  while (writer->pending >= 0)
+    pthread_cond_wait(&writer->done, &writer->mutex);
+  writer->pending = writer->filling;
+  writer->pendingBytes = writer->filled * writer->recordSize;
+  pthread_cond_signal(&writer->wake);
+  pthread_mutex_unlock(&writer->mutex);
+  writer->filling ^= 1;
+  writer->filled = 0;
+}
+
+/**
+ * Освобождение памяти писателя без закрытия файла и потока
+ */
+static void freeNpyWriter(NpyWriter* writer) {
+  free(writer->buffers[0]);
+  free(writer->buffers[1]);
+  free(writer);
+}
+
+/**
+ * Создание файла и запуск фонового потока
+ *
+ * @param path путь к файлу
+ * @param columns столбцы записи, поля лежат подряд без выравнивания
+ * @param columnCount количество столбцов, не больше NPY_MAX_COLUMNS
+ * @param chunkRecords записей в каждом из двух буферов
+ *
+ * @return писатель
+ * @return NULL - неверные столбцы, не хватило памяти или файл не создан
+ */
+NpyWriter* openNpyWriter(const char* path, const NpyColumn* columns,
+                         unsigned int columnCount, unsigned int chunkRecords) {
+  if (!columnCount || columnCount > NPY_MAX_COLUMNS || !chunkRecords)
+    return NULL;
+  NpyWriter* writer = calloc(1, sizeof(NpyWriter));
+  if (!writer) return NULL;
+  writer->columnCount = columnCount;
+  for (unsigned int i = 0; i < columnCount; i++) {
+    size_t size = typeSize(columns[i].type) * columns[i].count;
+    if (!size) {
+      free(writer);
+      return NULL;
+    }
+    writer->offsets[i] = writer->recordSize;
+    writer->sizes[i] = size;
+    writer->recordSize += size;
+  }
+  // Место под словарь с самым длинным количеством записей
+  size_t dictSize = strlen("{'descr': [], 'fortran_order': False, "
+                           "'shape': (,), }\n") +
+                    NPY_COUNT_WIDTH;
+  if (formatDescr(writer, columns)) {
+    free(writer);
+    return NULL;
+  }
+  dictSize += strlen(writer->descr);
+  writer->headerSize =
+      (10 + dictSize + NPY_ALIGNMENT - 1) / NPY_ALIGNMENT * NPY_ALIGNMENT;
+  writer->chunkRecords = chunkRecords;
+  writer->buffers[0] = malloc(writer->recordSize * chunkRecords);
+  writer->buffers[1] = malloc(writer->recordSize * chunkRecords);
+  writer->pending = -1;
+  if (writer->headerSize > NPY_MAX_HEADER || !writer->buffers[0] ||
+      !writer->buffers[1]) {
+    freeNpyWriter(writer);
+    return NULL;
+  }
+  writer->file = fopen(path, "wb");
+  if (!writer->file) {
+    freeNpyWriter(writer);
+    return NULL;
+  }
+  pthread_mutex_init(&writer->mutex, NULL);
+  pthread_cond_init(&writer->wake, NULL);
+  pthread_cond_init(&writer->done, NULL);
+  if (writeHeader(writer, 0) ||
+      pthread_create(&writer->thread, NULL, writerLoop, writer)) {
+    pthread_cond_destroy(&writer->done);
+    pthread_cond_destroy(&writer->wake);
+    pthread_mutex_destroy(&writer->mutex);
+    fclose(writer->file);
+    freeNpyWriter(writer);
+    return NULL;
+  }
+  return writer;
+}
+
+/**
+ * Дописывание оставшихся записей, остановка фонового потока и запись
+ * итогового количества записей в заголовок
+ *
+ * @return 0 - OK
+ * @return -1 - ошибка записи, файл может быть неполным
+ */
+int closeNpyWriter(NpyWriter* writer) {
+  if (!writer) return -1;
+  if (writer->filled) handOff(writer);
+  pthread_mutex_lock(&writer->mutex);
+  writer->stop = 1;
+  pthread_cond_signal(&writer->wake);
+  pthread_mutex_unlock(&writer->mutex);
+  pthread_join(writer->thread, NULL);
+  pthread_cond_destroy(&writer->done);
+  pthread_cond_destroy(&writer->wake);
+  pthread_mutex_destroy(&writer->mutex);
+
+  int status = writer->failed ? -1 : 0;
+  if (fseek(writer->file, 0, SEEK_SET) ||
+      writeHeader(writer, writer->records))
+    status = -1;
+  if (fclose(writer->file)) status = -1;
+  freeNpyWriter(writer);
+  return status;
+}
+
+/**
+ * Получение места под следующую запись. Запись обнулена и попадет в файл
+ * вместе со своим буфером; указатель действителен до следующего вызова
+ *
+ * @return запись размером getNpyRecordSize()
+ */
+void* nextNpyRecord(NpyWriter* writer) {
+  if (writer->filled == writer->chunkRecords) handOff(writer);
+  char* record = writer->buffers[writer->filling] +
+                 writer->filled++ * writer->recordSize;
+  writer->records++;
+  memset(record, 0, writer->recordSize);
+  return record;
+}
+
+/**
+ * Заполнение столбца записи
+ *
+ * @param record запись из nextNpyRecord()
+ * @param column номер столбца
+ * @param value значение: count элементов типа столбца подряд
+ */
+void setNpyColumn(const NpyWriter* writer, void* record, unsigned int column,
+                  const void* value) {
+  memcpy((char*)record + writer->offsets[column], value,
+         writer->sizes[column]);
+}
+
+/**
+ * Получение размера записи в байтах
+ */
+size_t getNpyRecordSize(const NpyWriter* writer) {
+  return writer->recordSize;
+}
+
+/**
+ * Получение количества записей с момента открытия
+ */
+unsigned long getNpyRecords(const NpyWriter* writer) {
+  return writer->records;
+}
+
+/**
+ * Получение количества ожиданий фонового потока: сколько раз оба буфера
+ * оказывались заняты
+ */
+unsigned long getNpyStalls(const NpyWriter* writer) {
+  return writer->stalls;
+}
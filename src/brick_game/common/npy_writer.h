@@ -0,0 +1,50 @@
+#ifndef NPY_WRITER_H
+#define NPY_WRITER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define NPY_MAGIC "\x93NUMPY"
+// Данные начинаются с границы 64 байт, как у файлов самого numpy
+#define NPY_ALIGNMENT 64
+#define NPY_MAX_COLUMNS 16
+#define NPY_MAX_HEADER 4096
+#define NPY_CHUNK_RECORDS 4096
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Столбец записи: имя поля, тип numpy вида "<f4", "<u2" или "|u1" и
+ * количество элементов, 1 - скаляр
+ */
+typedef struct NpyColumn {
+  const char* name;
+  const char* type;
+  unsigned int count;
+} NpyColumn;
+
+/**
+ * Потоковая запись массива записей в файл .npy. Записи копятся в одном из
+ * двух заранее выделенных буферов; заполненный буфер пишет на диск фоновый
+ * поток, пока заполняется второй. Файл - одномерный массив структурного
+ * типа, его можно открыть numpy.load(path, mmap_mode="r")
+ */
+typedef struct NpyWriter NpyWriter;
+
+NpyWriter* openNpyWriter(const char* path, const NpyColumn* columns,
+                         unsigned int columnCount, unsigned int chunkRecords);
+int closeNpyWriter(NpyWriter* writer);
+void* nextNpyRecord(NpyWriter* writer);
+void setNpyColumn(const NpyWriter* writer, void* record, unsigned int column,
+                  const void* value);
+size_t getNpyRecordSize(const NpyWriter* writer);
+unsigned long getNpyRecords(const NpyWriter* writer);
+unsigned long getNpyStalls(const NpyWriter* writer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // NPY_WRITER_H
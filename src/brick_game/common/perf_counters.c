@@ -0,0 +1,180 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include "perf_counters.h"
+
+#include <string.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/**
+ * Названия счетчиков в отчетах
+ */
+static const char* const perfCounterNames[PERF_COUNTERS] = {
+    "cycles", "instructions", "L1dMisses", "LLCMisses", "branchMisses"};
+
+#ifdef __linux__
+
+/**
+ * Значение счетчика вместе со временем, когда он был включен и когда
+ * действительно считал. Если счетчиков больше, чем регистров процессора,
+ * ядро чередует их, и значение приходится масштабировать
+ */
+typedef struct PerfReading {
+  uint64_t value;
+  uint64_t enabled;
+  uint64_t running;
+} PerfReading;
+
+/**
+ * Открытие счетчика текущего потока. Считаются только события
+ * пользовательского кода, что разрешено без привилегий при
+ * perf_event_paranoid не выше 2
+ *
+ * @param type тип события
+ * @param config событие
+ *
+ * @return дескриптор счетчика
+ * @return -1 - счетчик недоступен
+ */
+static int openPerfCounter(uint32_t type, uint64_t config) {
+  struct perf_event_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = type;
+  attr.config = config;
+  attr.disabled = 1;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  attr.read_format =
+      PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+  return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1,
+                      PERF_FLAG_FD_CLOEXEC);
+}
+
+#endif
+
+/**
+ * Открытие всех счетчиков. Счетчики открываются по отдельности, а не
+ * группой, чтобы отсутствие одного события не отключало остальные
+ *
+ * @param counters набор счетчиков
+ *
+ * @return количество открытых счетчиков, 0 - счетчики недоступны
+ */
+int openPerfCounters(PerfCounters* counters) {
+  memset(counters->values, 0, sizeof(counters->values));
+  int opened = 0;
+  for (int i = 0; i < PERF_COUNTERS; i++) counters->fds[i] = -1;
+#ifdef __linux__
+  const uint32_t types[PERF_COUNTERS] = {
+      PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE,
+      PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE};
+  const uint64_t configs[PERF_COUNTERS] = {
+      PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+      PERF_COUNT_HW_CACHE_L1D | PERF_COUNT_HW_CACHE_OP_READ << 8 |
+          PERF_COUNT_HW_CACHE_RESULT_MISS << 16,
+      PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+  for (int i = 0; i < PERF_COUNTERS; i++) {
+    counters->fds[i] = openPerfCounter(types[i], configs[i]);
+    if (counters->fds[i] >= 0) opened++;
+  }
+#endif
+  return opened;
+}
+
+/**
+ * Закрытие счетчиков
+ *
+ * @param counters набор счетчиков
+ */
+void closePerfCounters(PerfCounters* counters) {
+  for (int i = 0; i < PERF_COUNTERS; i++) {
+#ifdef __linux__
+    if (counters->fds[i] >= 0) close(counters->fds[i]);
+#endif
+    counters->fds[i] = -1;
+  }
+}
+
+/**
+ * Проверка, что счетчик открыт
+ *
+ * @param counters набор счетчиков
+ * @param counter номер счетчика
+ */
+bool perfCounterAvailable(const PerfCounters* counters, int counter) {
+  return counters->fds[counter] >= 0;
+}
+
+/**
+ * Получение названия счетчика
+ *
+ * @param counter номер счетчика
+ */
+const char* perfCounterName(int counter) { return perfCounterNames[counter]; }
+
+/**
+ * Обнуление и запуск счетчиков перед замеряемым участком
+ *
+ * @param counters набор счетчиков
+ */
+void startPerfCounters(PerfCounters* counters) {
+  memset(counters->values, 0, sizeof(counters->values));
+#ifdef __linux__
+  for (int i = 0; i < PERF_COUNTERS; i++)
+    if (counters->fds[i] >= 0) ioctl(counters->fds[i], PERF_EVENT_IOC_RESET);
+  for (int i = 0; i < PERF_COUNTERS; i++)
+    if (counters->fds[i] >= 0) ioctl(counters->fds[i], PERF_EVENT_IOC_ENABLE);
+#endif
+}
+
+/**
+ * Остановка счетчиков после замеряемого участка и чтение значений
+ *
+ * @param counters набор счетчиков
+ */
+void stopPerfCounters(PerfCounters* counters) {
+#ifdef __linux__
+  for (int i = 0; i < PERF_COUNTERS; i++)
+    if (counters->fds[i] >= 0) ioctl(counters->fds[i], PERF_EVENT_IOC_DISABLE);
+  for (int i = 0; i < PERF_COUNTERS; i++) {
+    PerfReading reading;
+    if (counters->fds[i] < 0 ||
+        read(counters->fds[i], &reading, sizeof(reading)) != sizeof(reading))
+      continue;
+    if (reading.running && reading.running < reading.enabled)
+      reading.value = (uint64_t)((double)reading.value * reading.enabled /
+                                 reading.running);
+    counters->values[i] = reading.value;
+  }
+#endif
+}
+
+/**
+ * Вывод значений счетчиков в пересчете на одну операцию
+ *
+ * @param counters набор счетчиков
+ * @param operations количество операций на замеряемом участке
+ * @param file файл для вывода
+ */
+void printPerfCounters(const PerfCounters* counters, uint64_t operations,
+                       FILE* file) {
+  if (!operations) operations = 1;
+  fprintf(file, "%-14s %14s %12s\n", "counter", "total", "per op");
+  for (int i = 0; i < PERF_COUNTERS; i++) {
+    if (!perfCounterAvailable(counters, i)) {
+      fprintf(file, "%-14s %14s %12s\n", perfCounterNames[i], "-", "-");
+      continue;
+    }
+    fprintf(file, "%-14s %14llu %12.2f\n", perfCounterNames[i],
+            (unsigned long long)counters->values[i],
+            (double)counters->values[i] / operations);
+  }
+}
@@ -0,0 +1,49 @@
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// Переменная окружения, включающая аппаратные счетчики в замерах
+#define PERF_COUNTERS_ENV "BRICK_GAME_PERF"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Аппаратные счетчики процессора
+ */
+enum PERF_COUNTER {
+  PERF_CYCLES,
+  PERF_INSTRUCTIONS,
+  PERF_L1D_MISSES,
+  PERF_LLC_MISSES,
+  PERF_BRANCH_MISSES,
+  PERF_COUNTERS
+};
+
+/**
+ * Набор счетчиков текущего потока. Счетчик, который ядро не дает открыть,
+ * остается недоступным и всегда равен нулю, остальные работают
+ */
+typedef struct PerfCounters {
+  int fds[PERF_COUNTERS];
+  uint64_t values[PERF_COUNTERS];
+} PerfCounters;
+
+int openPerfCounters(PerfCounters* counters);
+void closePerfCounters(PerfCounters* counters);
+bool perfCounterAvailable(const PerfCounters* counters, int counter);
+const char* perfCounterName(int counter);
+void startPerfCounters(PerfCounters* counters);
+void stopPerfCounters(PerfCounters* counters);
+void printPerfCounters(const PerfCounters* counters, uint64_t operations,
+                       FILE* file);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // PERF_COUNTERS_H
@@ -0,0 +1,45 @@
+#ifndef RANDOM_H
+#define RANDOM_H
+
+#include <stdint.h>
+
+#define RANDOM_DEFAULT_SEED 0x9e3779b9u
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Начальное состояние генератора по зерну. Нулевое состояние недопустимо
+ * для xorshift, поэтому заменяется постоянным
+ *
+ * @param seed зерно
+ *
+ * @return состояние генератора
+ */
+static inline uint32_t seedRandom(uint32_t seed) {
+  return seed ? seed : RANDOM_DEFAULT_SEED;
+}
+
+/**
+ * Следующее псевдослучайное число генератора xorshift32. Состояние хранит
+ * сам движок, поэтому последовательность воспроизводится по зерну
+ *
+ * @param state состояние генератора
+ *
+ * @return псевдослучайное число
+ */
+static inline uint32_t nextRandom(uint32_t* state) {
+  uint32_t x = *state;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  *state = x;
+  return x;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // RANDOM_H
@@ -0,0 +1,286 @@
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "replay.h"
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define REPLAY_INDEX_CAPACITY 64
+#define REPLAY_ALIGNMENT 8
+
+/**
+ * Создание файла записи и запись заголовка
+ *
+ * @param writer структура записи
+ * @param path путь к файлу
+ * @param header заголовок с зерном и конфигурацией игры
+ *
+ * @return 0 - OK
+ * @return -1 - файл не удалось открыть
+ */
+int openReplayWriter(ReplayWriter* writer, const char* path,
+                     const ReplayHeader* header) {
+  memset(writer, 0, sizeof(*writer));
+  writer->file = fopen(path, "wb");
+  if (!writer->file) return -1;
+  writer->header = *header;
+  memcpy(writer->header.magic, REPLAY_MAGIC, sizeof(writer->header.magic));
+  writer->header.version = REPLAY_VERSION;
+  if (fwrite(&writer->header, sizeof(ReplayHeader), 1, writer->file) != 1) {
+    fclose(writer->file);
+    writer->file = NULL;
+    return -1;
+  }
+  return 0;
+}
+
+/**
+ * Запись действия пользователя
+ *
+ * @param writer структура записи
+ * @param tick номер последнего сделанного шага
+ * @param action действие пользователя
+ * @param hold зажатие клавиши
+ *
+ * @return 0 - OK
+ * @return -1 - ошибка записи
+ */
+int writeReplayInput(ReplayWriter* writer, uint32_t tick, UserAction_t action,
+                     bool hold) {
+  if (!writer->file) return -1;
+  ReplayRecord record = {tick, REPLAY_INPUT, (uint8_t)action, hold, 0};
+  return fwrite(&record, sizeof(record), 1, writer->file) == 1 ? 0 : -1;
+}
+
+/**
+ * Запись опорного кадра и добавление его в индекс
+ *
+ * @param writer структура записи
+ * @param tick номер шага
+ * @param state снимок состояния игры размером header.stateSize
+ *
+ * @return 0 - OK
+ * @return -1 - ошибка записи
+ */
+int writeReplayKeyframe(ReplayWriter* writer, uint32_t tick,
+                        const void* state) {
+  if (!writer->file) return -1;
+  if (writer->keyframes == writer->capacity) {
+    uint32_t capacity =
+        writer->capacity ? writer->capacity * 2 : REPLAY_INDEX_CAPACITY;
+    ReplayIndexEntry* index =
+        realloc(writer->index, capacity * sizeof(ReplayIndexEntry));
+    if (!index) return -1;
+    writer->index = index;
+    writer->capacity = capacity;
+  }
+  long offset = ftell(writer->file);
+  ReplayRecord record = {tick, REPLAY_KEYFRAME, 0, 0, 0};
+  if (offset < 0 || fwrite(&record, sizeof(record), 1, writer->file) != 1 ||
+      fwrite(state, writer->header.stateSize, 1, writer->file) != 1)
+    return -1;
+  writer->index[writer->keyframes++] =
+      (ReplayIndexEntry){tick, 0, (uint64_t)offset};
+  return 0;
+}
+
+/**
+ * Учет сделанного шага: контрольная сумма пишется после каждого шага,
+ * опорный кадр - раз в keyframeInterval шагов
+ *
+ * @param writer структура записи
+ * @param tick номер сделанного шага
+ * @param state снимок состояния игры после шага
+ * @param checksum контрольная сумма состояния после шага
+ *
+ * @return 0 - OK
+ * @return -1 - ошибка записи
+ */
+int writeReplayStep(ReplayWriter* writer, uint32_t tick, const void* state,
+                    uint64_t checksum) {
+  if (!writer->file) return -1;
+  writer->ticks = tick;
+  ReplayRecord record = {tick, REPLAY_CHECKSUM, 0, 0, 0};
+  if (fwrite(&record, sizeof(record), 1, writer->file) != 1 ||
+      fwrite(&checksum, sizeof(checksum), 1, writer->file) != 1)
+    return -1;
+  if (tick % writer->header.keyframeInterval) return 0;
+  return writeReplayKeyframe(writer, tick, state);
+}
+
+/**
+ * Запись индекса опорных кадров в конец файла и закрытие файла
+ *
+ * @param writer структура записи
+ *
+ * @return 0 - OK
+ * @return -1 - ошибка записи
+ */
+int closeReplayWriter(ReplayWriter* writer) {
+  if (!writer->file) return -1;
+  int status = 0;
+  long offset = ftell(writer->file);
+  while (offset >= 0 && offset % REPLAY_ALIGNMENT) {
+    fputc(0, writer->file);
+    offset++;
+  }
+  ReplayTrailer trailer = {0};
+  trailer.indexOffset = offset;
+  trailer.keyframes = writer->keyframes;
+  trailer.ticks = writer->ticks;
+  memcpy(trailer.magic, REPLAY_INDEX_MAGIC, sizeof(trailer.magic));
+  if (offset < 0 ||
+      fwrite(writer->index, sizeof(ReplayIndexEntry), writer->keyframes,
+             writer->file) != writer->keyframes ||
+      fwrite(&trailer, sizeof(trailer), 1, writer->file) != 1)
+    status = -1;
+  if (fclose(writer->file)) status = -1;
+  free(writer->index);
+  memset(writer, 0, sizeof(*writer));
+  return status;
+}
+
+/**
+ * Отображение файла записи в память и проверка заголовка и индекса
+ *
+ * @param reader структура проигрывателя
+ * @param path путь к файлу
+ *
+ * @return 0 - OK
+ * @return -1 - файл не удалось открыть или он поврежден
+ */
+int openReplayReader(ReplayReader* reader, const char* path) {
+  memset(reader, 0, sizeof(*reader));
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) return -1;
+  struct stat st;
+  void* data = MAP_FAILED;
+  if (!fstat(fd, &st) &&
+      (size_t)st.st_size >= sizeof(ReplayHeader) + sizeof(ReplayTrailer))
+    data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED) return -1;
+  reader->data = data;
+  reader->size = st.st_size;
+
+  ReplayTrailer trailer;
+  memcpy(&reader->header, reader->data, sizeof(ReplayHeader));
+  memcpy(&trailer, reader->data + reader->size - sizeof(trailer),
+         sizeof(trailer));
+  size_t indexSize = (size_t)trailer.keyframes * sizeof(ReplayIndexEntry);
+  if (memcmp(reader->header.magic, REPLAY_MAGIC, 4) ||
+      reader->header.version != REPLAY_VERSION ||
+      !reader->header.keyframeInterval ||
+      memcmp(trailer.magic, REPLAY_INDEX_MAGIC, 4) || !trailer.keyframes ||
+      trailer.indexOffset < sizeof(ReplayHeader) ||
+      trailer.indexOffset + indexSize + sizeof(trailer) != reader->size) {
+    closeReplayReader(reader);
+    return -1;
+  }
+  reader->indexOffset = trailer.indexOffset;
+  reader->keyframes = trailer.keyframes;
+  reader->ticks = trailer.ticks;
+  return 0;
+}
+
+/**
+ * Освобождение отображения файла
+ *
+ * @param reader структура проигрывателя
+ */
+void closeReplayReader(ReplayReader* reader) {
+  if (reader->data) munmap((void*)reader->data, reader->size);
+  memset(reader, 0, sizeof(*reader));
+}
+
+/**
+ * Получение элемента индекса по номеру
+ */
+static ReplayIndexEntry getIndexEntry(const ReplayReader* reader, uint32_t i) {
+  ReplayIndexEntry entry;
+  memcpy(&entry, reader->data + reader->indexOffset + i * sizeof(entry),
+         sizeof(entry));
+  return entry;
+}
+
+/**
+ * Двоичный поиск ближайшего опорного кадра, не превышающего шаг
+ *
+ * @param reader структура проигрывателя
+ * @param tick номер шага
+ *
+ * @return элемент индекса опорного кадра
+ */
+ReplayIndexEntry findReplayKeyframe(const ReplayReader* reader,
+                                    uint32_t tick) {
+  uint32_t low = 0, high = reader->keyframes;
+  while (high - low > 1) {
+    uint32_t middle = low + (high - low) / 2;
+    if (getIndexEntry(reader, middle).tick <= tick)
+      low = middle;
+    else
+      high = middle;
+  }
+  return getIndexEntry(reader, low);
+}
+
+/**
+ * Переход к состоянию игры после шага tick. Если нужный шаг впереди и
+ * ближе ближайшего опорного кадра, игра досчитывается от текущего места,
+ * иначе восстанавливается опорный кадр и досчитывается от него. По пути
+ * состояние после каждого шага сверяется с записанной контрольной суммой,
+ * так что расхождение движка с записью находится с точностью до шага
+ *
+ * @param reader структура проигрывателя
+ * @param engine функции движка
+ * @param tick номер шага
+ *
+ * @return REPLAY_OK - OK
+ * @return REPLAY_CORRUPT - файл поврежден
+ * @return REPLAY_DESYNC - состояние после шага desyncTick разошлось с
+ * записью
+ */
+int seekReplay(ReplayReader* reader, const ReplayEngine* engine,
+               uint32_t tick) {
+  if (tick > reader->ticks) tick = reader->ticks;
+  ReplayIndexEntry keyframe = findReplayKeyframe(reader, tick);
+  if (!reader->position || tick < reader->tick ||
+      keyframe.tick > reader->tick) {
+    size_t state = keyframe.offset + sizeof(ReplayRecord);
+    if (state + reader->header.stateSize > reader->indexOffset)
+      return REPLAY_CORRUPT;
+    engine->restore(reader->data + state);
+    reader->position = state + reader->header.stateSize;
+    reader->tick = keyframe.tick;
+  }
+  ReplayRecord record;
+  while (reader->position + sizeof(record) <= reader->indexOffset) {
+    memcpy(&record, reader->data + reader->position, sizeof(record));
+    if (record.tick >= tick) break;
+    for (; reader->tick < record.tick; reader->tick++) engine->step();
+    reader->position += sizeof(record);
+    if (record.type == REPLAY_INPUT) {
+      engine->input((UserAction_t)record.action, record.hold);
+    } else if (record.type == REPLAY_KEYFRAME) {
+      reader->position += reader->header.stateSize;
+    } else if (record.type == REPLAY_CHECKSUM) {
+      uint64_t checksum;
+      if (reader->position + sizeof(checksum) > reader->indexOffset)
+        return REPLAY_CORRUPT;
+      memcpy(&checksum, reader->data + reader->position, sizeof(checksum));
+      reader->position += sizeof(checksum);
+      if (engine->checksum && engine->checksum() != checksum) {
+        reader->desyncTick = record.tick;
+        return REPLAY_DESYNC;
+      }
+    }
+  }
+  for (; reader->tick < tick; reader->tick++) engine->step();
+  return REPLAY_OK;
+}
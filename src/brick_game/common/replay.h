@@ -0,0 +1,131 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "../library_specification.h"
+
+#define REPLAY_MAGIC "BGRP"
+#define REPLAY_INDEX_MAGIC "BGRI"
+#define REPLAY_VERSION 2
+#define REPLAY_KEYFRAME_INTERVAL 256
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum { REPLAY_TETRIS, REPLAY_SNAKE } ReplayGame_t;
+
+typedef enum {
+  REPLAY_INPUT = 1,
+  REPLAY_KEYFRAME,
+  REPLAY_CHECKSUM
+} ReplayRecord_t;
+
+enum REPLAY_STATUS { REPLAY_OK = 0, REPLAY_CORRUPT = -1, REPLAY_DESYNC = -2 };
+
+/**
+ * Заголовок файла: зерно генератора и конфигурация игры
+ */
+typedef struct ReplayHeader {
+  char magic[4];
+  uint16_t version;
+  uint16_t game;
+  uint32_t seed;
+  uint16_t width;
+  uint16_t height;
+  uint32_t keyframeInterval;
+  uint32_t stateSize;
+  int64_t tickInterval;
+} ReplayHeader;
+
+/**
+ * Запись журнала. Ввод с номером шага tick применяется после шага tick и до
+ * шага tick + 1. За записью опорного кадра следует снимок размером stateSize,
+ * за записью контрольной суммы - 64-битная сумма состояния после шага tick
+ */
+typedef struct ReplayRecord {
+  uint32_t tick;
+  uint8_t type;
+  uint8_t action;
+  uint8_t hold;
+  uint8_t reserved;
+} ReplayRecord;
+
+/**
+ * Элемент индекса опорных кадров в конце файла
+ */
+typedef struct ReplayIndexEntry {
+  uint32_t tick;
+  uint32_t reserved;
+  uint64_t offset;
+} ReplayIndexEntry;
+
+/**
+ * Последние байты файла: положение индекса и длина сессии
+ */
+typedef struct ReplayTrailer {
+  uint64_t indexOffset;
+  uint32_t keyframes;
+  uint32_t ticks;
+  char magic[4];
+  uint32_t reserved;
+} ReplayTrailer;
+
+typedef struct ReplayWriter {
+  FILE* file;
+  ReplayHeader header;
+  ReplayIndexEntry* index;
+  uint32_t keyframes;
+  uint32_t capacity;
+  uint32_t ticks;
+} ReplayWriter;
+
+/**
+ * Функции движка, которыми проигрыватель восстанавливает опорный кадр и
+ * досчитывает игру до нужного шага. Если checksum задана, состояние после
+ * каждого шага сверяется с записанной контрольной суммой
+ */
+typedef struct ReplayEngine {
+  void (*restore)(const void* state);
+  void (*input)(UserAction_t action, bool hold);
+  void (*step)(void);
+  long (*tickInterval)(void);
+  uint64_t (*checksum)(void);
+} ReplayEngine;
+
+typedef struct ReplayReader {
+  const unsigned char* data;
+  size_t size;
+  ReplayHeader header;
+  size_t indexOffset;
+  uint32_t keyframes;
+  uint32_t ticks;
+  size_t position;
+  uint32_t tick;
+  uint32_t desyncTick;
+} ReplayReader;
+
+int openReplayWriter(ReplayWriter* writer, const char* path,
+                     const ReplayHeader* header);
+int writeReplayInput(ReplayWriter* writer, uint32_t tick, UserAction_t action,
+                     bool hold);
+int writeReplayKeyframe(ReplayWriter* writer, uint32_t tick,
+                        const void* state);
+int writeReplayStep(ReplayWriter* writer, uint32_t tick, const void* state,
+                    uint64_t checksum);
+int closeReplayWriter(ReplayWriter* writer);
+
+int openReplayReader(ReplayReader* reader, const char* path);
+void closeReplayReader(ReplayReader* reader);
+ReplayIndexEntry findReplayKeyframe(const ReplayReader* reader, uint32_t tick);
+int seekReplay(ReplayReader* reader, const ReplayEngine* engine,
+               uint32_t tick);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // REPLAY_H
@@ -0,0 +1,74 @@
+#include "rewind.h"
+
+/**
+ * Инициализация кольца снимков
+ *
+ * @param ring кольцо
+ * @param states массив из capacity снимков
+ * @param stateSize размер снимка
+ * @param capacity количество снимков
+ */
+void initRewindRing(RewindRing* ring, void* states, size_t stateSize,
+                    unsigned int capacity) {
+  ring->states = states;
+  ring->stateSize = stateSize;
+  ring->capacity = capacity;
+  clearRewindRing(ring);
+}
+
+/**
+ * Удаление всех снимков
+ *
+ * @param ring кольцо
+ */
+void clearRewindRing(RewindRing* ring) {
+  ring->newest = ring->capacity - 1;
+  ring->count = 0;
+}
+
+/**
+ * Получение слота для нового снимка. Если кольцо заполнено, слот самого
+ * старого снимка используется повторно
+ *
+ * @param ring кольцо
+ *
+ * @return слот, который заполняет вызывающий
+ */
+void* pushRewindState(RewindRing* ring) {
+  ring->newest = (ring->newest + 1) % ring->capacity;
+  if (ring->count < ring->capacity) ring->count++;
+  return ring->states + ring->newest * ring->stateSize;
+}
+
+/**
+ * Получение снимка без изменения кольца
+ *
+ * @param ring кольцо
+ * @param back номер снимка от последнего, 0 - последний
+ *
+ * @return снимок
+ * @return NULL - снимка с таким номером нет
+ */
+const void* peekRewindState(const RewindRing* ring, unsigned int back) {
+  if (back >= ring->count) return NULL;
+  unsigned int i = (ring->newest + ring->capacity - back) % ring->capacity;
+  return ring->states + i * ring->stateSize;
+}
+
+/**
+ * Откат на back снимков назад: более новые снимки удаляются
+ *
+ * @param ring кольцо
+ * @param back номер снимка от последнего
+ *
+ * @return снимок, ставший последним
+ * @return NULL - снимка с таким номером нет
+ */
+const void* rewindState(RewindRing* ring, unsigned int back) {
+  const void* state = peekRewindState(ring, back);
+  if (state) {
+    ring->newest = (ring->newest + ring->capacity - back) % ring->capacity;
+    ring->count -= back;
+  }
+  return state;
+}
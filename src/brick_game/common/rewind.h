@@ -0,0 +1,36 @@
+#ifndef REWIND_H
+#define REWIND_H
+
+#include <stddef.h>
+
+#define REWIND_CAPACITY 128
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Кольцо последних снимков состояния игры. Память под снимки выделяет
+ * владелец, кольцо только перебирает слоты, поэтому снимок можно делать
+ * на каждом шаге без обращений к куче
+ */
+typedef struct RewindRing {
+  unsigned char* states;
+  size_t stateSize;
+  unsigned int capacity;
+  unsigned int newest;
+  unsigned int count;
+} RewindRing;
+
+void initRewindRing(RewindRing* ring, void* states, size_t stateSize,
+                    unsigned int capacity);
+void clearRewindRing(RewindRing* ring);
+void* pushRewindState(RewindRing* ring);
+const void* peekRewindState(const RewindRing* ring, unsigned int back);
+const void* rewindState(RewindRing* ring, unsigned int back);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // REWIND_H
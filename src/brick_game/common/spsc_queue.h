@@ -0,0 +1,85 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+
+namespace s21 {
+
+/**
+ * Ограниченная очередь без блокировок для одного писателя и одного читателя.
+ * Писатель вызывает только push(), читатель - только pop()
+ */
+template <typename T, size_t Capacity>
+class SpscQueue {
+ public:
+  /**
+   * Добавление элемента в очередь
+   *
+   * @param value элемент
+   *
+   * @return true - элемент добавлен
+   * @return false - очередь заполнена
+   */
+  bool push(const T& value) {
+    size_t tail = tail_.load(std::memory_order_relaxed);
+    size_t next = (tail + 1) % (Capacity + 1);
+    if (next == head_.load(std::memory_order_acquire)) return false;
+    items_[tail] = value;
+    tail_.store(next, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * Извлечение элемента из очереди
+   *
+   * @param value элемент
+   *
+   * @return true - элемент извлечен
+   * @return false - очередь пуста
+   */
+  bool pop(T& value) {
+    size_t head = head_.load(std::memory_order_relaxed);
+    if (head == tail_.load(std::memory_order_acquire)) return false;
+    value = items_[head];
+    head_.store((head + 1) % (Capacity + 1), std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * Просмотр первого элемента очереди без извлечения. Вызывается только
+   * читателем
+   *
+   * @return указатель на первый элемент или nullptr, если очередь пуста
+   */
+  const T* front() const {
+    size_t head = head_.load(std::memory_order_relaxed);
+    if (head == tail_.load(std::memory_order_acquire)) return nullptr;
+    return &items_[head];
+  }
+
+  /**
+   * Проверка очереди на пустоту
+   */
+  bool empty() const {
+    return head_.load(std::memory_order_acquire) ==
+           tail_.load(std::memory_order_acquire);
+  }
+
+  /**
+   * Количество элементов в очереди
+   */
+  size_t size() const {
+    size_t head = head_.load(std::memory_order_acquire);
+    size_t tail = tail_.load(std::memory_order_acquire);
+    return (tail + Capacity + 1 - head) % (Capacity + 1);
+  }
+
+ private:
+  T items_[Capacity + 1];
+  alignas(64) std::atomic<size_t> head_{0};
+  alignas(64) std::atomic<size_t> tail_{0};
+};
+
+}  // namespace s21
+#endif  // SPSC_QUEUE_H
@@ -0,0 +1,249 @@
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "trace.h"
+
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "engine_stats.h"
+
+/**
+ * Начало или конец участка. sequence - номер события в кольце плюс один,
+ * 0 - запись слота не закончена. Слот читается, пока владелец пишет
+ * поверх него, поэтому поля атомарные и сверяются с sequence до и после
+ * чтения, как в seqlock
+ */
+typedef struct TraceRecord {
+  _Atomic uint64_t sequence;
+  _Atomic(const char*) name;
+  _Atomic uint64_t ns;
+  _Atomic char phase;
+} TraceRecord;
+
+/**
+ * Кольцо событий одного потока. Пишет только поток-владелец; запись
+ * события публикуется номером слота и увеличением head
+ */
+typedef struct TraceRing {
+  TraceRecord records[TRACE_RING_SIZE];
+  _Atomic uint64_t head;
+  _Atomic(const char*) name;
+  int tid;
+} TraceRing;
+
+/**
+ * Общее состояние трассировки
+ */
+typedef struct Tracer {
+  atomic_bool enabled;
+  atomic_int dumpRequested;
+  atomic_int ringCount;
+  _Atomic(TraceRing*) rings[TRACE_MAX_THREADS];
+  const char* path;
+  uint64_t startNs;
+} Tracer;
+
+static Tracer tracer;
+// Номер включения трассировки: кольцо потока из прошлого включения
+// освобождено freeTrace() и заводится заново
+static atomic_int traceEpoch;
+static _Thread_local TraceRing* threadRing;
+static _Thread_local int threadEpoch;
+
+/**
+ * Обработчик SIGUSR1: запись файла выполнит поток, первым записавший
+ * событие после сигнала
+ *
+ * @param signal номер сигнала
+ */
+static void requestDump(int signal) {
+  (void)signal;
+  atomic_store(&tracer.dumpRequested, 1);
+}
+
+/**
+ * Запись файла при завершении программы
+ */
+static void dumpAtExit(void) { dumpTrace(); }
+
+/**
+ * Включение трассировки, если задана переменная окружения TRACE_ENV.
+ * Файл записывается при выходе из программы и по сигналу SIGUSR1
+ *
+ * @return true - трассировка включена
+ */
+bool initTrace(void) {
+  const char* path = getenv(TRACE_ENV);
+  if (!path || !*path || atomic_load(&tracer.enabled)) return false;
+  tracer.path = path;
+  tracer.startNs = engineStatsNow();
+  static bool registered = false;
+  if (!registered) atexit(dumpAtExit);
+  registered = true;
+  struct sigaction action;
+  memset(&action, 0, sizeof(action));
+  action.sa_handler = requestDump;
+  sigemptyset(&action.sa_mask);
+  action.sa_flags = SA_RESTART;
+  sigaction(SIGUSR1, &action, NULL);
+  atomic_store(&tracer.enabled, true);
+  return true;
+}
+
+/**
+ * Выключение трассировки и освобождение колец без записи файла. Вызывается,
+ * когда другие потоки уже не пишут события
+ */
+void freeTrace(void) {
+  if (!atomic_exchange(&tracer.enabled, false)) return;
+  signal(SIGUSR1, SIG_DFL);
+  int count = atomic_exchange(&tracer.ringCount, 0);
+  if (count > TRACE_MAX_THREADS) count = TRACE_MAX_THREADS;
+  for (int i = 0; i < count; i++)
+    free(atomic_exchange(&tracer.rings[i], NULL));
+  atomic_store(&tracer.dumpRequested, 0);
+  atomic_fetch_add(&traceEpoch, 1);
+}
+
+/**
+ * Кольцо текущего потока. Создается при первом событии потока
+ *
+ * @return кольцо
+ * @return NULL - потоков больше TRACE_MAX_THREADS, события отбрасываются
+ */
+static TraceRing* getThreadRing(void) {
+  int epoch = atomic_load_explicit(&traceEpoch, memory_order_relaxed);
+  if (!threadRing || threadEpoch != epoch) {
+    threadRing = NULL;
+    threadEpoch = epoch;
+    int tid = atomic_fetch_add(&tracer.ringCount, 1);
+    if (tid >= TRACE_MAX_THREADS) return NULL;
+    TraceRing* ring = calloc(1, sizeof(TraceRing));
+    if (!ring) return NULL;
+    ring->tid = tid + 1;
+    atomic_store(&tracer.rings[tid], ring);
+    threadRing = ring;
+  }
+  return threadRing;
+}
+
+/**
+ * Название текущего потока в трассировке
+ *
+ * @param name строковый литерал
+ */
+void setTraceThreadName(const char* name) {
+  if (!atomic_load_explicit(&tracer.enabled, memory_order_relaxed)) return;
+  TraceRing* ring = getThreadRing();
+  if (ring) atomic_store(&ring->name, name);
+}
+
+/**
+ * Запись события в кольцо текущего потока. Старые события перезаписываются
+ *
+ * @param name название участка, строковый литерал
+ * @param phase 'B' - начало участка, 'E' - конец
+ */
+void traceEvent(const char* name, char phase) {
+  if (!atomic_load_explicit(&tracer.enabled, memory_order_relaxed)) return;
+  TraceRing* ring = getThreadRing();
+  if (!ring) return;
+  uint64_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+  TraceRecord* record = &ring->records[head & (TRACE_RING_SIZE - 1)];
+  atomic_store_explicit(&record->sequence, 0, memory_order_relaxed);
+  atomic_thread_fence(memory_order_release);
+  atomic_store_explicit(&record->name, name, memory_order_relaxed);
+  atomic_store_explicit(&record->ns, engineStatsNow(), memory_order_relaxed);
+  atomic_store_explicit(&record->phase, phase, memory_order_relaxed);
+  atomic_store_explicit(&record->sequence, head + 1, memory_order_release);
+  atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+  if (atomic_load_explicit(&tracer.dumpRequested, memory_order_relaxed) &&
+      atomic_exchange(&tracer.dumpRequested, 0))
+    dumpTrace();
+}
+
+/**
+ * Чтение события number из кольца
+ *
+ * @return true - событие прочитано, false - слот уже перезаписывается
+ */
+static bool readRecord(TraceRing* ring, uint64_t number, const char** name,
+                       uint64_t* ns, char* phase) {
+  TraceRecord* record = &ring->records[number & (TRACE_RING_SIZE - 1)];
+  if (atomic_load_explicit(&record->sequence, memory_order_acquire) !=
+      number + 1)
+    return false;
+  *name = atomic_load_explicit(&record->name, memory_order_relaxed);
+  *ns = atomic_load_explicit(&record->ns, memory_order_relaxed);
+  *phase = atomic_load_explicit(&record->phase, memory_order_relaxed);
+  atomic_thread_fence(memory_order_acquire);
+  return atomic_load_explicit(&record->sequence, memory_order_relaxed) ==
+         number + 1;
+}
+
+/**
+ * Вывод событий одного кольца. Если кольцо переполнилось, концы участков,
+ * начала которых перезаписаны, пропускаются
+ *
+ * @param file файл трассировки
+ * @param ring кольцо
+ * @param first первое событие в файле
+ */
+static void dumpRing(FILE* file, TraceRing* ring, bool* first) {
+  int pid = getpid();
+  const char* name = atomic_load(&ring->name);
+  fprintf(file,
+          "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,"
+          "\"args\":{\"name\":\"%s %d\"}}",
+          *first ? "" : ",", pid, ring->tid, name ? name : "thread",
+          ring->tid);
+  *first = false;
+  uint64_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+  uint64_t start = head > TRACE_RING_SIZE ? head - TRACE_RING_SIZE : 0;
+  int depth = 0;
+  for (uint64_t i = start; i < head; i++) {
+    const char* event;
+    uint64_t ns;
+    char phase;
+    if (!readRecord(ring, i, &event, &ns, &phase)) continue;
+    if (phase == 'E' && depth == 0 && start) continue;
+    depth += phase == 'B' ? 1 : -1;
+    if (depth < 0) depth = 0;
+    double us = (double)(ns - tracer.startNs) / 1000.0;
+    fprintf(file,
+            ",\n{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":%d,"
+            "\"tid\":%d}",
+            event, phase, us, pid, ring->tid);
+  }
+}
+
+/**
+ * Запись всех колец в файл в формате Chrome trace event. Кольца могут
+ * писаться во время записи файла: недописанные слоты пропускаются
+ *
+ * @return 0 - OK
+ * @return -1 - трассировка выключена или файл не удалось создать
+ */
+int dumpTrace(void) {
+  if (!atomic_load(&tracer.enabled)) return -1;
+  FILE* file = fopen(tracer.path, "w");
+  if (!file) return -1;
+  fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", file);
+  bool first = true;
+  int count = atomic_load(&tracer.ringCount);
+  if (count > TRACE_MAX_THREADS) count = TRACE_MAX_THREADS;
+  for (int i = 0; i < count; i++) {
+    TraceRing* ring = atomic_load(&tracer.rings[i]);
+    if (ring) dumpRing(file, ring, &first);
+  }
+  fputs("\n]}\n", file);
+  fclose(file);
+  return 0;
+}
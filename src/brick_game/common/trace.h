@@ -0,0 +1,37 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Путь к файлу трассировки; без переменной окружения трассировка выключена
+#define TRACE_ENV "BRICK_GAME_TRACE"
+// Количество событий в кольце одного потока, степень двойки
+#define TRACE_RING_SIZE (1 << 16)
+#define TRACE_MAX_THREADS 16
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+bool initTrace(void);
+void freeTrace(void);
+void setTraceThreadName(const char* name);
+void traceEvent(const char* name, char phase);
+int dumpTrace(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+// Сборка с -DTRACE_DISABLED убирает трассировку полностью. Имя участка
+// должно быть строковым литералом: в кольце хранится только указатель
+#ifdef TRACE_DISABLED
+#define TRACE_BEGIN(name)
+#define TRACE_END(name)
+#else
+#define TRACE_BEGIN(name) traceEvent((name), 'B')
+#define TRACE_END(name) traceEvent((name), 'E')
+#endif
+
+#endif  // TRACE_H
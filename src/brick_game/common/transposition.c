@@ -0,0 +1,102 @@
+#include "transposition.h"
+
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Запись таблицы. Вместо ключа хранится ключ, сложенный по модулю 2 с
+ * данными: половины записи от разных записывающих потоков не дадут
+ * исходного ключа
+ */
+typedef struct TranspositionEntry {
+  _Atomic uint64_t check;
+  _Atomic uint64_t data;
+} TranspositionEntry;
+
+struct TranspositionTable {
+  TranspositionEntry* entries;
+  uint64_t mask;
+};
+
+/**
+ * Создание таблицы
+ *
+ * @param bits двоичный логарифм количества записей
+ *
+ * @return таблица
+ * @return NULL - не хватило памяти
+ */
+TranspositionTable* createTranspositionTable(unsigned int bits) {
+  TranspositionTable* table = malloc(sizeof(TranspositionTable));
+  if (!table) return NULL;
+  table->mask = (1ull << bits) - 1;
+  table->entries = malloc(sizeof(TranspositionEntry) << bits);
+  if (!table->entries) {
+    free(table);
+    return NULL;
+  }
+  clearTranspositionTable(table);
+  return table;
+}
+
+/**
+ * Освобождение таблицы
+ *
+ * @param table таблица
+ */
+void freeTranspositionTable(TranspositionTable* table) {
+  if (!table) return;
+  free(table->entries);
+  free(table);
+}
+
+/**
+ * Очистка таблицы. Пустая запись не совпадает ни с одним ключом, кроме
+ * ~0, в том числе с хешем пустого поля, равным нулю. Вызывается, пока
+ * таблицей не пользуются другие потоки
+ *
+ * @param table таблица
+ */
+void clearTranspositionTable(TranspositionTable* table) {
+  for (uint64_t i = 0; i <= table->mask; i++) {
+    atomic_init(&table->entries[i].check, ~0ull);
+    atomic_init(&table->entries[i].data, 0);
+  }
+}
+
+/**
+ * Поиск оценки позиции
+ *
+ * @param table таблица
+ * @param key хеш позиции
+ * @param value найденная оценка
+ *
+ * @return 1 - оценка найдена
+ * @return 0 - промах
+ */
+int probeTransposition(TranspositionTable* table, uint64_t key,
+                       double* value) {
+  TranspositionEntry* entry = &table->entries[key & table->mask];
+  uint64_t data = atomic_load_explicit(&entry->data, memory_order_relaxed);
+  uint64_t check = atomic_load_explicit(&entry->check, memory_order_relaxed);
+  if ((check ^ data) != key) return 0;
+  memcpy(value, &data, sizeof(*value));
+  return 1;
+}
+
+/**
+ * Запись оценки позиции поверх прежней записи слота
+ *
+ * @param table таблица
+ * @param key хеш позиции
+ * @param value оценка
+ */
+void storeTransposition(TranspositionTable* table, uint64_t key,
+                        double value) {
+  TranspositionEntry* entry = &table->entries[key & table->mask];
+  uint64_t data;
+  memcpy(&data, &value, sizeof(data));
+  atomic_store_explicit(&entry->check, key ^ data, memory_order_relaxed);
+  atomic_store_explicit(&entry->data, data, memory_order_relaxed);
+}
@@ -0,0 +1,34 @@
+#ifndef TRANSPOSITION_H
+#define TRANSPOSITION_H
+
+#include <stdint.h>
+
+// Двоичный логарифм количества записей таблицы по умолчанию
+#define TRANSPOSITION_BITS 16
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Таблица транспозиций: оценки позиций по их хешу Зобриста. Размер
+ * фиксирован при создании, запись вытесняет прежнюю в том же слоте.
+ * Потоки читают и пишут без блокировок; запись, разорванная
+ * одновременной записью другого потока, при чтении не проходит проверку
+ * ключа и считается промахом
+ */
+typedef struct TranspositionTable TranspositionTable;
+
+TranspositionTable* createTranspositionTable(unsigned int bits);
+void freeTranspositionTable(TranspositionTable* table);
+void clearTranspositionTable(TranspositionTable* table);
+int probeTransposition(TranspositionTable* table, uint64_t key,
+                       double* value);
+void storeTransposition(TranspositionTable* table, uint64_t key,
+                        double value);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // TRANSPOSITION_H
@@ -0,0 +1,58 @@
+#ifndef TRIPLE_BUFFER_H
+#define TRIPLE_BUFFER_H
+
+#include <atomic>
+
+namespace s21 {
+
+/**
+ * Тройной буфер без блокировок для передачи неизменяемых снимков от одного
+ * писателя одному читателю. Писатель заполняет getBack() и вызывает
+ * publish(), читатель вызывает update() и читает getFront(). Читатель
+ * всегда получает последний опубликованный снимок, писатель никогда не ждет
+ */
+template <typename T>
+class TripleBuffer {
+ public:
+  /**
+   * Получение буфера, который заполняет писатель
+   */
+  T& getBack() { return buffers_[back_]; }
+
+  /**
+   * Публикация заполненного буфера писателем
+   */
+  void publish() {
+    int old = middle_.exchange(back_ | kFresh, std::memory_order_acq_rel);
+    back_ = old & kIndex;
+  }
+
+  /**
+   * Получение читателем последнего опубликованного буфера
+   *
+   * @return true - получен новый снимок
+   * @return false - новых снимков не было
+   */
+  bool update() {
+    if (!(middle_.load(std::memory_order_acquire) & kFresh)) return false;
+    int old = middle_.exchange(front_, std::memory_order_acq_rel);
+    front_ = old & kIndex;
+    return true;
+  }
+
+  /**
+   * Получение буфера, который читает читатель
+   */
+  const T& getFront() const { return buffers_[front_]; }
+
+ private:
+  enum { kIndex = 3, kFresh = 4 };
+
+  T buffers_[3] = {};
+  int back_ = 0;
+  int front_ = 1;
+  std::atomic<int> middle_{2};
+};
+
+}  // namespace s21
+#endif  // TRIPLE_BUFFER_H
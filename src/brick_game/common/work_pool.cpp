@@ -0,0 +1,143 @@
+#include "work_pool.h"
+
+using namespace s21;
+
+/**
+ * Создание пула. Вызывающий run() поток тоже выполняет задачи, поэтому
+ * создается на один поток меньше
+ *
+ * @param threads количество потоков, 0 - один поток
+ */
+WorkPool::WorkPool(unsigned int threads)
+    : threads_(threads ? threads : 1),
+      queues_(new Queue[threads_]),
+      task_(nullptr),
+      context_(nullptr),
+      round_(0),
+      active_(0),
+      stop_(false),
+      steals_(0) {
+  for (unsigned int i = 0; i < threads_; i++)
+    queues_[i].begin = queues_[i].end = 0;
+  for (unsigned int i = 1; i < threads_; i++)
+    workers_.emplace_back(&WorkPool::loop, this, i);
+}
+
+/**
+ * Остановка потоков пула
+ */
+WorkPool::~WorkPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  wake_.notify_all();
+  for (std::thread& worker : workers_) worker.join();
+}
+
+/**
+ * Выполнение задач с номерами от 0 до count - 1. Возвращает управление,
+ * когда все задачи выполнены
+ *
+ * @param task задача
+ * @param context контекст задачи
+ * @param count количество задач
+ */
+void WorkPool::run(Task task, void* context, unsigned int count) {
+  if (!count) return;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    task_ = task;
+    context_ = context;
+    for (unsigned int i = 0; i < threads_; i++) {
+      std::lock_guard<std::mutex> queueLock(queues_[i].mutex);
+      queues_[i].begin = static_cast<unsigned long>(count) * i / threads_;
+      queues_[i].end = static_cast<unsigned long>(count) * (i + 1) / threads_;
+    }
+    active_ = threads_ - 1;
+    round_++;
+  }
+  wake_.notify_all();
+  work(0);
+  std::unique_lock<std::mutex> lock(mutex_);
+  done_.wait(lock, [this] { return active_ == 0; });
+}
+
+/**
+ * Взятие задачи с конца своей очереди
+ *
+ * @param worker номер потока
+ * @param index номер задачи
+ *
+ * @return false - очередь пуста
+ */
+bool WorkPool::take(unsigned int worker, unsigned int* index) {
+  Queue& queue = queues_[worker];
+  std::lock_guard<std::mutex> lock(queue.mutex);
+  if (queue.begin == queue.end) return false;
+  *index = --queue.end;
+  return true;
+}
+
+/**
+ * Перехват половины чужой очереди. Первая задача выполняется сразу,
+ * остальные переходят в свою очередь
+ *
+ * @param worker номер потока
+ * @param index номер задачи
+ *
+ * @return false - работы не осталось ни в одной очереди
+ */
+bool WorkPool::steal(unsigned int worker, unsigned int* index) {
+  for (unsigned int i = 1; i < threads_; i++) {
+    Queue& victim = queues_[(worker + i) % threads_];
+    unsigned int begin, end;
+    {
+      std::lock_guard<std::mutex> lock(victim.mutex);
+      if (victim.begin == victim.end) continue;
+      begin = victim.begin;
+      end = begin + (victim.end - begin + 1) / 2;
+      victim.begin = end;
+    }
+    Queue& queue = queues_[worker];
+    {
+      std::lock_guard<std::mutex> lock(queue.mutex);
+      queue.begin = begin + 1;
+      queue.end = end;
+    }
+    *index = begin;
+    steals_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+  }
+  return false;
+}
+
+/**
+ * Выполнение задач, пока они есть в своей или чужих очередях
+ *
+ * @param worker номер потока
+ */
+void WorkPool::work(unsigned int worker) {
+  unsigned int index;
+  while (take(worker, &index) || steal(worker, &index))
+    task_(context_, index, worker);
+}
+
+/**
+ * Цикл потока пула: ожидание очередного run() и участие в нем
+ *
+ * @param worker номер потока
+ */
+void WorkPool::loop(unsigned int worker) {
+  unsigned long seen = 0;
+  std::unique_lock<std::mutex> lock(mutex_);
+  for (;;) {
+    wake_.wait(lock, [&] { return stop_ || round_ != seen; });
+    if (stop_) return;
+    seen = round_;
+    lock.unlock();
+    work(worker);
+    lock.lock();
+    if (--active_ == 0) done_.notify_one();
+  }
+}
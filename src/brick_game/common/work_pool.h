@@ -0,0 +1,81 @@
+#ifndef WORK_POOL_H
+#define WORK_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Размер строки кэша: очереди соседних потоков не делят одну строку
+#define WORK_POOL_LINE 64
+
+namespace s21 {
+
+/**
+ * Пул потоков с перехватом работы для параллельного цикла. Номера задач
+ * делятся поровну между очередями потоков; поток берет задачи с конца своей
+ * очереди, а опустев, забирает половину чужой очереди с начала. Так
+ * неравные по стоимости задачи не оставляют потоки без дела. Потоки
+ * создаются один раз, run() не обращается к куче
+ */
+class WorkPool {
+ public:
+  /**
+   * Задача: контекст вызывающего, номер задачи и номер потока
+   */
+  using Task = void (*)(void* context, unsigned int index,
+                        unsigned int worker);
+
+  explicit WorkPool(unsigned int threads);
+  ~WorkPool();
+  WorkPool(const WorkPool&) = delete;
+  WorkPool& operator=(const WorkPool&) = delete;
+
+  void run(Task task, void* context, unsigned int count);
+
+  /**
+   * Получение количества потоков вместе с вызывающим run()
+   */
+  unsigned int getThreads() const { return threads_; }
+
+  /**
+   * Получение количества перехватов работы у других потоков
+   */
+  unsigned long getSteals() const {
+    return steals_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  /**
+   * Очередь потока: непрерывный диапазон номеров задач [begin, end)
+   */
+  struct alignas(WORK_POOL_LINE) Queue {
+    std::mutex mutex;
+    unsigned int begin;
+    unsigned int end;
+  };
+
+  bool take(unsigned int worker, unsigned int* index);
+  bool steal(unsigned int worker, unsigned int* index);
+  void work(unsigned int worker);
+  void loop(unsigned int worker);
+
+  unsigned int threads_;
+  std::unique_ptr<Queue[]> queues_;
+  std::vector<std::thread> workers_;
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  std::condition_variable done_;
+  Task task_;
+  void* context_;
+  unsigned long round_;
+  unsigned int active_;
+  bool stop_;
+  std::atomic<unsigned long> steals_;
+};
+
+}  // namespace s21
+
+#endif  // WORK_POOL_H
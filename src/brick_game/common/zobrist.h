@@ -0,0 +1,43 @@
+#ifndef ZOBRIST_H
+#define ZOBRIST_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Ключ Зобриста по номеру элемента позиции: перемешивание splitmix64.
+ * Ключи вычисляются, а не хранятся в таблице, поэтому одинаковы во всех
+ * потоках и процессах и не требуют инициализации
+ *
+ * @param index номер элемента, например клетки и значения блока в ней
+ *
+ * @return 64-битный ключ
+ */
+static inline uint64_t zobristKey(uint64_t index) {
+  uint64_t z = index * 0x9e3779b97f4a7c15ull + 0x9e3779b97f4a7c15ull;
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+  return z ^ (z >> 31);
+}
+
+/**
+ * Добавление значения к хешу с учетом порядка: для контрольной суммы из
+ * хешей поля и нескольких чисел состояния
+ *
+ * @param hash хеш
+ * @param value значение
+ *
+ * @return новый хеш
+ */
+static inline uint64_t zobristMix(uint64_t hash, uint64_t value) {
+  return zobristKey(hash ^ value);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // ZOBRIST_H
@@ -0,0 +1,202 @@
+#include "autopilot.h"
+
+using namespace s21;
+
+Autopilot::Autopilot() : decisions_(0), recomputes_(0) { reset(); }
+
+/**
+ * Сброс закешированного пути, например при начале новой игры
+ */
+void Autopilot::reset() {
+  apple_ = -1;
+  pathSafe_ = false;
+  lastTick_ = 0;
+  decided_ = false;
+}
+
+/**
+ * Отметка клеток, занятых змейкой. Хвост не отмечается: если змейка не
+ * съест яблоко, на следующем шаге он освободит клетку
+ *
+ * @param snake змейка
+ */
+void Autopilot::markSnake(const Snake& snake) {
+  std::memset(blocked_, 0, sizeof(blocked_));
+  for (size_t i = 0; i + 1 < snake.getLength(); i++) {
+    int cell = cellOf(snake.getSegment(i));
+    if (cell >= 0) blocked_[cell] = 1;
+  }
+}
+
+/**
+ * Поиск в ширину от клетки source по свободным клеткам
+ *
+ * @param source начальная клетка
+ * @param blocked занятые клетки
+ * @param distance расстояния от source, -1 - клетка недостижима
+ */
+void Autopilot::search(int source, const unsigned char* blocked,
+                       short* distance) {
+  std::memset(distance, -1, sizeof(short) * BOARD_CELLS);
+  int head = 0, tail = 0;
+  distance[source] = 0;
+  queue_[tail++] = source;
+  while (head < tail) {
+    int cell = queue_[head++];
+    for (int direction = 0; direction < 4; direction++) {
+      int next = neighborOf(cell, direction);
+      if (next < 0 || blocked[next] || distance[next] >= 0) continue;
+      distance[next] = distance[cell] + 1;
+      queue_[tail++] = next;
+    }
+  }
+}
+
+/**
+ * Выбор шага к яблоку по полю расстояний
+ *
+ * @param cell клетка головы
+ * @param blocked занятые клетки
+ *
+ * @return направление, -1 - яблоко недостижимо
+ */
+int Autopilot::chooseStep(int cell, const unsigned char* blocked) const {
+  int best = -1;
+  for (int direction = 0; direction < 4; direction++) {
+    int next = neighborOf(cell, direction);
+    if (next < 0 || blocked[next] || distance_[next] < 0) continue;
+    if (best < 0 || distance_[next] < distance_[neighborOf(cell, best)])
+      best = direction;
+  }
+  return best;
+}
+
+/**
+ * Проверка пути к яблоку: змейка мысленно проходит его целиком, после чего
+ * голова должна иметь путь к хвосту. Иначе змейка может съесть яблоко и
+ * запереть себя
+ *
+ * @param snake змейка
+ *
+ * @return true - путь безопасен
+ */
+bool Autopilot::pathIsSafe(const Snake& snake) {
+  const int size = BOARD_CELLS + 1;
+  int length = static_cast<int>(snake.getLength());
+  for (int i = 0; i < length; i++) body_[i] = cellOf(snake.getSegment(i));
+  std::memcpy(virtualBlocked_, blocked_, sizeof(blocked_));
+  int head = 0;
+  int cell = body_[0];
+  for (int steps = 0; cell != apple_; steps++) {
+    int direction = chooseStep(cell, virtualBlocked_);
+    if (direction < 0 || steps > BOARD_CELLS) return false;
+    int next = neighborOf(cell, direction);
+    if (next != apple_) {
+      length--;
+      virtualBlocked_[body_[(head + length - 1) % size]] = 0;
+    }
+    virtualBlocked_[next] = 1;
+    head = (head + size - 1) % size;
+    body_[head] = next;
+    length++;
+    cell = next;
+  }
+  if (length >= BOARD_CELLS) return true;
+  search(body_[(head + length - 1) % size], virtualBlocked_, scratch_);
+  for (int direction = 0; direction < 4; direction++) {
+    int next = neighborOf(cell, direction);
+    if (next >= 0 && !virtualBlocked_[next] && scratch_[next] >= 0)
+      return true;
+  }
+  return false;
+}
+
+/**
+ * Выбор шага, когда к яблоку идти нельзя: из клеток, откуда достижим
+ * хвост, выбирается самая далекая от него, чтобы змейка тянула время, пока
+ * путь к яблоку не освободится
+ *
+ * @param snake змейка
+ *
+ * @return направление, -1 - свободных соседних клеток нет
+ */
+int Autopilot::chaseTail(const Snake& snake) {
+  int head = cellOf(snake.getHead());
+  search(cellOf(snake.getSegment(snake.getLength() - 1)), blocked_, scratch_);
+  int best = -1, bestDistance = -2;
+  for (int direction = 0; direction < 4; direction++) {
+    int next = neighborOf(head, direction);
+    if (next < 0 || blocked_[next] ||
+        snake.isOpposite(static_cast<Snake::Direction>(direction)))
+      continue;
+    if (scratch_[next] > bestDistance) {
+      best = direction;
+      bestDistance = scratch_[next];
+    }
+  }
+  return best;
+}
+
+/**
+ * Выбор направления змейки на следующий шаг
+ *
+ * @param snake змейка
+ * @param apple координаты яблока
+ *
+ * @return направление
+ */
+Snake::Direction Autopilot::decide(const Snake& snake,
+                                   std::pair<int, int> apple) {
+  decisions_++;
+  int head = cellOf(snake.getHead());
+  if (head < 0) return snake.getDirection();
+  markSnake(snake);
+  int target = cellOf(apple);
+  if (target >= 0 && (target != apple_ || !pathSafe_)) {
+    apple_ = target;
+    recomputes_++;
+    search(apple_, blocked_, distance_);
+    pathSafe_ = pathIsSafe(snake);
+  }
+  int direction = target >= 0 && pathSafe_ ? chooseStep(head, blocked_) : -1;
+  if (direction >= 0 &&
+      snake.isOpposite(static_cast<Snake::Direction>(direction)))
+    direction = -1;
+  if (direction < 0) {
+    pathSafe_ = false;
+    direction = chaseTail(snake);
+  }
+  return direction < 0 ? snake.getDirection()
+                       : static_cast<Snake::Direction>(direction);
+}
+
+/**
+ * Выбор направления змейки в игре
+ *
+ * @param game игра
+ *
+ * @return направление
+ */
+Snake::Direction Autopilot::decide(Game& game) {
+  return decide(game.getSnake(), game.getApple());
+}
+
+/**
+ * Управление игрой через очередь ввода, как это делает игрок. Решение
+ * принимается один раз за шаг змейки, поэтому функцию можно вызывать на
+ * каждом кадре интерфейса
+ *
+ * @param game игра
+ *
+ * @return true - поворот поставлен в очередь
+ */
+bool Autopilot::drive(Game& game) {
+  if (game.getPlaying() != PLAYING || game.getGameInfo().pause) return false;
+  if (decided_ && game.getTick() == lastTick_) return false;
+  decided_ = true;
+  lastTick_ = game.getTick();
+  Snake::Direction direction = decide(game);
+  if (direction == game.getSnake().getDirection()) return false;
+  userInput(static_cast<UserAction_t>(Left + direction), 0);
+  return true;
+}
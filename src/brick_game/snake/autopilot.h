@@ -0,0 +1,62 @@
+#ifndef AUTOPILOT_H
+#define AUTOPILOT_H
+
+#include "board.h"
+
+#define AUTOPILOT_FLAG "--auto"
+
+namespace s21 {
+
+/**
+ * Автопилот змейки. Идет к яблоку по кратчайшему пути, если после его
+ * съедения голова еще может добраться до хвоста, иначе тянет время, следуя
+ * за хвостом. Поле расстояний до яблока считается поиском в ширину по
+ * плоскому массиву клеток и используется повторно на следующих тактах:
+ * змейка идет ровно по проверенному пути, поэтому пересчет нужен, только
+ * когда яблоко переместилось или путь оказался перекрыт
+ */
+class Autopilot {
+ public:
+  Autopilot();
+  void reset();
+  Snake::Direction decide(const Snake& snake, std::pair<int, int> apple);
+  Snake::Direction decide(Game& game);
+  bool drive(Game& game);
+
+  /**
+   * Получение количества принятых решений
+   */
+  unsigned long getDecisions() const { return decisions_; }
+
+  /**
+   * Получение количества пересчетов поля расстояний до яблока
+   */
+  unsigned long getRecomputes() const { return recomputes_; }
+
+ private:
+  void markSnake(const Snake& snake);
+  void search(int source, const unsigned char* blocked, short* distance);
+  bool pathIsSafe(const Snake& snake);
+  int chooseStep(int cell, const unsigned char* blocked) const;
+  int chaseTail(const Snake& snake);
+
+  // Клетки, занятые змейкой; хвост свободен, он уйдет на этом же шаге
+  unsigned char blocked_[BOARD_CELLS];
+  // Расстояния до яблока, -1 - клетка недостижима
+  short distance_[BOARD_CELLS];
+  // Рабочие массивы поиска и проверки пути
+  short scratch_[BOARD_CELLS];
+  short queue_[BOARD_CELLS];
+  short body_[BOARD_CELLS + 1];
+  unsigned char virtualBlocked_[BOARD_CELLS];
+  int apple_;
+  bool pathSafe_;
+  unsigned long lastTick_;
+  bool decided_;
+  unsigned long decisions_;
+  unsigned long recomputes_;
+};
+
+}  // namespace s21
+
+#endif  // AUTOPILOT_H
@@ -0,0 +1,262 @@
+#include "batch.h"
+
+using namespace s21;
+
+namespace {
+
+/**
+ * Таблица соседей: клетка, в которую ведет шаг из клетки cell в
+ * направлении direction, лежит в [cell * 4 + direction], -1 - за полем
+ */
+const int16_t* neighbors() {
+  static const std::vector<int16_t> table = [] {
+    std::vector<int16_t> cells(BATCH_CELLS * 4);
+    for (int cell = 0; cell < BATCH_CELLS; cell++)
+      for (int direction = 0; direction < 4; direction++)
+        cells[cell * 4 + direction] = neighborOf(cell, direction);
+    return cells;
+  }();
+  return table.data();
+}
+
+/**
+ * Маска клеток поля в слове битовой доски
+ *
+ * @param word номер слова
+ */
+uint64_t wordMask(int word) {
+  int bits = BATCH_CELLS - word * 64;
+  return bits >= 64 ? ~0ull : (1ull << bits) - 1;
+}
+
+}  // namespace
+
+/**
+ * Создание сред и начало партии в каждой
+ *
+ * @param count количество сред
+ * @param seed зерно; среда env получает свое зерно seed + env * 0x9e3779b9
+ */
+SnakeBatch::SnakeBatch(unsigned int count, uint32_t seed)
+    : count_(count),
+      episodes_(0),
+      bodies_(count * SNAKE_CAPACITY),
+      occupancy_(count * BATCH_WORDS),
+      headSlot_(count),
+      length_(count),
+      head_(count),
+      apple_(count),
+      direction_(count),
+      score_(count),
+      random_(count),
+      next_(count),
+      eaten_(count) {
+  for (unsigned int env = 0; env < count_; env++)
+    random_[env] = seedRandom(seed + env * 0x9e3779b9u);
+  reset();
+}
+
+/**
+ * Начало новой партии во всех средах. Генераторы сред не сбрасываются
+ */
+void SnakeBatch::reset() {
+  for (unsigned int env = 0; env < count_; env++) resetEnv(env);
+  episodes_ = 0;
+}
+
+/**
+ * Проверка занятости клетки телом
+ */
+bool SnakeBatch::isOccupied(unsigned int env, int cell) const {
+  return occupancy_[(cell / 64) * count_ + env] >> (cell % 64) & 1;
+}
+
+/**
+ * Установка или снятие бита клетки на доске среды
+ */
+void SnakeBatch::setOccupied(unsigned int env, int cell, bool occupied) {
+  uint64_t& word = occupancy_[(cell / 64) * count_ + env];
+  uint64_t bit = 1ull << (cell % 64);
+  word = occupied ? word | bit : word & ~bit;
+}
+
+/**
+ * Начальное состояние среды, как у новой игры: змейка из 4 сегментов в
+ * центре поля смотрит вверх, яблоко в случайной свободной клетке
+ *
+ * @param env номер среды
+ */
+void SnakeBatch::resetEnv(unsigned int env) {
+  for (int word = 0; word < BATCH_WORDS; word++)
+    occupancy_[word * count_ + env] = 0;
+  uint8_t* body = &bodies_[env * SNAKE_CAPACITY];
+  for (int i = 0; i < 4; i++) {
+    body[i] = (START_Y + i) * FIELD_WIDTH + START_X;
+    setOccupied(env, body[i], true);
+  }
+  headSlot_[env] = 0;
+  length_[env] = 4;
+  head_[env] = body[0];
+  direction_[env] = Snake::Up;
+  score_[env] = 0;
+  placeApple(env);
+}
+
+/**
+ * Загрузка в среду состояния игры, например снимка Game::snapshot().
+ * Снимок законченной партии может хранить голову за полем, поэтому
+ * принимаются только идущие партии
+ *
+ * @param env номер среды
+ * @param state снимок
+ *
+ * @throw std::invalid_argument партия не идет
+ * @throw std::out_of_range сегмент или яблоко за полем
+ */
+void SnakeBatch::load(unsigned int env, const SnakeState& state) {
+  if (state.playing != PLAYING)
+    throw std::invalid_argument("Only a playing state can be loaded");
+  for (size_t i = 0; i < state.snake.getLength(); i++) {
+    std::pair<int, int> segment = state.snake.getSegment(i);
+    if (!state.field.isInside(segment.first, segment.second))
+      throw std::out_of_range("Segment outside the field");
+  }
+  if (!state.field.isInside(state.appleX, state.appleY))
+    throw std::out_of_range("Apple outside the field");
+  for (int word = 0; word < BATCH_WORDS; word++)
+    occupancy_[word * count_ + env] = 0;
+  uint8_t* body = &bodies_[env * SNAKE_CAPACITY];
+  for (size_t i = 0; i < state.snake.getLength(); i++) {
+    std::pair<int, int> segment = state.snake.getSegment(i);
+    body[i] = segment.second * FIELD_WIDTH + segment.first;
+    setOccupied(env, body[i], true);
+  }
+  headSlot_[env] = 0;
+  length_[env] = state.snake.getLength();
+  head_[env] = body[0];
+  apple_[env] = state.appleY * FIELD_WIDTH + state.appleX;
+  direction_[env] = state.snake.getLastDirection();
+  score_[env] = state.score;
+  random_[env] = state.random;
+}
+
+/**
+ * Яблоко в случайную свободную клетку, как placeApple() игры: свободные
+ * клетки нумеруются по строкам, но считаются по словам доски
+ *
+ * @param env номер среды
+ */
+void SnakeBatch::placeApple(unsigned int env) {
+  unsigned int index =
+      nextRandom(&random_[env]) % (BATCH_CELLS - length_[env]);
+  for (int word = 0; word < BATCH_WORDS; word++) {
+    uint64_t free = ~occupancy_[word * count_ + env] & wordMask(word);
+    unsigned int count = __builtin_popcountll(free);
+    if (index >= count) {
+      index -= count;
+      continue;
+    }
+    for (; index; index--) free &= free - 1;
+    apple_[env] = word * 64 + __builtin_ctzll(free);
+    return;
+  }
+}
+
+/**
+ * Шаг всех сред
+ *
+ * @param actions направления Snake::Direction по средам; поворот назад и
+ * значения вне диапазона оставляют прежнее направление
+ * @param rewards награды шага: яблоко, проигрыш или 0
+ * @param dones 1 - партия закончилась на этом шаге и среда сброшена
+ * @param observations наблюдения после шага, nullptr - не нужны
+ */
+void SnakeBatch::step(const uint8_t* actions, float* rewards, uint8_t* dones,
+                      SnakeObservation* observations) {
+  const int16_t* table = neighbors();
+  for (unsigned int env = 0; env < count_; env++) {
+    uint8_t current = direction_[env], action = actions[env];
+    bool turn = action < 4 && action != (current ^ 1);
+    uint8_t direction = turn ? action : current;
+    direction_[env] = direction;
+    next_[env] = table[head_[env] * 4 + direction];
+    eaten_[env] = next_[env] == apple_[env];
+  }
+
+  for (unsigned int env = 0; env < count_; env++) {
+    uint8_t* body = &bodies_[env * SNAKE_CAPACITY];
+    if (!eaten_[env]) {
+      length_[env]--;
+      int tail = (headSlot_[env] + length_[env]) % SNAKE_CAPACITY;
+      setOccupied(env, body[tail], false);
+    }
+    int next = next_[env];
+    bool done = next < 0 || isOccupied(env, next);
+    rewards[env] = done ? BATCH_DEATH_REWARD : 0;
+    if (!done) {
+      headSlot_[env] = (headSlot_[env] + SNAKE_CAPACITY - 1) % SNAKE_CAPACITY;
+      body[headSlot_[env]] = next;
+      length_[env]++;
+      head_[env] = next;
+      setOccupied(env, next, true);
+    }
+    dones[env] = done;
+  }
+
+  for (unsigned int env = 0; env < count_; env++) {
+    if (eaten_[env] && !dones[env]) {
+      score_[env]++;
+      rewards[env] = BATCH_APPLE_REWARD;
+      if (length_[env] == BATCH_CELLS)
+        dones[env] = 1;
+      else
+        placeApple(env);
+    }
+    if (dones[env]) {
+      episodes_++;
+      resetEnv(env);
+    }
+  }
+  if (observations) observe(observations);
+}
+
+/**
+ * Запись наблюдений всех сред
+ *
+ * @param observations массив из getCount() наблюдений
+ */
+void SnakeBatch::observe(SnakeObservation* observations) const {
+  for (unsigned int env = 0; env < count_; env++) {
+    SnakeObservation& observation = observations[env];
+    for (int word = 0; word < BATCH_WORDS; word++)
+      observation.body[word] = occupancy_[word * count_ + env];
+    observation.head = head_[env];
+    observation.apple = apple_[env];
+    observation.direction = direction_[env];
+    observation.reserved = 0;
+    observation.length = length_[env];
+  }
+}
+
+/**
+ * Наблюдение в формате пакета для одиночной игры, например снимка
+ * Game::snapshot() в прогоне без интерфейса
+ *
+ * @param state снимок
+ * @param observation наблюдение
+ */
+void s21::observeState(const SnakeState& state,
+                       SnakeObservation* observation) {
+  for (int word = 0; word < BATCH_WORDS; word++) observation->body[word] = 0;
+  for (size_t i = 0; i < state.snake.getLength(); i++) {
+    std::pair<int, int> segment = state.snake.getSegment(i);
+    int cell = segment.second * FIELD_WIDTH + segment.first;
+    observation->body[cell / 64] |= 1ull << (cell % 64);
+  }
+  std::pair<int, int> head = state.snake.getSegment(0);
+  observation->head = head.second * FIELD_WIDTH + head.first;
+  observation->apple = state.appleY * FIELD_WIDTH + state.appleX;
+  observation->direction = state.snake.getLastDirection();
+  observation->reserved = 0;
+  observation->length = state.snake.getLength();
+}
@@ -0,0 +1,105 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <vector>
+
+#include "board.h"
+
+#define BATCH_CELLS BOARD_CELLS
+// 64-битных слов в битовой доске поля
+#define BATCH_WORDS ((BATCH_CELLS + 63) / 64)
+// Награда за яблоко и за проигрыш
+#define BATCH_APPLE_REWARD 1.0f
+#define BATCH_DEATH_REWARD -1.0f
+
+namespace s21 {
+
+/**
+ * Сжатое наблюдение одной среды: занятые телом клетки битами, номера
+ * клеток головы и яблока (y * FIELD_WIDTH + x), направление и длина
+ */
+struct SnakeObservation {
+  uint64_t body[BATCH_WORDS];
+  uint8_t head;
+  uint8_t apple;
+  uint8_t direction;
+  uint8_t reserved;
+  uint16_t length;
+};
+
+/**
+ * Набор независимых партий Snake, которые делают шаг одним вызовом. Правила
+ * те же, что у advanceState: голова может войти в клетку уходящего хвоста,
+ * яблоко ставится в случайную свободную клетку тем же генератором, поэтому
+ * среда, загруженная из снимка, идет с игрой шаг в шаг
+ *
+ * Состояние хранится структурой массивов: у каждого поля свой массив по
+ * всем средам, тело - кольцевой буфер номеров клеток, занятость поля -
+ * битовая доска, слова которой тоже лежат подряд по средам. Шаг разбит на
+ * проходы по всем средам: выбор направления и новой головы без ветвлений,
+ * затем обновление досок и тел, затем редкие события - съеденные яблоки
+ * и сброс закончившихся партий. Сброс автоматический: после проигрыша или
+ * победы среда начинает новую партию, а в наблюдение пишется ее начало
+ */
+class SnakeBatch {
+ public:
+  SnakeBatch(unsigned int count, uint32_t seed);
+  void reset();
+  void load(unsigned int env, const SnakeState& state);
+  void step(const uint8_t* actions, float* rewards, uint8_t* dones,
+            SnakeObservation* observations);
+  void observe(SnakeObservation* observations) const;
+
+  /**
+   * Получение количества сред
+   */
+  unsigned int getCount() const { return count_; }
+
+  /**
+   * Получение количества законченных партий во всех средах
+   */
+  unsigned long getEpisodes() const { return episodes_; }
+
+  /**
+   * Получение очков текущей партии среды
+   *
+   * @param env номер среды
+   */
+  uint32_t getScore(unsigned int env) const { return score_[env]; }
+
+  /**
+   * Получение состояния генератора среды
+   *
+   * @param env номер среды
+   */
+  uint32_t getRandom(unsigned int env) const { return random_[env]; }
+
+ private:
+  void resetEnv(unsigned int env);
+  void placeApple(unsigned int env);
+  bool isOccupied(unsigned int env, int cell) const;
+  void setOccupied(unsigned int env, int cell, bool occupied);
+
+  unsigned int count_;
+  unsigned long episodes_;
+  // Кольцевые буферы тел: SNAKE_CAPACITY номеров клеток на среду
+  std::vector<uint8_t> bodies_;
+  // Битовые доски: слово word среды env лежит в [word * count_ + env]
+  std::vector<uint64_t> occupancy_;
+  std::vector<uint16_t> headSlot_;
+  std::vector<uint16_t> length_;
+  std::vector<uint8_t> head_;
+  std::vector<uint8_t> apple_;
+  std::vector<uint8_t> direction_;
+  std::vector<uint32_t> score_;
+  std::vector<uint32_t> random_;
+  // Новая голова каждой среды на текущем шаге, -1 - за пределами поля
+  std::vector<int16_t> next_;
+  std::vector<uint8_t> eaten_;
+};
+
+void observeState(const SnakeState& state, SnakeObservation* observation);
+
+}  // namespace s21
+
+#endif  // BATCH_H
@@ -0,0 +1,51 @@
+#ifndef BOARD_H
+#define BOARD_H
+
+#include <utility>
+
+#include "snake.h"
+
+#define BOARD_CELLS (FIELD_WIDTH * FIELD_HEIGHT)
+
+namespace s21 {
+
+// Смещения в порядке Snake::Direction: Left, Right, Up, Down
+inline constexpr int kDx[] = {-1, 1, 0, 0};
+inline constexpr int kDy[] = {0, 0, -1, 1};
+
+/**
+ * Номер клетки поля по координатам
+ *
+ * @param point координаты
+ * @param width ширина поля
+ * @param height высота поля
+ *
+ * @return номер клетки, -1 - координаты за пределами поля
+ */
+inline int cellOf(std::pair<int, int> point, int width = FIELD_WIDTH,
+                  int height = FIELD_HEIGHT) {
+  if (point.first < 0 || point.first >= width || point.second < 0 ||
+      point.second >= height)
+    return -1;
+  return point.second * width + point.first;
+}
+
+/**
+ * Получение соседней клетки
+ *
+ * @param cell номер клетки
+ * @param direction направление
+ * @param width ширина поля
+ * @param height высота поля
+ *
+ * @return номер соседней клетки, -1 - соседняя клетка за пределами поля
+ */
+inline int neighborOf(int cell, int direction, int width = FIELD_WIDTH,
+                      int height = FIELD_HEIGHT) {
+  return cellOf({cell % width + kDx[direction], cell / width + kDy[direction]},
+                width, height);
+}
+
+}  // namespace s21
+
+#endif  // BOARD_H
@@ -0,0 +1,228 @@
+#include "hamiltonian.h"
+
+using namespace s21;
+
+namespace {
+
+/**
+ * Номер клетки поля размера цикла по координатам
+ */
+int cycleCell(const HamiltonianCycle& cycle, std::pair<int, int> point) {
+  return s21::cellOf(point, cycle.width, cycle.height);
+}
+
+/**
+ * Соседняя клетка на поле размера цикла
+ */
+int cycleNeighbor(const HamiltonianCycle& cycle, int cell, int direction) {
+  return s21::neighborOf(cell, direction, cycle.width, cycle.height);
+}
+
+/**
+ * Проверка, занята ли клетка телом змейки. Хвост не считается: если змейка
+ * не съест яблоко, на следующем шаге он освободит клетку
+ */
+bool occupied(const HamiltonianCycle& cycle, const Snake& snake, int cell) {
+  for (size_t i = 0; i + 1 < snake.getLength(); i++)
+    if (cycleCell(cycle, snake.getSegment(i)) == cell) return true;
+  return false;
+}
+
+}  // namespace
+
+/**
+ * Построение гамильтонова цикла. Цикл идет змейкой по строкам, не заходя в
+ * первый столбец, и возвращается по нему наверх. Для этого нужно четное
+ * число строк; при нечетном поле обходится по столбцам
+ *
+ * @param width ширина поля
+ * @param height высота поля
+ * @param cycle цикл
+ *
+ * @return false - цикла не существует или поле больше BOARD_CELLS
+ */
+bool s21::buildHamiltonianCycle(int width, int height,
+                                HamiltonianCycle* cycle) {
+  if (width < 2 || height < 2 || width * height > BOARD_CELLS) return false;
+  bool transposed = height % 2;
+  if (transposed && width % 2) return false;
+  cycle->width = width;
+  cycle->height = height;
+  int rows = transposed ? width : height;
+  int columns = transposed ? height : width;
+  int position = 0;
+  // Змейка по строкам во всех столбцах, кроме первого, затем возврат по
+  // первому столбцу
+  for (int i = 0; i < rows * columns; i++) {
+    int row, column;
+    if (i < rows * (columns - 1)) {
+      row = i / (columns - 1);
+      int c = i % (columns - 1) + 1;
+      column = row % 2 ? columns - c : c;
+    } else {
+      row = rows * columns - 1 - i;
+      column = 0;
+    }
+    int cell = transposed ? column * width + row : row * width + column;
+    cycle->cells[position] = cell;
+    cycle->order[cell] = position++;
+  }
+  return true;
+}
+
+/**
+ * Получение гамильтонова цикла для поля игры. Размер поля задан при
+ * компиляции, поэтому цикл строится один раз и хранится до конца программы
+ *
+ * @return цикл
+ */
+const HamiltonianCycle& s21::getHamiltonianCycle() {
+  static HamiltonianCycle cycle;
+  static bool built = buildHamiltonianCycle(FIELD_WIDTH, FIELD_HEIGHT, &cycle);
+  (void)built;
+  return cycle;
+}
+
+HamiltonianSolver::HamiltonianSolver()
+    : cycle_(getHamiltonianCycle()), decisions_(0), shortcuts_(0) {
+  reset();
+}
+
+/**
+ * Сброс состояния, например при начале новой игры
+ */
+void HamiltonianSolver::reset() {
+  aligned_ = false;
+  expectedHead_ = -1;
+}
+
+/**
+ * Расстояние вдоль цикла
+ *
+ * @param from начальная клетка
+ * @param to конечная клетка
+ *
+ * @return количество шагов по циклу от from до to
+ */
+int HamiltonianSolver::distance(int from, int to) const {
+  int cells = cycle_.width * cycle_.height;
+  return (cycle_.order[to] - cycle_.order[from] + cells) % cells;
+}
+
+/**
+ * Проверка, что тело змейки лежит на цикле по порядку от хвоста к голове
+ * в пределах одного круга. Тогда клетки цикла от головы до хвоста свободны
+ *
+ * @param snake змейка
+ *
+ * @return true - тело лежит на цикле по порядку
+ */
+bool HamiltonianSolver::isAligned(const Snake& snake) const {
+  int span = 0;
+  int previous = cycleCell(cycle_, snake.getHead());
+  for (size_t i = 1; i < snake.getLength(); i++) {
+    int cell = cycleCell(cycle_, snake.getSegment(i));
+    if (previous < 0 || cell < 0) return false;
+    span += distance(cell, previous);
+    previous = cell;
+  }
+  return span < cycle_.width * cycle_.height;
+}
+
+/**
+ * Шаг змейки, тело которой еще не легло на цикл, например в начале игры:
+ * следующая клетка цикла, если она свободна, иначе любая свободная
+ *
+ * @param snake змейка
+ * @param head клетка головы
+ *
+ * @return направление, -1 - свободных соседних клеток нет
+ */
+int HamiltonianSolver::followCycle(const Snake& snake, int head) const {
+  int cells = cycle_.width * cycle_.height;
+  int next = cycle_.cells[(cycle_.order[head] + 1) % cells];
+  int fallback = -1;
+  for (int direction = 0; direction < 4; direction++) {
+    int cell = cycleNeighbor(cycle_, head, direction);
+    if (cell < 0 || occupied(cycle_, snake, cell) ||
+        snake.isOpposite(static_cast<Snake::Direction>(direction)))
+      continue;
+    if (cell == next) return direction;
+    if (fallback < 0) fallback = direction;
+  }
+  return fallback;
+}
+
+/**
+ * Выбор направления змейки на следующий шаг. Пока тело лежит на цикле,
+ * безопасность хода проверяется за O(1) по номерам клеток вдоль цикла:
+ * соседняя клетка ближе к голове по циклу, чем хвост, заведомо свободна
+ *
+ * @param snake змейка
+ * @param apple координаты яблока
+ *
+ * @return направление
+ */
+Snake::Direction HamiltonianSolver::decide(const Snake& snake,
+                                           std::pair<int, int> apple) {
+  decisions_++;
+  int head = cycleCell(cycle_, snake.getHead());
+  if (head < 0) return snake.getDirection();
+  if (!aligned_ || head != expectedHead_) aligned_ = isAligned(snake);
+  int best = -1;
+  if (aligned_) {
+    int cells = cycle_.width * cycle_.height;
+    int length = static_cast<int>(snake.getLength());
+    int tail = cycleCell(cycle_, snake.getSegment(length - 1));
+    int target = cycleCell(cycle_, apple);
+    int toTail = length > 1 ? distance(head, tail) : cells;
+    int toApple = target >= 0 ? distance(head, target) : cells;
+    int empty = cells - length - 1;
+    // Срезка оставляет перед хвостом место на длину змейки и запас
+    int limit = toTail - length - SHORTCUT_BUFFER;
+    if (empty < cells / 2) {
+      limit = 1;
+    } else if (toApple < toTail) {
+      // Змейка вырастет, а новое яблоко может появиться прямо перед ней
+      limit--;
+      // Новые яблоки чаще появляются на длинном участке от яблока до
+      // хвоста и съедаются подряд, пока хвост почти не сдвигается. Каждое
+      // удлиняет змейку, поэтому срезка оставляет запас на несколько
+      // таких яблок, иначе голова догонит хвост раньше, чем он отойдет
+      if ((toTail - toApple) * SHORTCUT_GAP_DIVISOR > empty)
+        limit -= SHORTCUT_GROWTH_RESERVE;
+    }
+    if (limit > toApple) limit = toApple;
+    if (limit < 1) limit = 1;
+    int bestStep = 0;
+    for (int direction = 0; direction < 4; direction++) {
+      int cell = cycleNeighbor(cycle_, head, direction);
+      if (cell < 0) continue;
+      int step = distance(head, cell);
+      if (step <= limit && step > bestStep) {
+        best = direction;
+        bestStep = step;
+      }
+    }
+    if (bestStep > 1) shortcuts_++;
+  } else {
+    best = followCycle(snake, head);
+  }
+  if (best < 0) {
+    expectedHead_ = -1;
+    return snake.getDirection();
+  }
+  expectedHead_ = cycleNeighbor(cycle_, head, best);
+  return static_cast<Snake::Direction>(best);
+}
+
+/**
+ * Выбор направления змейки в игре
+ *
+ * @param game игра
+ *
+ * @return направление
+ */
+Snake::Direction HamiltonianSolver::decide(Game& game) {
+  return decide(game.getSnake(), game.getApple());
+}
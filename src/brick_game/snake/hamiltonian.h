@@ -0,0 +1,72 @@
+#ifndef HAMILTONIAN_H
+#define HAMILTONIAN_H
+
+#include "board.h"
+
+// Запас свободных клеток перед хвостом, который не тратится на срезки
+#define SHORTCUT_BUFFER 3
+// Срезка к яблоку укорачивается, когда участок цикла от яблока до хвоста
+// длиннее 1/SHORTCUT_GAP_DIVISOR свободных клеток
+#define SHORTCUT_GAP_DIVISOR 4
+// Клетки, которые такая срезка оставляет на рост от следующих яблок
+#define SHORTCUT_GROWTH_RESERVE 10
+
+namespace s21 {
+
+/**
+ * Гамильтонов цикл по полю: обход, проходящий каждую клетку ровно один
+ * раз и возвращающийся в начало. order - номер клетки вдоль цикла, cells -
+ * клетка по номеру, так что положение на цикле находится за O(1)
+ */
+struct HamiltonianCycle {
+  int width;
+  int height;
+  short order[BOARD_CELLS];
+  short cells[BOARD_CELLS];
+};
+
+bool buildHamiltonianCycle(int width, int height, HamiltonianCycle* cycle);
+const HamiltonianCycle& getHamiltonianCycle();
+
+/**
+ * Решатель, гарантированно заполняющий поле. Змейка идет по гамильтонову
+ * циклу, поэтому ее тело всегда лежит на цикле между хвостом и головой и
+ * путь вперед до хвоста свободен. Чтобы не обходить все поле ради каждого
+ * яблока, решатель срезает путь к соседней клетке дальше по циклу, если
+ * она остается перед хвостом с запасом на рост змейки. Когда поле
+ * заполнено наполовину, срезки прекращаются
+ */
+class HamiltonianSolver {
+ public:
+  HamiltonianSolver();
+  void reset();
+  Snake::Direction decide(const Snake& snake, std::pair<int, int> apple);
+  Snake::Direction decide(Game& game);
+
+  /**
+   * Получение количества принятых решений
+   */
+  unsigned long getDecisions() const { return decisions_; }
+
+  /**
+   * Получение количества срезок пути
+   */
+  unsigned long getShortcuts() const { return shortcuts_; }
+
+ private:
+  int distance(int from, int to) const;
+  bool isAligned(const Snake& snake) const;
+  int followCycle(const Snake& snake, int head) const;
+
+  const HamiltonianCycle& cycle_;
+  // Тело лежит на цикле по порядку, срезки безопасны
+  bool aligned_;
+  // Клетка, куда должна была перейти голова после прошлого решения
+  int expectedHead_;
+  unsigned long decisions_;
+  unsigned long shortcuts_;
+};
+
+}  // namespace s21
+
+#endif  // HAMILTONIAN_H
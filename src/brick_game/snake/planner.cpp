@@ -0,0 +1,168 @@
+#include "planner.h"
+
+#include <cstdlib>
+
+#include "board.h"
+
+using namespace s21;
+
+namespace {
+
+/**
+ * Ход змейки в случайной партии: свободная клетка, в трех случаях из
+ * четырех - приближающая к яблоку, если такая есть
+ *
+ * @param state состояние партии
+ * @param random состояние генератора партии
+ *
+ * @return направление
+ */
+Snake::Direction rolloutDirection(const SnakeState& state, uint32_t* random) {
+  std::pair<int, int> head = state.snake.getHead();
+  int distance = std::abs(head.first - state.appleX) +
+                 std::abs(head.second - state.appleY);
+  Snake::Direction safe[4], closer[4];
+  int safeCount = 0, closerCount = 0;
+  for (int i = 0; i < 4; i++) {
+    Snake::Direction direction = static_cast<Snake::Direction>(i);
+    int x = head.first + kDx[i], y = head.second + kDy[i];
+    if (state.snake.isOpposite(direction) || !state.field.isInside(x, y))
+      continue;
+    char block = state.field.getBlock(x, y);
+    if (block == 1 || block == 2) continue;
+    safe[safeCount++] = direction;
+    if (std::abs(x - state.appleX) + std::abs(y - state.appleY) < distance)
+      closer[closerCount++] = direction;
+  }
+  if (!safeCount) return state.snake.getDirection();
+  uint32_t value = nextRandom(random);
+  if (closerCount && (value & 3)) return closer[(value >> 2) % closerCount];
+  return safe[(value >> 2) % safeCount];
+}
+
+}  // namespace
+
+/**
+ * Создание планировщика
+ *
+ * @param threads количество потоков
+ * @param playouts партий на одно решение
+ * @param depth шагов в партии
+ * @param budget время на одно решение
+ */
+MonteCarloPlanner::MonteCarloPlanner(unsigned int threads,
+                                     unsigned int playouts,
+                                     unsigned int depth,
+                                     std::chrono::nanoseconds budget)
+    : pool_(threads),
+      batches_(playouts / (PLANNER_CANDIDATES * PLANNER_BATCH)),
+      depth_(depth ? depth : 1),
+      budget_(budget),
+      root_(),
+      candidateCount_(0),
+      decisions_(0),
+      playouts_(0),
+      skipped_(0) {
+  if (!batches_) batches_ = 1;
+  results_.resize(PLANNER_CANDIDATES * batches_);
+}
+
+/**
+ * Одна партия из корневого состояния
+ *
+ * @param first направление первого шага
+ * @param random состояние генератора партии
+ *
+ * @return оценка партии
+ */
+double MonteCarloPlanner::playout(Snake::Direction first,
+                                  uint32_t* random) const {
+  SnakeState state = root_;
+  state.snake.setDirection(first);
+  double reward = 0;
+  for (unsigned int step = 0; step < depth_; step++) {
+    if (step) state.snake.setDirection(rolloutDirection(state, random));
+    int score = state.score;
+    advanceState(state);
+    if (state.score != score)
+      reward += PLANNER_APPLE_WEIGHT * (depth_ - step) / depth_;
+    if (state.playing == GAMEOVER)
+      return reward + static_cast<double>(step) / depth_;
+    if (state.playing == WIN) break;
+  }
+  return reward + 1.0;
+}
+
+/**
+ * Задача пула: PLANNER_BATCH партий для одного направления
+ *
+ * @param context планировщик
+ * @param index номер задачи
+ */
+void MonteCarloPlanner::playBatch(void* context, unsigned int index,
+                                  unsigned int) {
+  MonteCarloPlanner* planner = static_cast<MonteCarloPlanner*>(context);
+  Result& result = planner->results_[index];
+  result.reward = 0;
+  result.playouts = 0;
+  if (std::chrono::steady_clock::now() >= planner->deadline_) return;
+  uint32_t random =
+      seedRandom((planner->decisions_ * 0x9e3779b9u) ^ (index * 0x85ebca6bu));
+  Snake::Direction first =
+      planner->candidates_[index % planner->candidateCount_];
+  for (int i = 0; i < PLANNER_BATCH; i++) {
+    result.reward += planner->playout(first, &random);
+    result.playouts++;
+  }
+}
+
+/**
+ * Выбор направления змейки на следующий шаг
+ *
+ * @param state состояние игры
+ *
+ * @return направление с лучшей средней оценкой партий
+ */
+Snake::Direction MonteCarloPlanner::decide(const SnakeState& state) {
+  decisions_++;
+  if (state.playing != PLAYING) return state.snake.getDirection();
+  root_ = state;
+  candidateCount_ = 0;
+  for (int i = 0; i < PLANNER_DIRECTIONS; i++)
+    if (!state.snake.isOpposite(static_cast<Snake::Direction>(i)))
+      candidates_[candidateCount_++] = static_cast<Snake::Direction>(i);
+  unsigned int tasks = candidateCount_ * batches_;
+  deadline_ = std::chrono::steady_clock::now() + budget_;
+  pool_.run(playBatch, this, tasks);
+
+  double reward[PLANNER_CANDIDATES] = {};
+  unsigned int played[PLANNER_CANDIDATES] = {};
+  for (unsigned int i = 0; i < tasks; i++) {
+    reward[i % candidateCount_] += results_[i].reward;
+    played[i % candidateCount_] += results_[i].playouts;
+    playouts_ += results_[i].playouts;
+    skipped_ += !results_[i].playouts;
+  }
+  int best = -1;
+  double bestReward = 0;
+  for (unsigned int i = 0; i < candidateCount_; i++) {
+    if (!played[i]) continue;
+    double average = reward[i] / played[i];
+    if (best < 0 || average > bestReward) {
+      best = i;
+      bestReward = average;
+    }
+  }
+  return best < 0 ? state.snake.getDirection() : candidates_[best];
+}
+
+/**
+ * Выбор направления змейки в игре
+ *
+ * @param game игра
+ *
+ * @return направление
+ */
+Snake::Direction MonteCarloPlanner::decide(Game& game) {
+  return decide(game.snapshot());
+}
@@ -0,0 +1,93 @@
+#ifndef PLANNER_H
+#define PLANNER_H
+
+#include <vector>
+
+#include "../common/work_pool.h"
+#include "snake.h"
+
+// Партий на одно решение, поровну на каждое допустимое направление
+#define PLANNER_PLAYOUTS 4096
+// Направлений хода змейки
+#define PLANNER_DIRECTIONS 4
+// Допустимых направлений на одно решение: все, кроме разворота
+#define PLANNER_CANDIDATES (PLANNER_DIRECTIONS - 1)
+// Шагов в одной партии
+#define PLANNER_DEPTH 40
+// Партий в одной задаче пула
+#define PLANNER_BATCH 32
+// Время на одно решение
+#define PLANNER_BUDGET_NS 20000000
+// Вес яблока относительно выживания до конца партии
+#define PLANNER_APPLE_WEIGHT 1.0
+
+namespace s21 {
+
+/**
+ * Планировщик Монте-Карло. Каждое допустимое направление оценивается
+ * короткими случайными партиями из копии текущего состояния: змейка
+ * выбирает свободные клетки, чаще ведущие к яблоку. Оценка складывается из
+ * доли прожитых шагов и съеденных яблок, причем раннее яблоко ценится
+ * выше. Партии делятся на задачи пула потоков с перехватом работы; задачи,
+ * начатые после истечения времени на решение, пропускаются
+ */
+class MonteCarloPlanner {
+ public:
+  explicit MonteCarloPlanner(
+      unsigned int threads, unsigned int playouts = PLANNER_PLAYOUTS,
+      unsigned int depth = PLANNER_DEPTH,
+      std::chrono::nanoseconds budget =
+          std::chrono::nanoseconds(PLANNER_BUDGET_NS));
+  Snake::Direction decide(const SnakeState& state);
+  Snake::Direction decide(Game& game);
+
+  /**
+   * Получение количества принятых решений
+   */
+  unsigned long getDecisions() const { return decisions_; }
+
+  /**
+   * Получение количества сыгранных партий
+   */
+  unsigned long getPlayouts() const { return playouts_; }
+
+  /**
+   * Получение количества задач, пропущенных из-за нехватки времени
+   */
+  unsigned long getSkipped() const { return skipped_; }
+
+  /**
+   * Получение пула потоков
+   */
+  const WorkPool& getPool() const { return pool_; }
+
+ private:
+  /**
+   * Итог задачи пула; задачи разных потоков лежат в разных строках кэша
+   */
+  struct alignas(WORK_POOL_LINE) Result {
+    double reward;
+    unsigned int playouts;
+  };
+
+  static void playBatch(void* context, unsigned int index,
+                        unsigned int worker);
+  double playout(Snake::Direction first, uint32_t* random) const;
+
+  WorkPool pool_;
+  unsigned int batches_;
+  unsigned int depth_;
+  std::chrono::nanoseconds budget_;
+  std::chrono::steady_clock::time_point deadline_;
+  SnakeState root_;
+  Snake::Direction candidates_[PLANNER_CANDIDATES];
+  unsigned int candidateCount_;
+  std::vector<Result> results_;
+  unsigned long decisions_;
+  unsigned long playouts_;
+  unsigned long skipped_;
+};
+
+}  // namespace s21
+
+#endif  // PLANNER_H
@@ -2,6 +2,137 @@
 
 using namespace s21;
 
+namespace {
+
+/**
+ * Смещение головы для направления движения
+ *
+ * @param direction направление
+ *
+ * @return смещение по горизонтали и вертикали
+ */
+std::pair<int, int> directionDelta(Snake::Direction direction) {
+  switch (direction) {
+    case Snake::Direction::Left:
+      return {-1, 0};
+    case Snake::Direction::Right:
+      return {1, 0};
+    case Snake::Direction::Up:
+      return {0, -1};
+    case Snake::Direction::Down:
+      break;
+  }
+  return {0, 1};
+}
+
+/**
+ * Перемещение змейки на заданное количество клеток. Если голова попала на
+ * яблоко, хвост остается на месте
+ *
+ * @param snake змейка
+ * @param dx смещение по горизонтали
+ * @param dy смещение по вертикали
+ * @param apple координаты яблока
+ *
+ * @return true - яблоко съедено
+ */
+bool moveSnake(Snake& snake, int dx, int dy, std::pair<int, int> apple) {
+  std::pair<int, int> newHead = snake.getHead();
+  newHead.first += dx;
+  newHead.second += dy;
+  snake.pushFront(newHead);
+  bool eaten = newHead == apple;
+  if (!eaten) snake.popBack();
+  snake.setLastDirection(snake.getDirection());
+  return eaten;
+}
+
+/**
+ * Стирание змейки с поля
+ */
+void clearSnake(Field& field, const Snake& snake) {
+  for (size_t i = 0; i < snake.getLength(); i++) {
+    std::pair<int, int> segment = snake.getSegment(i);
+    field.setBlock(segment.first, segment.second, 0);
+  }
+}
+
+/**
+ * Рисование змейки на поле: голова - 2, тело - 1
+ */
+void paintSnake(Field& field, const Snake& snake) {
+  for (size_t i = 0; i < snake.getLength(); i++) {
+    int x = snake.getSegment(i).first;
+    int y = snake.getSegment(i).second;
+    if (field.isInside(x, y)) {
+      if (i == 0)
+        field.setBlock(x, y, 2);
+      else
+        field.setBlock(x, y, 1);
+    }
+  }
+}
+
+/**
+ * Выбор случайной свободной клетки для яблока. Свободные клетки не
+ * собираются в список: первый проход считает их, второй находит выбранную
+ *
+ * @param field поле
+ * @param random состояние генератора
+ * @param apple координаты яблока
+ */
+void placeApple(Field& field, uint32_t* random, std::pair<int, int>* apple) {
+  unsigned int emptyBlocks = 0;
+  for (int i = 0; i < FIELD_HEIGHT * FIELD_WIDTH; i++)
+    if (field.getBlock(i % FIELD_WIDTH, i / FIELD_WIDTH) == 0) emptyBlocks++;
+  unsigned int randomIndex = nextRandom(random) % emptyBlocks;
+  for (int i = 0; i < FIELD_HEIGHT * FIELD_WIDTH; i++) {
+    int x = i % FIELD_WIDTH, y = i / FIELD_WIDTH;
+    if (field.getBlock(x, y) != 0) continue;
+    if (randomIndex-- == 0) {
+      *apple = {x, y};
+      field.setBlock(x, y, 3);
+      break;
+    }
+  }
+}
+
+/**
+ * Столкновения головы змейки с границами поля и телом
+ */
+bool hitsSnake(const Field& field, const Snake& snake) {
+  std::pair<int, int> head = snake.getHead();
+  bool collided = 0;
+  if (!field.isInside(head.first, head.second)) collided = 1;
+  for (size_t i = 1; i < snake.getLength(); i++)
+    if (head == snake.getSegment(i)) collided = 1;
+  return collided;
+}
+
+/**
+ * Ключ клетки поля с блоком
+ *
+ * @param cell номер клетки
+ * @param block значение блока
+ *
+ * @return ключ, у пустой клетки - 0, так что хеш пустого поля нулевой
+ */
+uint64_t blockKey(int cell, char block) {
+  return block ? zobristKey(HASH_FIELD_KEYS + cell * 4 + block) : 0;
+}
+
+/**
+ * Начисление очка за яблоко
+ */
+void scoreApple(int* score, int* speed, int* level) {
+  *score += 1;
+  // Когда игрок набирает 5 очков, уровень увеличивается на 1
+  *speed = *speed > 10 ? 10 : *score / 5 + 1;
+  *level = *speed;
+}
+
+}  // namespace
+
 // ----------Snake----------
 
 /**
@@ -9,12 +140,36 @@ using namespace s21;
  * и последним направлением
  */
 Snake::Snake()
-    : body({{START_X, START_Y},
-            {START_X, START_Y + 1},
-            {START_X, START_Y + 2},
-            {START_X, START_Y + 3}}),
+    : body(),
+      head(0),
+      length(0),
+      hash(0),
       direction(Direction::Up),
-      lastDirection(Direction::Up) {}
+      lastDirection(Direction::Up) {
+  for (int i = 3; i >= 0; i--) pushFront({START_X, START_Y + i});
+}
+
+/**
+ * Добавление нового сегмента перед головой змейки
+ *
+ * @param point координаты новой головы
+ */
+void Snake::pushFront(std::pair<int, int> point) {
+  head = (head + SNAKE_CAPACITY - 1) % SNAKE_CAPACITY;
+  length++;
+  body[head].x = point.first;
+  body[head].y = point.second;
+  hash ^= segmentKey(head);
+}
+
+/**
+ * Удаление хвостового сегмента змейки
+ */
+void Snake::popBack() {
+  if (!length) return;
+  length--;
+  hash ^= segmentKey((head + length) % SNAKE_CAPACITY);
+}
 
 /**
  * Проверка на противоположность нового направления движения последнему
@@ -26,14 +181,23 @@ Snake::Snake()
  * @return false - новое направление не противоположно
  */
 bool Snake::isOpposite(Direction newDirection) const {
-  Direction cur = getLastDirection();
-  if ((cur == Direction::Left && newDirection == Direction::Right) ||
-      (cur == Direction::Right && newDirection == Direction::Left) ||
-      (cur == Direction::Up && newDirection == Direction::Down) ||
-      (cur == Direction::Down && newDirection == Direction::Up))
-    return true;
-  else
-    return false;
+  return isOpposite(getLastDirection(), newDirection);
+}
+
+/**
+ * Проверка на противоположность двух направлений
+ *
+ * @param first первое направление
+ * @param second второе направление
+ *
+ * @return true - направления противоположны
+ * @return false - направления не противоположны
+ */
+bool Snake::isOpposite(Direction first, Direction second) {
+  return (first == Direction::Left && second == Direction::Right) ||
+         (first == Direction::Right && second == Direction::Left) ||
+         (first == Direction::Up && second == Direction::Down) ||
+         (first == Direction::Down && second == Direction::Up);
 }
 
 /**
@@ -48,20 +212,10 @@ void Snake::setDirection(Direction newDirection) {
 // ----------Field----------
 
 /**
- * Конструктор поля, инициализирует поле заданной ширины и высоты, выделяет
- * память для массива блоков и заполняет его нулями
+ * Конструктор поля, инициализирует поле заданной ширины и высоты и заполняет
+ * массив блоков нулями
  */
-Field::Field() { blocks = new char[width * height](); }
-
-/**
- * Деструктор поля, освобождает память, выделенную для массива блоков
- */
-Field::~Field() {
-  if (blocks) {
-    delete[] blocks;
-    blocks = nullptr;
-  }
-}
+Field::Field() : blocks(), hash(0) {}
 
 /**
  * Проверка нахождения координат в пределах поля
@@ -99,7 +253,9 @@ char Field::getBlock(int x, int y) const {
  */
 void Field::setBlock(int x, int y, char value) {
   if (!isInside(x, y)) throw std::out_of_range("Block outside the field");
-  blocks[y * width + x] = value;
+  int cell = y * width + x;
+  hash ^= blockKey(cell, blocks[cell]) ^ blockKey(cell, value);
+  blocks[cell] = value;
 }
 
 /**
@@ -122,7 +278,19 @@ Game::Game()
       appleEaten(0),
       playing(PLAYING),
       isBoosted(0),
-      boostFactor(1.5) {
+      boostFactor(BOOST_FACTOR),
+      tick(0),
+      generation(0),
+      random(seedRandom(std::time(nullptr))),
+      recorder(),
+      pendingTurns(0),
+      queuedDirection(Snake::Direction::Right) {
+  static const char* const phaseNames[SNAKE_PHASES] = {
+      "frame",         "step",      "resetSnake", "updateSnake",
+      "calculateTurn", "collision", "composite"};
+  initEngineStats(&stats, phaseNames, SNAKE_PHASES);
+  initRewindRing(&rewindRing, rewindStates, sizeof(SnakeState),
+                 REWIND_CAPACITY);
   lastActionTime = std::chrono::steady_clock::now();
   info.field = new int*[FIELD_HEIGHT];
   for (int i = 0; i < FIELD_HEIGHT; i++) info.field[i] = new int[FIELD_WIDTH];
@@ -135,13 +303,17 @@ Game::Game()
   info.level = 1;
   info.speed = 1;
   info.pause = 0;
+  resetRewind();
 }
 
 /**
  * Деструктор игры, освобождает память, выделенную для игрового поля и других
  * ресурсов
  */
-Game::~Game() { freeGameInfo(); }
+Game::~Game() {
+  stopRecording();
+  freeGameInfo();
+}
 
 /**
  * Создание единственного экземпляра класса Game
@@ -165,14 +337,7 @@ void Game::freeGameInfo() {
 /**
  * Обнуление значений сегментов змейки
  */
-void Game::resetSnake() {
-  std::deque<std::pair<int, int>>& body = snake.getBody();
-  for (size_t i = 0; i < body.size(); i++) {
-    int x = body[i].first;
-    int y = body[i].second;
-    field.setBlock(x, y, 0);
-  }
-}
+void Game::resetSnake() { clearSnake(field, snake); }
 
 /**
  * Обнуление info.field
@@ -182,6 +347,15 @@ void Game::resetInfoField() {
     for (int j = 0; j < FIELD_WIDTH; j++) info.field[i][j] = 0;
 }
 
+/**
+ * Копирование блоков поля в info.field
+ */
+void Game::updateInfoField() {
+  for (int i = 0; i < FIELD_HEIGHT; i++)
+    for (int j = 0; j < FIELD_WIDTH; j++)
+      info.field[i][j] = field.getBlock(j, i);
+}
+
 /**
  * Обнуление всей информации о состоянии игры
  */
@@ -205,9 +379,12 @@ void Game::resetGame() {
   appleEaten = 0;
   playing = PLAYING;
   isBoosted = 0;
-  boostFactor = 1.5;
+  boostFactor = BOOST_FACTOR;
   resetInfo();
   lastActionTime = std::chrono::steady_clock::now();
+  tick = 0;
+  clearTurns();
+  resetRewind();
 }
 
 /**
@@ -217,13 +394,7 @@ void Game::resetGame() {
  * @param dy смещение по вертикали
  */
 void Game::move(int dx, int dy) {
-  std::deque<std::pair<int, int>>& body = snake.getBody();
-  std::pair<int, int> newHead = snake.getHead();
-  newHead.first += dx;
-  newHead.second += dy;
-  body.push_front(newHead);
-  if (!appleCollision()) body.pop_back();
-  snake.setLastDirection(snake.getDirection());
+  if (moveSnake(snake, dx, dy, apple)) appleEaten = 1;
 }
 
 /**
@@ -249,33 +420,14 @@ void Game::moveDown() { move(0, 1); }
 /**
  * Добавление змейки на поле
  */
-void Game::addSnake() {
-  std::deque<std::pair<int, int>>& body = snake.getBody();
-  for (size_t i = 0; i < body.size(); i++) {
-    int x = body[i].first;
-    int y = body[i].second;
-    if (field.isInside(x, y)) {
-      if (i == 0)
-        field.setBlock(x, y, 2);
-      else
-        field.setBlock(x, y, 1);
-    }
-  }
-}
+void Game::addSnake() { paintSnake(field, snake); }
 
 /**
  * Добавление яблока на поле в случайное место
  */
 void Game::addApple() {
   appleEaten = 0;
-  std::vector<std::pair<int, int>> emptyBlocks;
-  for (int i = 0; i < FIELD_HEIGHT; i++)
-    for (int j = 0; j < FIELD_WIDTH; j++)
-      if (field.getBlock(j, i) == 0) emptyBlocks.push_back({j, i});
-  int randomIndex = std::rand() % emptyBlocks.size();
-  auto& block = emptyBlocks[randomIndex];
-  apple = block;
-  field.setBlock(block.first, block.second, 3);
+  placeApple(field, &random, &apple);
 }
 
 /**
@@ -284,15 +436,7 @@ void Game::addApple() {
  * @return true - произошло столкновение
  * @return false - не произошло столкновение
  */
-bool Game::snakeCollision() {
-  std::deque<std::pair<int, int>>& body = snake.getBody();
-  std::pair<int, int> head = snake.getHead();
-  bool collided = 0;
-  if (!field.isInside(head.first, head.second)) collided = 1;
-  for (auto i = body.begin() + 1; i != body.end(); i++)
-    if (head.first == i->first && head.second == i->second) collided = 1;
-  return collided;
-}
+bool Game::snakeCollision() { return hitsSnake(field, snake); }
 
 /**
  * Столкновения змейки с яблоком
@@ -314,23 +458,250 @@ bool Game::appleCollision() {
  * Обновление положения змейки в зависимости от текущего направления
  */
 void Game::updateSnake() {
-  switch (snake.getDirection()) {
-    case Snake::Direction::Left:
-      moveLeft();
-      break;
-    case Snake::Direction::Right:
-      moveRight();
-      break;
-    case Snake::Direction::Up:
-      moveUp();
-      break;
-    case Snake::Direction::Down:
-      moveDown();
-      break;
-  }
+  std::pair<int, int> delta = directionDelta(snake.getDirection());
+  move(delta.first, delta.second);
   addSnake();
 }
 
+/**
+ * Шаг змейки. Не зависит от времени, поэтому повторяется при проигрывании
+ * записи
+ *
+ * @param deadline время, на которое приходится шаг; повороты, нажатые позже,
+ * ждут следующего шага
+ */
+void Game::step(std::chrono::steady_clock::time_point deadline) {
+  TRACE_BEGIN("step");
+  ENGINE_STATS_BEGIN(start);
+  applyTurn(deadline);
+  ENGINE_STATS_BEGIN(resetStart);
+  resetSnake();
+  ENGINE_STATS_END(&stats, SNAKE_PHASE_RESET_SNAKE, resetStart);
+  ENGINE_STATS_BEGIN(updateStart);
+  updateSnake();
+  ENGINE_STATS_END(&stats, SNAKE_PHASE_UPDATE_SNAKE, updateStart);
+  if (appleEaten) {
+    ENGINE_STATS_BEGIN(turnStart);
+    calculateTurn();
+    ENGINE_STATS_END(&stats, SNAKE_PHASE_CALCULATE_TURN, turnStart);
+  }
+  ENGINE_STATS_BEGIN(collisionStart);
+  if (snakeCollision()) playing = GAMEOVER;
+  ENGINE_STATS_END(&stats, SNAKE_PHASE_COLLISION, collisionStart);
+  if (playing != PLAYING) compareHighScores();
+  tick++;
+  generation++;
+  SnakeState* state = static_cast<SnakeState*>(pushRewindState(&rewindRing));
+  *state = snapshot();
+  if (recorder.file)
+    writeReplayStep(&recorder, tick, state, checksumState(*state));
+  ENGINE_STATS_END(&stats, SNAKE_PHASE_STEP, start);
+  TRACE_END("step");
+}
+
+/**
+ * Постановка поворота в очередь. Поворот применяется на ближайшем шаге, так
+ * что несколько нажатий за один такт не теряются
+ *
+ * @param direction новое направление
+ *
+ * @return true - поворот добавлен
+ * @return false - очередь заполнена
+ */
+bool Game::queueTurn(Snake::Direction direction) {
+  if (!turns.push({direction, std::chrono::steady_clock::now()})) return false;
+  // Поворот будет отброшен по тем же правилам, что в applyTurn(), но
+  // относительно направления после уже ожидающих поворотов
+  bool pending = pendingTurns.load(std::memory_order_relaxed);
+  Snake::Direction current = pending ? queuedDirection : snake.getDirection();
+  Snake::Direction last = pending ? queuedDirection : snake.getLastDirection();
+  if (direction != current && !Snake::isOpposite(last, direction)) {
+    queuedDirection = direction;
+    pendingTurns.fetch_add(1, std::memory_order_relaxed);
+  }
+  return true;
+}
+
+/**
+ * Применение одного поворота из очереди перед шагом змейки. Повороты,
+ * совпадающие с текущим направлением или противоположные последнему,
+ * отбрасываются, а нажатые после наступления шага ждут следующего
+ *
+ * @param deadline время, на которое приходится шаг
+ */
+void Game::applyTurn(std::chrono::steady_clock::time_point deadline) {
+  Turn turn = {};
+  for (const Turn* next = turns.front(); next && next->time <= deadline;
+       next = turns.front()) {
+    turns.pop(turn);
+    if (turn.direction == snake.getDirection() ||
+        snake.isOpposite(turn.direction))
+      continue;
+    snake.setDirection(turn.direction);
+    if (pendingTurns.load(std::memory_order_relaxed))
+      pendingTurns.fetch_sub(1, std::memory_order_relaxed);
+    // Повороты пишутся в момент применения, чтобы запись не зависела от
+    // времени нажатия
+    if (recorder.file)
+      writeReplayInput(&recorder, tick,
+                       static_cast<UserAction_t>(Left + turn.direction), 0);
+    break;
+  }
+}
+
+/**
+ * Очистка очереди поворотов
+ */
+void Game::clearTurns() {
+  Turn turn = {};
+  while (turns.pop(turn)) {
+  }
+  pendingTurns.store(0, std::memory_order_relaxed);
+}
+
+/**
+ * Интервал между шагами змейки с учётом скорости и ускорения
+ *
+ * @return интервал в наносекундах
+ */
+std::chrono::nanoseconds Game::getTickInterval() const {
+  double speed = info.speed;
+  if (isBoosted) speed *= boostFactor;
+  return std::chrono::nanoseconds(
+      static_cast<long>(*getFrameDelayLeft() / speed));
+}
+
+/**
+ * Инициализация генератора случайных чисел зерном
+ *
+ * @param seed зерно
+ */
+void Game::seed(unsigned int seed) { random = seedRandom(seed); }
+
+/**
+ * Снимок состояния игры. Снимок не содержит указателей, поэтому копируется
+ * одним присваиванием
+ *
+ * @return снимок
+ */
+SnakeState Game::snapshot() const {
+  SnakeState state;
+  state.field = field;
+  state.snake = snake;
+  state.appleX = apple.first;
+  state.appleY = apple.second;
+  state.score = info.score;
+  state.level = info.level;
+  state.speed = info.speed;
+  state.pause = info.pause;
+  state.random = random;
+  state.tick = tick;
+  state.appleEaten = appleEaten;
+  state.playing = playing;
+  state.boost = isBoosted;
+  return state;
+}
+
+/**
+ * Контрольная сумма текущего состояния игры
+ *
+ * @return контрольная сумма
+ */
+uint64_t Game::getChecksum() const { return checksumState(snapshot()); }
+
+/**
+ * Восстановление состояния игры из снимка. Рекорд не восстанавливается,
+ * он хранится у игрока
+ *
+ * @param state снимок
+ */
+void Game::restore(const SnakeState& state) {
+  field = state.field;
+  snake = state.snake;
+  apple = {state.appleX, state.appleY};
+  info.score = state.score;
+  info.level = state.level;
+  info.speed = state.speed;
+  info.pause = state.pause;
+  random = state.random;
+  tick = state.tick;
+  appleEaten = state.appleEaten;
+  playing = state.playing;
+  isBoosted = state.boost;
+  generation++;
+  clearTurns();
+  updateInfoField();
+}
+
+/**
+ * Очистка кольца отката: в нем остается только текущее состояние
+ */
+void Game::resetRewind() {
+  clearRewindRing(&rewindRing);
+  *static_cast<SnakeState*>(pushRewindState(&rewindRing)) = snapshot();
+}
+
+/**
+ * Откат игры на несколько шагов назад. Более новые снимки удаляются, так что
+ * игра продолжается с восстановленного состояния
+ *
+ * @param steps количество шагов
+ *
+ * @return true - состояние восстановлено
+ * @return false - снимка так далеко в прошлом нет
+ */
+bool Game::rewind(unsigned int steps) {
+  const void* state = rewindState(&rewindRing, steps);
+  if (!state) return false;
+  restore(*static_cast<const SnakeState*>(state));
+  return true;
+}
+
+/**
+ * Начало записи сессии: игра инициализируется зерном, в файл пишутся
+ * заголовок и опорный кадр начального состояния
+ *
+ * @param path путь к файлу записи
+ * @param seed зерно генератора
+ *
+ * @return true - запись начата
+ * @return false - файл не удалось создать
+ */
+bool Game::startRecording(const std::string& path, unsigned int seed) {
+  stopRecording();
+  this->seed(seed);
+  resetGame();
+  ReplayHeader header = {};
+  header.game = REPLAY_SNAKE;
+  header.seed = seed;
+  header.width = FIELD_WIDTH;
+  header.height = FIELD_HEIGHT;
+  header.keyframeInterval = REPLAY_KEYFRAME_INTERVAL;
+  header.stateSize = sizeof(SnakeState);
+  header.tickInterval = FRAME_DELAY_NANO;
+  if (openReplayWriter(&recorder, path.c_str(), &header)) return false;
+  return !writeReplayKeyframe(&recorder, 0, peekRewindState(&rewindRing, 0));
+}
+
+/**
+ * Завершение записи: в конец файла пишется индекс опорных кадров
+ */
+void Game::stopRecording() {
+  if (recorder.file) closeReplayWriter(&recorder);
+}
+
+/**
+ * Запись действия пользователя. Повороты пишутся при применении в
+ * applyTurn()
+ *
+ * @param action действие пользователя
+ * @param hold зажатие клавиши
+ */
+void Game::recordInput(UserAction_t action, bool hold) {
+  if (recorder.file && (action < Left || action > Down))
+    writeReplayInput(&recorder, tick, action, hold);
+}
+
 /**
  * Инициализация рекордного счета из файла
  */
@@ -360,7 +731,8 @@ void Game::writeHighScore(const std::string& filename, int high_score) {
 }
 
 /**
- * Сравнение рекордов
+ * Сравнение рекорда с сохраненным и запись в файл. Файловый ввод-вывод
+ * обращается к куче, поэтому вызывается только в конце игры
  */
 void Game::compareHighScores() {
   if (info.high_score < info.score) info.high_score = info.score;
@@ -380,13 +752,13 @@ void Game::compareHighScores() {
  */
 void Game::calculateTurn() {
   appleEaten = 0;
-  info.score += 1;
-  compareHighScores();
-  // Когда игрок набирает 5 очков, уровень увеличивается на 1
-  info.speed = info.speed > 10 ? 10 : info.score / 5 + 1;
-  info.level = info.speed;
-  if (snake.getLength() == 200) playing = WIN;
-  addApple();
+  scoreApple(&info.score, &info.speed, &info.level);
+  if (info.high_score < info.score) info.high_score = info.score;
+  // На заполненном поле яблоку негде появиться
+  if (snake.getLength() == FIELD_WIDTH * FIELD_HEIGHT)
+    playing = WIN;
+  else
+    addApple();
 }
 
 // ----------Other----------
@@ -400,22 +772,24 @@ void Game::calculateTurn() {
 void userInput(UserAction_t action, bool hold) {
   Game& game = Game::getGame();
   GameInfo_t gameInfo = game.getGameInfo();
+  game.recordInput(action, hold);
+  if (action < Left || action > Down) game.advanceGeneration();
   if (action != Terminate && gameInfo.pause) {
     if (action == Pause) game.setPause(0);
     return;
   }
   switch (action) {
     case Left:
-      game.getSnake().setDirection(Snake::Direction::Left);
+      game.queueTurn(Snake::Direction::Left);
       break;
     case Right:
-      game.getSnake().setDirection(Snake::Direction::Right);
+      game.queueTurn(Snake::Direction::Right);
       break;
     case Up:
-      game.getSnake().setDirection(Snake::Direction::Up);
+      game.queueTurn(Snake::Direction::Up);
       break;
     case Down:
-      game.getSnake().setDirection(Snake::Direction::Down);
+      game.queueTurn(Snake::Direction::Down);
       break;
     case Action:
       game.setBoost();
@@ -442,35 +816,174 @@ long* s21::getFrameDelayLeft() {
   return (long*)&frameDelayLeft;
 }
 
+/**
+ * Время, оставшееся до следующего шага змейки
+ *
+ * @return задержка в наносекундах
+ * @return -1 - игра на паузе, шагов не будет до ввода пользователя
+ */
+long s21::getTickTimeout() {
+  Game& game = Game::getGame();
+  if (game.getGameInfo().pause) return -1;
+  auto timeLeft = game.getTickInterval() -
+                  (std::chrono::steady_clock::now() - game.getLastActionTime());
+  long timeout =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(timeLeft).count();
+  return timeout < 0 ? 0 : timeout;
+}
+
+/**
+ * Восстановление опорного кадра записи
+ *
+ * @param state снимок SnakeState
+ */
+void s21::loadReplayState(const void* state) {
+  SnakeState s;
+  std::memcpy(&s, state, sizeof(s));
+  Game::getGame().restore(s);
+}
+
+/**
+ * Начальное состояние новой игры, как у Game::seed() и Game::resetGame(),
+ * но без обращения к игре: так партии ведутся в любом потоке
+ *
+ * @param state снимок
+ * @param seed зерно генератора
+ */
+void s21::initState(SnakeState& state, unsigned int seed) {
+  state.random = seedRandom(seed);
+  restartState(state);
+}
+
+/**
+ * Начальное состояние новой игры с продолжением генератора снимка: первое
+ * яблоко ставится уже им
+ *
+ * @param state снимок
+ */
+void s21::restartState(SnakeState& state) {
+  uint32_t random = state.random;
+  state = SnakeState();
+  state.random = random;
+  std::pair<int, int> apple;
+  placeApple(state.field, &state.random, &apple);
+  state.appleX = apple.first;
+  state.appleY = apple.second;
+  state.level = 1;
+  state.speed = 1;
+  state.playing = PLAYING;
+}
+
+/**
+ * Шаг змейки на копии состояния по тем же правилам, что Game::step, но без
+ * очереди поворотов, записи, кольца отката, статистики и рекорда. Снимок
+ * копируется одним присваиванием, а шаг не обращается к куче, поэтому так
+ * можно проигрывать множество партий из одного состояния параллельно
+ *
+ * @param state снимок; направление берется из state.snake
+ */
+void s21::advanceState(SnakeState& state) {
+  if (state.playing != PLAYING) return;
+  std::pair<int, int> apple = {state.appleX, state.appleY};
+  std::pair<int, int> delta = directionDelta(state.snake.getDirection());
+  clearSnake(state.field, state.snake);
+  state.appleEaten = moveSnake(state.snake, delta.first, delta.second, apple);
+  paintSnake(state.field, state.snake);
+  if (state.appleEaten) {
+    state.appleEaten = 0;
+    scoreApple(&state.score, &state.speed, &state.level);
+    if (state.snake.getLength() == FIELD_WIDTH * FIELD_HEIGHT) {
+      state.playing = WIN;
+    } else {
+      placeApple(state.field, &state.random, &apple);
+      state.appleX = apple.first;
+      state.appleY = apple.second;
+    }
+  }
+  if (hitsSnake(state.field, state.snake)) state.playing = GAMEOVER;
+  state.tick++;
+}
+
+/**
+ * Контрольная сумма полного состояния: хеши поля и тела, которые ведутся
+ * при каждой записи блока и каждом сдвиге змейки, и числа состояния.
+ * Поле не перебирается, поэтому сумму можно считать на каждом шаге
+ *
+ * @param state снимок
+ *
+ * @return контрольная сумма
+ */
+uint64_t s21::checksumState(const SnakeState& state) {
+  const Snake& snake = state.snake;
+  uint64_t checksum = state.field.getHash() ^ snake.getHash();
+  checksum = zobristMix(checksum, snake.getLength());
+  checksum = zobristMix(checksum,
+                        snake.getDirection() << 2 | snake.getLastDirection());
+  checksum = zobristMix(checksum, static_cast<uint64_t>(state.appleX) << 32 |
+                                      static_cast<uint32_t>(state.appleY));
+  checksum = zobristMix(checksum, static_cast<uint32_t>(state.score));
+  checksum = zobristMix(checksum, static_cast<uint64_t>(state.level) << 32 |
+                                      static_cast<uint32_t>(state.speed));
+  checksum = zobristMix(checksum, state.appleEaten << 16 |
+                                      state.playing << 8 | state.boost);
+  checksum = zobristMix(checksum, state.pause);
+  checksum = zobristMix(checksum, state.tick);
+  return zobristMix(checksum, state.random);
+}
+
+/**
+ * Контрольная сумма состояния игры для проигрывателя
+ *
+ * @return контрольная сумма
+ */
+uint64_t s21::getReplayChecksum() { return Game::getGame().getChecksum(); }
+
+/**
+ * Получение статистики фаз такта
+ *
+ * @return статистика игры
+ */
+EngineStats* s21::getEngineStats() { return &Game::getGame().getStats(); }
+
+/**
+ * Шаг змейки при проигрывании записи: все повороты уже применимы
+ */
+void s21::stepReplay() {
+  Game::getGame().step(std::chrono::steady_clock::time_point::max());
+}
+
+/**
+ * Интервал между шагами змейки для проигрывателя
+ *
+ * @return интервал в наносекундах
+ */
+long s21::getReplayTickInterval() {
+  return Game::getGame().getTickInterval().count();
+}
+
 /**
  * Обновление состояния игры
  */
 GameInfo_t updateCurrentState() {
+  ENGINE_STATS_BEGIN(start);
   Game& game = Game::getGame();
   GameInfo_t gameInfo = game.getGameInfo();
 
   if (gameInfo.pause) return gameInfo;
+  TRACE_BEGIN("updateCurrentState");
 
   auto curTime = std::chrono::steady_clock::now();
   auto timeDifference = curTime - game.getLastActionTime();
 
-  double speed = game.getInfoSpeed();
-  if (game.getBoost()) speed *= game.getBoostFactor();
-
-  auto frameDelayLeft = std::chrono::nanoseconds(*getFrameDelayLeft()) / speed;
-
-  if (std::chrono::duration_cast<std::chrono::nanoseconds>(timeDifference) >=
-      frameDelayLeft) {
-    game.resetSnake();
-    game.updateSnake();
-    if (game.getAppleEaten()) game.calculateTurn();
-    if (game.snakeCollision()) game.setPlaying(GAMEOVER);
+  if (timeDifference >= game.getTickInterval()) {
+    game.step(game.getLastActionTime() + game.getTickInterval());
     game.setLastActionTime(curTime);
   }
 
-  for (int i = 0; i < FIELD_HEIGHT; i++)
-    for (int j = 0; j < FIELD_WIDTH; j++)
-      gameInfo.field[i][j] = game.getField().getBlock(j, i);
-
-  return gameInfo;
+  ENGINE_STATS_BEGIN(compositeStart);
+  game.updateInfoField();
+  ENGINE_STATS_END(&game.getStats(), SNAKE_PHASE_COMPOSITE, compositeStart);
+  ENGINE_STATS_END(&game.getStats(), SNAKE_PHASE_FRAME, start);
+  TRACE_END("updateCurrentState");
+  return game.getGameInfo();
 }
\ No newline at end of file
@@ -1,12 +1,22 @@
 #ifndef SNAKE_H
 #define SNAKE_H
 
+#include <atomic>
 #include <chrono>
-#include <deque>
+#include <cstring>
+#include <ctime>
 #include <fstream>
 #include <stdexcept>
-#include <vector>
-
+#include <type_traits>
+#include <utility>
+
+#include "../common/random.h"
+#include "../common/engine_stats.h"
+#include "../common/replay.h"
+#include "../common/rewind.h"
+#include "../common/spsc_queue.h"
+#include "../common/trace.h"
+#include "../common/zobrist.h"
 #include "../library_specification.h"
 
 #define FIELD_WIDTH 10
@@ -14,6 +24,17 @@
 
 #define FRAME_DELAY_NANO 1000000000
 
+#define TURN_QUEUE_SIZE 8
+// Во сколько раз Action ускоряет змейку
+#define BOOST_FACTOR 1.5
+
+// Голова добавляется до удаления хвоста, поэтому нужен один запасной сегмент
+#define SNAKE_CAPACITY (FIELD_WIDTH * FIELD_HEIGHT + 1)
+
+// Начала диапазонов номеров ключей Зобриста: клетки поля и сегменты тела
+#define HASH_FIELD_KEYS 0
+#define HASH_BODY_KEYS 0x10000
+
 #define START_X FIELD_WIDTH / 2
 #define START_Y FIELD_HEIGHT / 2
 
@@ -26,26 +47,55 @@ class Snake {
   Snake();
 
   /**
-   * Получение ссылки на тело змейки, представленное в виде двусторонней очереди
-   * пар координат
+   * Получение координат сегмента змейки
    *
-   * @return ссылка на тело змейки
+   * @param i номер сегмента, 0 - голова
+   *
+   * @return координаты сегмента
    */
-  std::deque<std::pair<int, int>>& getBody() { return body; }
+  std::pair<int, int> getSegment(size_t i) const {
+    const Segment& segment = body[(head + i) % SNAKE_CAPACITY];
+    return {segment.x, segment.y};
+  }
+
+  /**
+   * Установка координат сегмента змейки
+   *
+   * @param i номер сегмента, 0 - голова
+   * @param point новые координаты
+   */
+  void setSegment(size_t i, std::pair<int, int> point) {
+    size_t slot = (head + i) % SNAKE_CAPACITY;
+    hash ^= segmentKey(slot);
+    body[slot].x = point.first;
+    body[slot].y = point.second;
+    hash ^= segmentKey(slot);
+  }
 
   /**
    * Получение координат головы змейки
    *
    * @return координаты головы змейки
    */
-  std::pair<int, int> getHead() const { return body.front(); }
+  std::pair<int, int> getHead() const { return getSegment(0); }
 
   /**
    * Получение длины змейки
    *
    * @return длина змейки
    */
-  size_t getLength() const { return body.size(); }
+  size_t getLength() const { return length; }
+
+  void pushFront(std::pair<int, int> point);
+  void popBack();
+
+  /**
+   * Получение хеша Зобриста тела: сегменты с их местами в кольцевом
+   * буфере, так что учитывается и порядок сегментов
+   *
+   * @return хеш тела
+   */
+  uint64_t getHash() const { return hash; }
 
   /**
    * Получение текущего направления движения змейки
@@ -61,6 +111,7 @@ class Snake {
    */
   Direction getLastDirection() const { return lastDirection; }
 
+  static bool isOpposite(Direction first, Direction second);
   bool isOpposite(Direction newDirection) const;
   void setDirection(Direction newDirection);
 
@@ -74,7 +125,30 @@ class Snake {
   }
 
  private:
-  std::deque<std::pair<int, int>> body;
+  /**
+   * Сегмент тела; координаты могут выходить за поле на одну клетку
+   */
+  struct Segment {
+    signed char x;
+    signed char y;
+  };
+
+  /**
+   * Ключ сегмента в слоте кольцевого буфера
+   *
+   * @param slot номер слота
+   */
+  uint64_t segmentKey(size_t slot) const {
+    uint64_t x = static_cast<unsigned char>(body[slot].x);
+    uint64_t y = static_cast<unsigned char>(body[slot].y);
+    return zobristKey(HASH_BODY_KEYS + (slot << 16 | x << 8 | y));
+  }
+
+  // Тело хранится в кольцевом буфере внутри объекта, без обращений к куче
+  Segment body[SNAKE_CAPACITY];
+  size_t head;
+  size_t length;
+  uint64_t hash;
   Direction direction;
   Direction lastDirection;
 };
@@ -82,7 +156,6 @@ class Snake {
 class Field {
  public:
   Field();
-  ~Field();
 
   /**
    * Получение ширины игрового поля
@@ -99,14 +172,65 @@ class Field {
   void setBlock(int x, int y, char value);
   void resetField();
 
+  /**
+   * Получение хеша Зобриста поля, обновляемого при каждой записи блока
+   */
+  uint64_t getHash() const { return hash; }
+
  private:
   static const int width = FIELD_WIDTH;
   static const int height = FIELD_HEIGHT;
-  char* blocks;
+  char blocks[width * height];
+  uint64_t hash;
 };
 
 enum GAME_STATE { GAMEOVER, PLAYING, WIN };
 
+/**
+ * Фазы такта, для которых собирается статистика
+ */
+enum SNAKE_PHASE {
+  SNAKE_PHASE_FRAME,
+  SNAKE_PHASE_STEP,
+  SNAKE_PHASE_RESET_SNAKE,
+  SNAKE_PHASE_UPDATE_SNAKE,
+  SNAKE_PHASE_CALCULATE_TURN,
+  SNAKE_PHASE_COLLISION,
+  SNAKE_PHASE_COMPOSITE,
+  SNAKE_PHASES
+};
+
+/**
+ * Снимок состояния игры фиксированного размера без указателей: копируется
+ * одним присваиванием, годится для кольца отката и опорных кадров записи
+ */
+struct SnakeState {
+  Field field;
+  Snake snake;
+  int appleX;
+  int appleY;
+  int score;
+  int level;
+  int speed;
+  int pause;
+  uint32_t random;
+  uint32_t tick;
+  char appleEaten;
+  char playing;
+  char boost;
+};
+
+static_assert(std::is_trivially_copyable<SnakeState>::value,
+              "SnakeState must be copied with memcpy");
+
+/**
+ * Поворот, запрошенный игроком: направление и время нажатия
+ */
+struct Turn {
+  Snake::Direction direction;
+  std::chrono::steady_clock::time_point time;
+};
+
 class Game {
  public:
   Game(const Game&) = delete;
@@ -191,6 +315,44 @@ class Game {
     return lastActionTime;
   }
 
+  /**
+   * Получение количества сделанных змейкой шагов
+   *
+   * @return номер последнего шага
+   */
+  unsigned long getTick() const { return tick; }
+
+  /**
+   * Получение версии состояния игры. Версия растет при каждом шаге и при
+   * каждом действии пользователя, кроме поворотов: они применяются на шаге
+   *
+   * @return версия состояния
+   */
+  unsigned long getGeneration() const { return generation; }
+
+  /**
+   * Версия состояния, в которой станет виден последний ввод: каждый
+   * поворот из очереди, который не будет отброшен, применяется на
+   * отдельном шаге
+   *
+   * @return версия состояния
+   */
+  unsigned long getInputGeneration() const {
+    return generation + pendingTurns;
+  }
+
+  /**
+   * Увеличение версии состояния после действия пользователя
+   */
+  void advanceGeneration() { generation++; }
+
+  /**
+   * Получение статистики фаз такта
+   *
+   * @return ссылка на статистику
+   */
+  EngineStats& getStats() { return stats; }
+
   /**
    * Установка состояния игры
    *
@@ -221,6 +383,7 @@ class Game {
 
   void resetSnake();
   void resetInfoField();
+  void updateInfoField();
   void resetInfo();
   void resetGame();
 
@@ -235,6 +398,22 @@ class Game {
   bool snakeCollision();
   bool appleCollision();
   void updateSnake();
+  void step(std::chrono::steady_clock::time_point deadline);
+  bool queueTurn(Snake::Direction direction);
+  void applyTurn(std::chrono::steady_clock::time_point deadline);
+  void clearTurns();
+
+  std::chrono::nanoseconds getTickInterval() const;
+
+  void seed(unsigned int seed);
+  SnakeState snapshot() const;
+  uint64_t getChecksum() const;
+  void restore(const SnakeState& state);
+  void resetRewind();
+  bool rewind(unsigned int steps);
+  bool startRecording(const std::string& path, unsigned int seed);
+  void stopRecording();
+  void recordInput(UserAction_t action, bool hold);
 
   void initHighScore();
   void writeHighScore(const std::string& filename, int high_score);
@@ -251,12 +430,37 @@ class Game {
   double boostFactor;
   GameInfo_t info;
   std::chrono::time_point<std::chrono::steady_clock> lastActionTime;
+  unsigned long tick;
+  unsigned long generation;
+  uint32_t random;
+  ReplayWriter recorder;
+  SnakeState rewindStates[REWIND_CAPACITY];
+  RewindRing rewindRing;
+  EngineStats stats;
+  // Повороты пишет поток ввода, читает поток игрового цикла
+  SpscQueue<Turn, TURN_QUEUE_SIZE> turns;
+  // Повороты в очереди, которые applyTurn() применит, и направление после
+  // последнего из них. Считаются при постановке в очередь по направлению
+  // змейки, поэтому точны, когда ввод и шаги идут в одном потоке, как в
+  // обоих интерфейсах
+  std::atomic<unsigned> pendingTurns;
+  Snake::Direction queuedDirection;
 
   Game();
   ~Game();
 };
 
 long* getFrameDelayLeft();
+long getTickTimeout();
+void loadReplayState(const void* state);
+void initState(SnakeState& state, unsigned int seed);
+void restartState(SnakeState& state);
+void advanceState(SnakeState& state);
+uint64_t checksumState(const SnakeState& state);
+uint64_t getReplayChecksum();
+void stepReplay();
+long getReplayTickInterval();
+EngineStats* getEngineStats();
 
 }  // namespace s21
 #endif  // SNAKE_H
\ No newline at end of file
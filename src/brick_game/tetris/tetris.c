@@ -32,233 +32,304 @@ char* getFigureFromTemplate(int i) {
 }
 
 /**
- * Создание игрового поля
+ * Собственный контекст потока: игра игрока или партия инструмента
  *
- * @return новая структура Field
+ * Состояние игры, как и остальные синглтоны движка, свое у каждого потока:
+ * интерфейс работает с игрой из одного потока, а инструменты вроде
+ * подбора весов бота ведут независимые партии на всех ядрах
  */
-Field* createField() {
-  Field* field = (Field*)malloc(sizeof(Field));
-  field->width = FIELD_WIDTH;
-  field->height = FIELD_HEIGHT;
-  field->blocks = (char*)calloc(FIELD_WIDTH * FIELD_HEIGHT, sizeof(char));
-  return field;
+static TetrisContext* getOwnContext() {
+  static _Thread_local TetrisContext context;
+  return &context;
+}
+
+/**
+ * Ячейка с текущим контекстом потока, NULL - собственный контекст
+ */
+static TetrisContext** getContextSlot() {
+  static _Thread_local TetrisContext* context = NULL;
+  return &context;
 }
 
 /**
- * Создание фигуры
+ * Получение текущего контекста потока, с которым работают функции движка
+ */
+TetrisContext* getTetrisContext() {
+  TetrisContext* context = *getContextSlot();
+  return context ? context : getOwnContext();
+}
+
+/**
+ * Переключение потока на другой контекст. Контекст подменяется указателем,
+ * поэтому переключение ничего не копирует; игра в контексте должна быть
+ * создана initGame() при этом контексте
  *
- * @return новая структура Figure
+ * @param context новый контекст, NULL - собственный контекст потока
+ *
+ * @return прежний контекст
  */
-Figure* createFigure() {
-  Figure* figure = (Figure*)calloc(1, sizeof(Figure));
-  figure->size = FIGURE_SIZE;
-  figure->blocks = (char*)calloc(1, FIGURE_SIZE * FIGURE_SIZE * sizeof(char));
-  return figure;
+TetrisContext* switchTetrisContext(TetrisContext* context) {
+  TetrisContext* previous = getTetrisContext();
+  *getContextSlot() = context;
+  return previous;
 }
 
 /**
- * Создание следующей фигуры
+ * Проверка, что поток работает с собственным контекстом. Файл рекорда и
+ * игровая информация для интерфейса ведутся только для него
  */
-Figure* createNextFigure() {
-  Figure* figure = createFigure();
-  figure->x = FIELD_WIDTH / 2 - figure->size / 2;
-  figure->y = 0;
-  int figureNumber = rand() % FIGURES_COUNT;
-  for (int i = 0; i < FIGURE_SIZE; i++)
-    for (int j = 0; j < FIGURE_SIZE; j++)
-      figure->blocks[i * FIGURE_SIZE + j] =
-          getFigureFromTemplate(figureNumber)[i * FIGURE_SIZE + j];
-  return figure;
+static bool isOwnContext() { return getTetrisContext() == getOwnContext(); }
+
+/**
+ * Получение состояния генератора случайных чисел текущего контекста. При
+ * первом обращении генератор инициализируется текущим временем
+ */
+uint32_t* getRandomState() {
+  uint32_t* state = &getTetrisContext()->random;
+  if (*state == 0) *state = seedRandom(time(NULL));
+  return state;
 }
 
 /**
- * Очищение фигуры
+ * Инициализация генератора зерном и выбор новых текущей и следующей фигур
  *
- * @return освобожденная структура Figure
+ * @param seed зерно
  */
-Figure* freeFigure(Figure* figure) {
-  if (figure) {
-    free(figure->blocks);
-    figure->blocks = 0;
-    free(figure);
-    figure = 0;
-  }
-  return figure;
+void seedGame(unsigned int seed) {
+  *getRandomState() = seedRandom(seed);
+  nextFigure(1);
+  resetSingletones();
 }
 
 /**
- * Получение следующей фигуры
+ * Инициализация игрового поля
  *
- * @param create создание фигуры
+ * @param field структура поля
  */
-Figure* nextFigure(bool create) {
-  static Figure* figure = 0;
-  if (create) {
-    freeFigure(figure);
-    figure = createNextFigure();
-  }
+void initField(Field* field) {
+  field->width = FIELD_WIDTH;
+  field->height = FIELD_HEIGHT;
+  memset(field->blocks, 0, sizeof(field->blocks));
+}
+
+/**
+ * Создание случайной фигуры в точке появления
+ *
+ * @return новая структура Figure
+ */
+Figure createNextFigure() {
+  Figure figure;
+  figure.size = FIGURE_SIZE;
+  figure.x = FIELD_WIDTH / 2 - figure.size / 2;
+  figure.y = 0;
+  int figureNumber = nextRandom(getRandomState()) % FIGURES_COUNT;
+  memcpy(figure.blocks, getFigureFromTemplate(figureNumber), FIGURE_AREA);
   return figure;
 }
 
 /**
- * Добавление фигуры
+ * Получение следующей фигуры
  *
- * @param figure структура фигуры
+ * @param create создание фигуры
  */
-Figure* dropFigure(Figure* figure) {
-  Figure* newFigure = createFigure();
-  newFigure->x = figure->x;
-  newFigure->y = figure->y;
-  for (int i = 0; i < FIGURE_SIZE * FIGURE_SIZE; i++)
-    newFigure->blocks[i] = figure->blocks[i];
-  return newFigure;
+Figure* nextFigure(bool create) {
+  Figure* figure = &getGame()->next;
+  if (create) *figure = createNextFigure();
+  return figure;
 }
 
 /**
- * Создание игры
+ * Инициализация игры. Фигуры и поле хранятся внутри Game, поэтому снимок
+ * состояния - это копия структуры
  *
- * @return новая структура Game
+ * @param game структура игры
  */
-Game* createGame() {
-  Game* game = (Game*)calloc(1, sizeof(Game));
-  game->field = createField();
+void initGame(Game* game) {
+  memset(game, 0, sizeof(*game));
+  initField(&game->field);
   game->playing = PLAYING;
   game->speed = 1;
-  game->figure = dropFigure(nextFigure(1));
-  return game;
-};
+  game->figure = createNextFigure();
+  game->next = createNextFigure();
+  rehashGame(game);
+}
 
 /**
- * Получение игры
+ * Получение игры текущего контекста. Собственная игра потока создается при
+ * первом обращении
  */
 Game* getGame() {
-  static Game* game = 0;
-  if (game == 0) {
-    game = createGame();
-    FILE* file = fopen("tetris_high_score.bin", "rb");
+  Game* game = &getTetrisContext()->game;
+  static _Thread_local bool created = 0;
+  if (!created && isOwnContext()) {
+    created = 1;
+    initGame(game);
+    FILE* file =
+        *getSaveHighScore() ? fopen("tetris_high_score.bin", "rb") : NULL;
     if (file) {
       size_t readed = fread(&game->high_score, sizeof(int), 1, file);
       if (readed == 0) game->high_score = 0;
       fclose(file);
-    } else {
+    } else if (*getSaveHighScore()) {
       file = fopen("tetris_high_score.bin", "wb");
       fwrite(&game->high_score, sizeof(int), 1, file);
       fclose(file);
     }
+    snapshotGame(pushRewindState(getRewindRing()));
   }
   return game;
 }
 
 /**
- * Получение игровой информации
+ * Игровая информация вместе с массивами поля и следующей фигуры, на которые
+ * она указывает
+ */
+typedef struct GameInfoStorage {
+  GameInfo_t info;
+  int* fieldRows[FIELD_HEIGHT];
+  int field[FIELD_HEIGHT * FIELD_WIDTH];
+  int* nextRows[FIGURE_SIZE];
+  int next[FIGURE_SIZE * FIGURE_SIZE];
+} GameInfoStorage;
+
+/**
+ * Хранилище игровой информации потока. Лежит в памяти потока, поэтому
+ * освобождается вместе с ним: потоки пула и воркеры TetrisVec, которые
+ * обращаются к ней через userInput(), ничего не теряют
+ */
+static GameInfoStorage* getGameInfoStorage() {
+  static _Thread_local GameInfoStorage storage;
+  return &storage;
+}
+
+/**
+ * Получение игровой информации. Создается при первом обращении и после
+ * freeSingletones()
  */
 GameInfo_t* getGameInfo() {
-  static GameInfo_t* gameInfo = 0;
-  if (gameInfo == 0) {
-    gameInfo = calloc(1, sizeof(GameInfo_t));
-    int* field = calloc(1, sizeof(int) * FIELD_WIDTH * FIELD_HEIGHT);
-    gameInfo->field = calloc(FIELD_HEIGHT, sizeof(int*));
+  GameInfoStorage* storage = getGameInfoStorage();
+  GameInfo_t* gameInfo = &storage->info;
+  if (gameInfo->field == NULL) {
+    memset(storage, 0, sizeof(*storage));
     for (int row = 0; row < FIELD_HEIGHT; row++)
-      gameInfo->field[row] = field + FIELD_WIDTH * row;
-    gameInfo->next = calloc(1, sizeof(int*) * FIGURE_SIZE);
-    Figure* figure = nextFigure(1);
-    for (int i = 0; i < FIGURE_SIZE; i++) {
-      gameInfo->next[i] = calloc(1, sizeof(int) * FIGURE_SIZE);
-      for (int j = 0; j < FIGURE_SIZE; j++)
-        gameInfo->next[i][j] = figure->blocks[i * FIGURE_SIZE + j];
-    }
+      storage->fieldRows[row] = storage->field + FIELD_WIDTH * row;
+    for (int i = 0; i < FIGURE_SIZE; i++)
+      storage->nextRows[i] = storage->next + FIGURE_SIZE * i;
+    gameInfo->field = storage->fieldRows;
+    gameInfo->next = storage->nextRows;
     gameInfo->level = 1;
     gameInfo->speed = 1;
+    copyNextFigureInfo();
   }
   return gameInfo;
 }
 
 /**
- * Обновление игровой информации о следующей фигуре
+ * Копирование следующей фигуры в игровую информацию
  */
-void updateNextFigureInfo() {
+void copyNextFigureInfo() {
   GameInfo_t* info = getGameInfo();
-  Figure* figure = nextFigure(1);
+  Figure* figure = nextFigure(0);
   for (int i = 0; i < FIGURE_SIZE; i++)
     for (int j = 0; j < FIGURE_SIZE; j++)
       info->next[i][j] = figure->blocks[i * FIGURE_SIZE + j];
 }
 
+/**
+ * Выбор новой следующей фигуры и обновление игровой информации о ней
+ */
+void updateNextFigureInfo() {
+  nextFigure(1);
+  copyNextFigureInfo();
+}
+
 /**
  * Обнуление Singletones для Game и GameInfo_t
  */
 void resetSingletones() {
   Game* game = getGame();
   GameInfo_t* info = getGameInfo();
-  for (int i = 0; i < FIELD_HEIGHT; i++)
-    for (int j = 0; j < FIELD_WIDTH; j++) {
-      game->field->blocks[i * FIELD_WIDTH + j] = 0;
-      (*info->field)[i * FIELD_WIDTH + j] = 0;
-    }
-  freeFigure(game->figure);
-  game->figure = dropFigure(nextFigure(0));
+  initField(&game->field);
+  for (int i = 0; i < FIELD_HEIGHT * FIELD_WIDTH; i++) (*info->field)[i] = 0;
+  game->figure = *nextFigure(0);
+  rehashGame(game);
   updateNextFigureInfo();
   game->score = 0;
   game->playing = PLAYING;
   game->speed = 1;
+  game->tick = 0;
   info->level = 1;
   info->speed = 1;
   info->score = 0;
+  *getFrameDelayLeft() = FRAME_DELAY_NANO;
+  *getLastUpdateTime() = (struct timespec){0, 0};
+  clearRewindRing(getRewindRing());
+  snapshotGame(pushRewindState(getRewindRing()));
 }
 
 /**
- * Очищение Singletones для Game и GameInfo_t
+ * Сброс игровой информации потока: следующее обращение создаст ее заново.
+ * Game и GameInfo_t хранятся в памяти потока и освобождения не требуют
  */
-void freeSingletones() {
-  // Очищение Game
-  free(getGame()->figure->blocks);
-  free(getGame()->figure);
-  free(getGame()->field->blocks);
-  free(getGame()->field);
-  free(getGame());
-  // Очищение GameInfo
-  free(*getGameInfo()->field);
-  free(getGameInfo()->field);
-  for (int i = 0; i < FIGURE_SIZE; i++) {
-    free(getGameInfo()->next[i]);
-  }
-  free(getGameInfo()->next);
-  free(getGameInfo());
-  // Очищение NextFigure
-  freeFigure(nextFigure(0));
+void freeSingletones() { getGameInfoStorage()->info.field = NULL; }
+
+/**
+ * Ключ положения фигуры
+ *
+ * @param x столбец левого края фигуры
+ * @param y строка верхнего края фигуры
+ */
+static uint64_t hashPosition(int x, int y) {
+  int width = FIELD_WIDTH + 2 * FIGURE_SIZE;
+  return zobristKey(HASH_POSITION_KEYS + (y + FIGURE_SIZE) * width + x +
+                    FIGURE_SIZE);
 }
 
 /**
- * Падение фигуры
+ * Сдвиг фигуры с обновлением хеша: меняется только ключ положения
+ *
+ * @param dx сдвиг по горизонтали
+ * @param dy сдвиг по вертикали
  */
-void moveFigureDown() {
+static void shiftFigure(int dx, int dy) {
   Game* game = getGame();
-  game->figure->y++;
+  Figure* figure = &game->figure;
+  game->figureHash ^= hashPosition(figure->x, figure->y);
+  figure->x += dx;
+  figure->y += dy;
+  game->figureHash ^= hashPosition(figure->x, figure->y);
 }
 
 /**
- * Движение фигуры вверх
+ * Замена текущей фигуры с пересчетом ее хеша
+ *
+ * @param figure новая фигура
  */
-void moveFigureUp() {
+static void setFigure(const Figure* figure) {
   Game* game = getGame();
-  game->figure->y--;
+  game->figure = *figure;
+  game->figureHash = hashFigure(figure);
 }
 
+/**
+ * Падение фигуры
+ */
+void moveFigureDown() { shiftFigure(0, 1); }
+
+/**
+ * Движение фигуры вверх
+ */
+void moveFigureUp() { shiftFigure(0, -1); }
+
 /**
  * Движение фигуры вправо
  */
-void moveFigureRight() {
-  Game* game = getGame();
-  game->figure->x++;
-}
+void moveFigureRight() { shiftFigure(1, 0); }
 
 /**
  * Движение фигуры влево
  */
-void moveFigureLeft() {
-  Game* game = getGame();
-  game->figure->x--;
-}
+void moveFigureLeft() { shiftFigure(-1, 0); }
 
 /**
  * Столкновения фигуры с границами поля и непустыми блоками
@@ -268,8 +339,8 @@ void moveFigureLeft() {
  */
 char figureCollision() {
   Game* game = getGame();
-  Figure* figure = game->figure;
-  Field* field = game->field;
+  Figure* figure = &game->figure;
+  Field* field = &game->field;
   bool collided = 0;
   for (int i = 0; i < figure->size && !collided; i++)
     for (int j = 0; j < figure->size && !collided; j++)
@@ -289,14 +360,15 @@ char figureCollision() {
  */
 void plantFigure() {
   Game* game = getGame();
-  Figure* figure = game->figure;
+  Figure* figure = &game->figure;
   for (int i = 0; i < figure->size; i++)
     for (int j = 0; j < figure->size; j++)
       if (figure->blocks[i * figure->size + j]) {
-        int fx = figure->x + j;
-        int fy = figure->y + i;
-        game->field->blocks[fy * game->field->width + fx] =
-            figure->blocks[i * figure->size + j];
+        int cell = (figure->y + i) * game->field.width + figure->x + j;
+        char block = figure->blocks[i * figure->size + j];
+        game->fieldHash ^=
+            hashBlock(cell, game->field.blocks[cell]) ^ hashBlock(cell, block);
+        game->field.blocks[cell] = block;
       }
 }
 
@@ -329,7 +401,21 @@ void shiftLine(int i, Field* field) {
 }
 
 /**
- * Удаление заполненных строк и начисление очков
+ * Хеш верхних строк поля
+ *
+ * @param field структура поля
+ * @param last номер последней строки
+ */
+static uint64_t hashRows(const Field* field, int last) {
+  uint64_t hash = 0;
+  for (int cell = 0; cell < (last + 1) * field->width; cell++)
+    hash ^= hashBlock(cell, field->blocks[cell]);
+  return hash;
+}
+
+/**
+ * Удаление заполненных строк и начисление очков. Сдвиг меняет строки
+ * выше стертой, их ключи заменяются в хеше поля
  *
  * @return 100 очков за 1 линию
  * @return 300 очков за 2 линии
@@ -338,11 +424,13 @@ void shiftLine(int i, Field* field) {
  */
 int eraseLines() {
   Game* game = getGame();
-  Field* field = game->field;
+  Field* field = &game->field;
   int count = 0;
   for (int i = field->height - 1; i >= 0; i--)
     while (lineIsFull(i, field)) {
+      game->fieldHash ^= hashRows(field, i);
       shiftLine(i, field);
+      game->fieldHash ^= hashRows(field, i);
       count++;
     }
   switch (count) {
@@ -367,28 +455,103 @@ int eraseLines() {
 /**
  * Вращение фигуры
  */
-Figure* rotateFigure() {
-  Game* game = getGame();
-  Figure* figure = createFigure();
-  Figure* oldFigure = game->figure;
-  figure->x = oldFigure->x;
-  figure->y = oldFigure->y;
-  for (int i = 0; i < figure->size; i++)
-    for (int j = 0; j < figure->size; j++)
-      figure->blocks[(FIGURE_SIZE - j - 1) * FIGURE_SIZE + i] =
+Figure rotateFigure() {
+  Figure* oldFigure = &getGame()->figure;
+  Figure figure = *oldFigure;
+  for (int i = 0; i < figure.size; i++)
+    for (int j = 0; j < figure.size; j++)
+      figure.blocks[(FIGURE_SIZE - j - 1) * FIGURE_SIZE + i] =
           oldFigure->blocks[i * FIGURE_SIZE + j];
   return figure;
 }
 
 /**
- * Сравнение рекордов
+ * Ключ клетки поля с блоком
+ *
+ * @param cell номер клетки
+ * @param block значение блока
+ *
+ * @return ключ, у пустой клетки - 0
+ */
+uint64_t hashBlock(int cell, char block) {
+  return block ? zobristKey(HASH_FIELD_KEYS + cell * 8 + block) : 0;
+}
+
+/**
+ * Хеш Зобриста поля: сумма по модулю 2 ключей непустых клеток
+ *
+ * @param field структура поля
+ */
+uint64_t hashField(const Field* field) {
+  return hashRows(field, field->height - 1);
+}
+
+/**
+ * Хеш Зобриста фигуры: ключи клеток формы и ключ положения. При сдвиге
+ * меняется только ключ положения
+ *
+ * @param figure фигура
+ */
+uint64_t hashFigure(const Figure* figure) {
+  uint64_t hash = hashPosition(figure->x, figure->y);
+  for (int i = 0; i < FIGURE_AREA; i++)
+    if (figure->blocks[i])
+      hash ^= zobristKey(HASH_SHAPE_KEYS + i * 8 + figure->blocks[i]);
+  return hash;
+}
+
+/**
+ * Пересчет хешей игры с нуля, например после прямой записи в поле
+ *
+ * @param game структура игры
+ */
+void rehashGame(Game* game) {
+  game->fieldHash = hashField(&game->field);
+  game->figureHash = hashFigure(&game->figure);
+}
+
+/**
+ * Хеш позиции: поле и текущая фигура. Совпадающие хеши означают, с
+ * вероятностью ошибки порядка 2^-64, одинаковые позиции, поэтому хеш
+ * служит ключом таблицы транспозиций и быстрой проверкой равенства
+ * состояний
+ */
+uint64_t getGameHash() {
+  Game* game = getGame();
+  return game->fieldHash ^ game->figureHash;
+}
+
+/**
+ * Контрольная сумма полного состояния игры: хеши поля и фигуры, которые
+ * ведутся по ходу игры, следующая фигура, очки, скорость, номер шага и
+ * состояние генератора. Рекорд не входит, он хранится у игрока. Поле не
+ * перебирается, поэтому сумму можно считать на каждом шаге
+ */
+uint64_t getGameChecksum() {
+  Game* game = getGame();
+  uint64_t checksum = game->fieldHash ^ game->figureHash;
+  checksum = zobristMix(checksum, hashFigure(&game->next));
+  checksum = zobristMix(checksum, (uint32_t)game->score);
+  checksum = zobristMix(checksum, (uint64_t)game->speed << 8 | game->playing);
+  checksum = zobristMix(checksum, game->tick);
+  checksum = zobristMix(checksum, getGameInfo()->pause);
+  return zobristMix(checksum, *getRandomState());
+}
+
+/**
+ * Сравнение рекорда с сохраненным и запись в файл. Файловый ввод-вывод
+ * обращается к куче, поэтому вызывается только в конце игры; его время
+ * входит в фазу highScore
  */
 void compareHighScores() {
+  ENGINE_STATS_BEGIN(start);
   Game* game = getGame();
   if (game->high_score < game->score) game->high_score = game->score;
-  int prevHighScore = 0;
-  FILE* file = fopen("tetris_high_score.bin", "rb");
+  FILE* file = *getSaveHighScore() && isOwnContext()
+                   ? fopen("tetris_high_score.bin", "rb")
+                   : NULL;
   if (file) {
+    int prevHighScore = 0;
     size_t readed = fread(&prevHighScore, sizeof(int), 1, file);
     fclose(file);
     if (readed == 1 && prevHighScore < game->high_score) {
@@ -397,26 +560,187 @@ void compareHighScores() {
       fclose(file);
     }
   }
+  ENGINE_STATS_END(getEngineStats(), TETRIS_PHASE_HIGH_SCORE, start);
 }
 
 /**
  * Просчёт такта игрового цикла
  */
 void calculateTurn() {
+  ENGINE_STATS_BEGIN(start);
   Game* game = getGame();
   plantFigure();
+  ENGINE_STATS_BEGIN(eraseStart);
   game->score += eraseLines();
-  compareHighScores();
+  ENGINE_STATS_END(getEngineStats(), TETRIS_PHASE_ERASE_LINES, eraseStart);
+  if (game->high_score < game->score) game->high_score = game->score;
   // Когда игрок набирает 600 очков, уровень увеличивается на 1
   game->speed = game->speed > 10 ? 10 : game->score / 600 + 1;
-  getGameInfo()->level = game->speed;
-  getGameInfo()->speed = game->speed;
+  setFigure(nextFigure(0));
+  // Игровая информация для интерфейса ведется только для игры игрока
+  if (isOwnContext()) {
+    getGameInfo()->level = game->speed;
+    getGameInfo()->speed = game->speed;
+    updateNextFigureInfo();
+  } else {
+    nextFigure(1);
+  }
 
-  freeFigure(game->figure);
-  game->figure = dropFigure(nextFigure(0));
-  updateNextFigureInfo();
+  if (figureCollision()) {
+    game->playing = GAMEOVER;
+    compareHighScores();
+  }
+  ENGINE_STATS_END(getEngineStats(), TETRIS_PHASE_CALCULATE_TURN, start);
+}
+
+/**
+ * Шаг падения фигуры. Не зависит от времени, поэтому повторяется при
+ * проигрывании записи
+ */
+void stepGame() {
+  TRACE_BEGIN("step");
+  ENGINE_STATS_BEGIN(start);
+  Game* game = getGame();
+  ENGINE_STATS_BEGIN(gravityStart);
+  moveFigureDown();
+  bool landed = figureCollision();
+  ENGINE_STATS_END(getEngineStats(), TETRIS_PHASE_GRAVITY, gravityStart);
+  if (landed) {
+    moveFigureUp();
+    calculateTurn();
+  }
+  game->tick++;
+  ++*getGeneration();
+  TetrisState* state = pushRewindState(getRewindRing());
+  snapshotGame(state);
+  if (getRecorder()->file)
+    writeReplayStep(getRecorder(), game->tick, state, getGameChecksum());
+  ENGINE_STATS_END(getEngineStats(), TETRIS_PHASE_STEP, start);
+  TRACE_END("step");
+}
+
+/**
+ * Шаг падения фигуры без снимка в кольце отката, записи и статистики шага,
+ * для партий, которые ведутся вне интерфейса
+ */
+void advanceGame() {
+  Game* game = getGame();
+  moveFigureDown();
+  if (figureCollision()) {
+    moveFigureUp();
+    calculateTurn();
+  }
+  game->tick++;
+}
+
+/**
+ * Снимок состояния игры: копия Game, паузы и генератора случайных чисел
+ *
+ * @param state снимок
+ */
+void snapshotGame(TetrisState* state) {
+  state->game = *getGame();
+  state->pause = getGameInfo()->pause;
+  state->random = *getRandomState();
+}
+
+/**
+ * Восстановление состояния игры из снимка. Рекорд не восстанавливается,
+ * он хранится у игрока
+ *
+ * @param state снимок
+ */
+void restoreGame(const TetrisState* state) {
+  Game* game = getGame();
+  GameInfo_t* info = getGameInfo();
+  int highScore = game->high_score;
+  *game = state->game;
+  game->high_score = highScore;
+  *getRandomState() = state->random;
+  info->score = game->score;
+  info->level = game->speed;
+  info->speed = game->speed;
+  info->pause = state->pause;
+  copyNextFigureInfo();
+  ++*getGeneration();
+}
+
+/**
+ * Восстановление опорного кадра записи. Кадр в отображенном файле может
+ * быть не выровнен, поэтому сначала копируется
+ *
+ * @param state снимок TetrisState
+ */
+void loadReplayState(const void* state) {
+  TetrisState s;
+  memcpy(&s, state, sizeof(s));
+  restoreGame(&s);
+}
+
+/**
+ * Получение кольца снимков последних шагов
+ */
+RewindRing* getRewindRing() {
+  static _Thread_local TetrisState states[REWIND_CAPACITY];
+  static _Thread_local RewindRing ring = {0};
+  if (ring.states == NULL)
+    initRewindRing(&ring, states, sizeof(TetrisState), REWIND_CAPACITY);
+  return &ring;
+}
+
+/**
+ * Откат игры на несколько шагов назад
+ *
+ * @param steps количество шагов
+ *
+ * @return 0 - OK
+ * @return -1 - в кольце нет такого старого снимка
+ */
+int rewindGame(unsigned int steps) {
+  const TetrisState* state = rewindState(getRewindRing(), steps);
+  if (!state) return -1;
+  restoreGame(state);
+  return 0;
+}
 
-  if (figureCollision()) game->playing = GAMEOVER;
+/**
+ * Получение записи текущей сессии. Запись неактивна, пока file == NULL
+ */
+ReplayWriter* getRecorder() {
+  static _Thread_local ReplayWriter recorder = {0};
+  return &recorder;
+}
+
+/**
+ * Начало записи сессии: игра инициализируется зерном, в файл пишутся
+ * заголовок и опорный кадр начального состояния
+ *
+ * @param path путь к файлу записи
+ * @param seed зерно генератора
+ *
+ * @return 0 - OK
+ * @return -1 - файл не удалось создать
+ */
+int startRecording(const char* path, unsigned int seed) {
+  seedGame(seed);
+  ReplayHeader header = {0};
+  header.game = REPLAY_TETRIS;
+  header.seed = seed;
+  header.width = FIELD_WIDTH;
+  header.height = FIELD_HEIGHT;
+  header.keyframeInterval = REPLAY_KEYFRAME_INTERVAL;
+  header.stateSize = sizeof(TetrisState);
+  header.tickInterval = FRAME_DELAY_NANO;
+  if (openReplayWriter(getRecorder(), path, &header)) return -1;
+  return writeReplayKeyframe(getRecorder(), 0,
+                             peekRewindState(getRewindRing(), 0));
+}
+
+/**
+ * Завершение записи: в конец файла пишется индекс опорных кадров
+ */
+void stopRecording() {
+  if (getRecorder()->file) closeReplayWriter(getRecorder());
 }
 
 /**
@@ -426,20 +750,45 @@ void calculateTurn() {
  * @param hold зажатие клавиши
  */
 void userInput(UserAction_t action, bool hold) {
+  if (getRecorder()->file)
+    writeReplayInput(getRecorder(), getGame()->tick, action, hold);
   if (action != Terminate && getGameInfo()->pause) {
-    if (action == Pause) getGameInfo()->pause = 0;
+    if (action == Pause) {
+      getGameInfo()->pause = 0;
+      ++*getGeneration();
+    }
     return;
   }
+  if (applyInput(action)) ++*getGeneration();
+  hold = !hold;
+}
+
+/**
+ * Применение действия к игре текущего контекста без записи и проверки
+ * паузы
+ *
+ * @param action действие пользователя
+ *
+ * @return true - состояние игры изменилось
+ */
+bool applyInput(UserAction_t action) {
   Game* game = getGame();
-  Figure* rotated = NULL;
+  Figure old, rotated;
+  bool changed = true;
   switch (action) {
     case Right:
       moveFigureRight();
-      if (figureCollision()) moveFigureLeft();
+      if (figureCollision()) {
+        moveFigureLeft();
+        changed = false;
+      }
       break;
     case Left:
       moveFigureLeft();
-      if (figureCollision()) moveFigureRight();
+      if (figureCollision()) {
+        moveFigureRight();
+        changed = false;
+      }
       break;
     case Down:
       while (!figureCollision()) moveFigureDown();
@@ -447,17 +796,14 @@ void userInput(UserAction_t action, bool hold) {
       calculateTurn();
       break;
     case Action:
+      old = game->figure;
       rotated = rotateFigure();
-      Figure* old = game->figure;
-      game->figure = rotated;
-      if (figureCollision()) {
-        freeFigure(rotated);
-        game->figure = old;
-      } else {
-        freeFigure(old);
-      }
+      setFigure(&rotated);
+      if (figureCollision()) setFigure(&old);
+      changed = memcmp(&old, &game->figure, sizeof(old)) != 0;
       break;
     case Pause:
+      changed = !getGameInfo()->pause;
       getGameInfo()->pause = 1;
       break;
     case Terminate:
@@ -466,19 +812,85 @@ void userInput(UserAction_t action, bool hold) {
       compareHighScores();
       break;
     default:
+      changed = false;
       break;
   }
-  hold = !hold;
+  return changed;
+}
+
+/**
+ * Получение статистики фаз такта
+ */
+EngineStats* getEngineStats() {
+  static const char* const names[TETRIS_PHASES] = {
+      "frame",      "step",      "gravity",  "calculateTurn",
+      "eraseLines", "highScore", "composite"};
+  static _Thread_local EngineStats stats = {0};
+  if (stats.phaseCount == 0) initEngineStats(&stats, names, TETRIS_PHASES);
+  return &stats;
 }
 
 /**
  * Получение задержки кадра
  */
 long* getFrameDelayLeft() {
-  static long frameDelayLeft = FRAME_DELAY_NANO;
+  static _Thread_local long frameDelayLeft = FRAME_DELAY_NANO;
   return (long*)&frameDelayLeft;
 }
 
+/**
+ * Признак сохранения рекорда в файл. Общий для всех потоков: выключается
+ * один раз до их запуска, например при массовом прогоне партий, где
+ * чтение и запись файла рекорда после каждой игры только мешают
+ */
+bool* getSaveHighScore() {
+  static bool save = 1;
+  return &save;
+}
+
+/**
+ * Получение версии состояния игры. Версия растет при каждом шаге и при
+ * каждом действии пользователя, изменившем игру, так что кадр с версией
+ * не меньше версии ввода показывает его результат
+ */
+unsigned long* getGeneration() {
+  static _Thread_local unsigned long generation = 0;
+  return &generation;
+}
+
+/**
+ * Получение времени последнего обновления состояния игры
+ */
+struct timespec* getLastUpdateTime() {
+  static _Thread_local struct timespec lastUpdate = {0, 0};
+  return &lastUpdate;
+}
+
+/**
+ * Интервал между шагами падения фигуры на текущей скорости
+ *
+ * @return интервал в наносекундах
+ */
+long getTickInterval() { return FRAME_DELAY_NANO / getGame()->speed; }
+
+/**
+ * Время, оставшееся до следующего шага падения фигуры
+ *
+ * @return задержка в наносекундах
+ * @return -1 - игра на паузе, шагов не будет до ввода пользователя
+ */
+long getTickTimeout() {
+  if (getGameInfo()->pause) return -1;
+  long timeout = *getFrameDelayLeft();
+  struct timespec* last = getLastUpdateTime();
+  if (last->tv_sec || last->tv_nsec) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    timeout -= timeDifference(last, &now);
+  }
+  return timeout < 0 ? 0 : timeout;
+}
+
 /**
  * Разница времени старта и окончания кадра
  *
@@ -488,32 +900,49 @@ long* getFrameDelayLeft() {
  * @return разница времени в наносекундах
  */
 long timeDifference(const struct timespec* start, const struct timespec* end) {
-  long difference = end->tv_nsec - start->tv_nsec;
-  if (end->tv_sec - start->tv_sec) difference += 1000000000;
-  return difference;
+  return (end->tv_sec - start->tv_sec) * 1000000000L + end->tv_nsec -
+         start->tv_nsec;
 }
 
 /**
  * Обновление состояния игры
  */
 GameInfo_t updateCurrentState() {
-  if (getGameInfo()->pause) return *getGameInfo();
-  static struct timespec sp_start, sp_end;
-  clock_gettime(CLOCK_MONOTONIC, &sp_start);
+  ENGINE_STATS_BEGIN(start);
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  struct timespec* last = getLastUpdateTime();
+  // На паузе время не идёт: отсчёт продолжится с момента снятия паузы
+  if (getGameInfo()->pause) {
+    *last = now;
+    return *getGameInfo();
+  }
+  TRACE_BEGIN("updateCurrentState");
+  if (last->tv_sec || last->tv_nsec)
+    *getFrameDelayLeft() -= timeDifference(last, &now);
+  *last = now;
+
+  if (*getFrameDelayLeft() <= 0) {
+    stepGame();
+    *getFrameDelayLeft() += getTickInterval();
+  }
+  ENGINE_STATS_BEGIN(compositeStart);
+  GameInfo_t* info = updateGameInfoField();
+  ENGINE_STATS_END(getEngineStats(), TETRIS_PHASE_COMPOSITE, compositeStart);
+  ENGINE_STATS_END(getEngineStats(), TETRIS_PHASE_FRAME, start);
+  TRACE_END("updateCurrentState");
+  return *info;
+}
 
+/**
+ * Наложение текущей фигуры на поле в игровой информации
+ */
+GameInfo_t* updateGameInfoField() {
   Game* game = getGame();
   GameInfo_t* info = getGameInfo();
   for (int i = 0; i < FIELD_HEIGHT * FIELD_WIDTH; i++) (*info->field)[i] = 0;
-  if (*getFrameDelayLeft() < 0) {
-    moveFigureDown();
-    if (figureCollision()) {
-      moveFigureUp();
-      calculateTurn();
-    }
-  }
-
-  Field* tf = game->field;
-  Figure* t = game->figure;
+  Field* tf = &game->field;
+  Figure* t = &game->figure;
 
   for (int i = 0; i < FIELD_HEIGHT; i++)
     for (int j = 0; j < FIELD_WIDTH; j++) {
@@ -529,11 +958,5 @@ GameInfo_t updateCurrentState() {
       }
     }
 
-  clock_gettime(CLOCK_MONOTONIC, &sp_end);
-  if (*getFrameDelayLeft() < 0)
-    *getFrameDelayLeft() =
-        FRAME_DELAY_NANO / (game->speed * 0.2) + *getFrameDelayLeft();
-  *getFrameDelayLeft() -= timeDifference(&sp_start, &sp_end);
-
-  return *info;
-}
+  return info;
+}
\ No newline at end of file
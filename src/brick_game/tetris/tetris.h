@@ -1,11 +1,22 @@
 #ifndef TETRIS_H
 #define TETRIS_H
 
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200809L
+#endif
+
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
 
+#include "../common/engine_stats.h"
+#include "../common/random.h"
+#include "../common/replay.h"
+#include "../common/rewind.h"
+#include "../common/trace.h"
+#include "../common/zobrist.h"
 #include "../library_specification.h"
 
 #ifndef __USE_POSIX199309
@@ -18,50 +29,92 @@
 #define FIELD_WIDTH 10
 #define FIELD_HEIGHT 20
 
-#ifdef DESKTOP_VERSION
-#define FRAME_DELAY_NANO 1000000
-#else
-#define FRAME_DELAY_NANO 10000000
-#endif
+#define FRAME_DELAY_NANO 1000000000
 
 #define FIGURES_COUNT 7
 #define FIGURE_SIZE 5
 #define FIGURE_AREA 25
 
+// Начала диапазонов номеров ключей Зобриста: клетки поля, клетки фигуры
+// и положения фигуры
+#define HASH_FIELD_KEYS 0
+#define HASH_SHAPE_KEYS 0x10000
+#define HASH_POSITION_KEYS 0x20000
+
 typedef struct Figure {
   int x;
   int y;
   int size;
-  char* blocks;
+  char blocks[FIGURE_AREA];
 } Figure;
 
 typedef struct Field {
   int width;
   int height;
-  char* blocks;
+  char blocks[FIELD_WIDTH * FIELD_HEIGHT];
 } Field;
 
 enum GAME_STATE { GAMEOVER, PLAYING };
 
+/**
+ * Фазы такта, для которых собирается статистика
+ */
+enum TETRIS_PHASE {
+  TETRIS_PHASE_FRAME,
+  TETRIS_PHASE_STEP,
+  TETRIS_PHASE_GRAVITY,
+  TETRIS_PHASE_CALCULATE_TURN,
+  TETRIS_PHASE_ERASE_LINES,
+  TETRIS_PHASE_HIGH_SCORE,
+  TETRIS_PHASE_COMPOSITE,
+  TETRIS_PHASES
+};
+
 typedef struct Game {
-  Field* field;
-  Figure* figure;
+  Field field;
+  Figure figure;
+  Figure next;
   int speed;
   char playing;
   int score;
   int high_score;
+  unsigned int tick;
+  // Хеши Зобриста поля и текущей фигуры, обновляются при каждом изменении
+  uint64_t fieldHash;
+  uint64_t figureHash;
 } Game;
 
+/**
+ * Снимок состояния игры фиксированного размера без указателей: копируется
+ * одним присваиванием, годится для кольца отката и опорных кадров записи
+ */
+typedef struct TetrisState {
+  Game game;
+  int pause;
+  uint32_t random;
+} TetrisState;
+
+/**
+ * Контекст движка: игра и генератор случайных чисел. Функции движка
+ * работают с текущим контекстом потока, у каждого потока есть собственный
+ */
+typedef struct TetrisContext {
+  Game game;
+  uint32_t random;
+} TetrisContext;
+
 char* getFigureFromTemplate(int i);
-Field* createField();
-Figure* createFigure();
-Figure* createNextFigure();
-Figure* freeFigure(Figure* figure);
+TetrisContext* getTetrisContext();
+TetrisContext* switchTetrisContext(TetrisContext* context);
+uint32_t* getRandomState();
+void seedGame(unsigned int seed);
+void initField(Field* field);
+Figure createNextFigure();
 Figure* nextFigure(bool create);
-Figure* dropFigure(Figure* figure);
-Game* createGame();
+void initGame(Game* game);
 Game* getGame();
 GameInfo_t* getGameInfo();
+void copyNextFigureInfo();
 void updateNextFigureInfo();
 void resetSingletones();
 void freeSingletones();
@@ -74,10 +127,34 @@ void plantFigure();
 char lineIsFull(int i, Field* field);
 void shiftLine(int i, Field* field);
 int eraseLines();
-Figure* rotateFigure();
+Figure rotateFigure();
+uint64_t hashBlock(int cell, char block);
+uint64_t hashField(const Field* field);
+uint64_t hashFigure(const Figure* figure);
+void rehashGame(Game* game);
+uint64_t getGameHash();
+uint64_t getGameChecksum();
 void compareHighScores();
 void calculateTurn();
+void stepGame();
+void advanceGame();
+bool applyInput(UserAction_t action);
+GameInfo_t* updateGameInfoField();
+void snapshotGame(TetrisState* state);
+void restoreGame(const TetrisState* state);
+void loadReplayState(const void* state);
+RewindRing* getRewindRing();
+int rewindGame(unsigned int steps);
+ReplayWriter* getRecorder();
+EngineStats* getEngineStats();
+int startRecording(const char* path, unsigned int seed);
+void stopRecording();
 long* getFrameDelayLeft();
+bool* getSaveHighScore();
+unsigned long* getGeneration();
+struct timespec* getLastUpdateTime();
+long getTickInterval();
+long getTickTimeout();
 long timeDifference(const struct timespec* start, const struct timespec* end);
 
 #endif
\ No newline at end of file
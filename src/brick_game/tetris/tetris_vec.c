@@ -0,0 +1,325 @@
+#include "tetris_vec.h"
+
+#include <pthread.h>
+
+/**
+ * Поток пакета и его номер: поток number ведет среды своего диапазона
+ */
+typedef struct TetrisVecWorker {
+  struct TetrisVec* vec;
+  unsigned int number;
+  pthread_t thread;
+} TetrisVecWorker;
+
+/**
+ * Пакет сред. Аргументы текущего шага лежат в самом пакете, потоки читают
+ * их, получив номер шага под мьютексом, поэтому шаг ничего не выделяет
+ */
+struct TetrisVec {
+  TetrisContext* contexts;
+  unsigned int count;
+  unsigned int threads;
+  unsigned long episodes;
+  TetrisVecWorker workers[TETRIS_VEC_MAX_THREADS];
+  pthread_mutex_t mutex;
+  pthread_cond_t wake;
+  pthread_cond_t done;
+  // Номер шага, который раздан потокам, и потоки, еще не закончившие его
+  unsigned long round;
+  unsigned int active;
+  bool stop;
+  const UserAction_t* actions;
+  const TetrisPlacement* placements;
+  float* rewards;
+  uint8_t* dones;
+  TetrisObservation* observations;
+};
+
+/**
+ * Строка квадрата фигуры битами
+ */
+static uint8_t figureRow(const Figure* figure, int row) {
+  uint8_t bits = 0;
+  for (int col = 0; col < FIGURE_SIZE; col++)
+    if (figure->blocks[row * FIGURE_SIZE + col]) bits |= 1u << col;
+  return bits;
+}
+
+/**
+ * Запись наблюдения игры, например собственной игры потока
+ *
+ * @param game игра
+ * @param observation наблюдение
+ */
+void observeTetrisGame(const Game* game, TetrisObservation* observation) {
+  for (int row = 0; row < FIELD_HEIGHT; row++) {
+    uint16_t bits = 0;
+    for (int col = 0; col < FIELD_WIDTH; col++)
+      if (game->field.blocks[row * FIELD_WIDTH + col]) bits |= 1u << col;
+    observation->rows[row] = bits;
+  }
+  for (int row = 0; row < FIGURE_SIZE; row++) {
+    observation->figure[row] = figureRow(&game->figure, row);
+    observation->next[row] = figureRow(&game->next, row);
+  }
+  observation->x = game->figure.x;
+  observation->y = game->figure.y;
+  observation->score = game->score;
+}
+
+/**
+ * Установка фигуры текущего контекста: повороты, сдвиг к столбцу, пока
+ * фигура двигается, и сброс вниз
+ */
+static void placeFigure(TetrisPlacement placement) {
+  Game* game = getGame();
+  for (int i = 0; i < (placement.rotations & 3); i++) applyInput(Action);
+  int x = game->figure.x - 1;
+  while (game->figure.x != placement.column && game->figure.x != x) {
+    x = game->figure.x;
+    applyInput(placement.column < x ? Left : Right);
+  }
+  applyInput(Down);
+}
+
+/**
+ * Шаг одной среды в текущем контексте. Действия интерфейса Start, Pause и
+ * Terminate не управляют партией и пропускаются
+ *
+ * @param vec пакет
+ * @param env номер среды
+ */
+static void stepEnv(TetrisVec* vec, unsigned int env) {
+  Game* game = getGame();
+  int score = game->score;
+  if (vec->placements) {
+    placeFigure(vec->placements[env]);
+  } else {
+    UserAction_t action = vec->actions[env];
+    if (action == Left || action == Right || action == Down ||
+        action == Action)
+      applyInput(action);
+    if (game->playing == PLAYING) advanceGame();
+  }
+  vec->rewards[env] = game->score - score;
+  vec->dones[env] = game->playing == GAMEOVER;
+  if (vec->dones[env]) initGame(game);
+  if (vec->observations) observeTetrisGame(game, &vec->observations[env]);
+}
+
+/**
+ * Шаг сред диапазона потока: [count * number / threads,
+ * count * (number + 1) / threads)
+ *
+ * @param vec пакет
+ * @param number номер потока
+ */
+static void stepRange(TetrisVec* vec, unsigned int number) {
+  unsigned int begin = vec->count * number / vec->threads;
+  unsigned int end = vec->count * (number + 1) / vec->threads;
+  TetrisContext* previous = getTetrisContext();
+  for (unsigned int env = begin; env < end; env++) {
+    switchTetrisContext(&vec->contexts[env]);
+    stepEnv(vec, env);
+  }
+  switchTetrisContext(previous);
+}
+
+/**
+ * Цикл дополнительного потока: ожидание нового шага, шаг своего диапазона
+ * и отметка о завершении
+ */
+static void* workerLoop(void* arg) {
+  TetrisVecWorker* worker = arg;
+  TetrisVec* vec = worker->vec;
+  unsigned long round = 0;
+  pthread_mutex_lock(&vec->mutex);
+  while (1) {
+    while (!vec->stop && vec->round == round)
+      pthread_cond_wait(&vec->wake, &vec->mutex);
+    if (vec->stop) break;
+    round = vec->round;
+    pthread_mutex_unlock(&vec->mutex);
+    stepRange(vec, worker->number);
+    pthread_mutex_lock(&vec->mutex);
+    if (--vec->active == 0) pthread_cond_signal(&vec->done);
+  }
+  pthread_mutex_unlock(&vec->mutex);
+  return NULL;
+}
+
+/**
+ * Запуск дополнительных потоков. Если поток не создался, пакет работает с
+ * уже созданными
+ *
+ * @param vec пакет
+ * @param threads запрошенное количество потоков вместе с вызывающим
+ */
+static void startWorkers(TetrisVec* vec, unsigned int threads) {
+  if (threads > vec->count) threads = vec->count;
+  if (threads > TETRIS_VEC_MAX_THREADS) threads = TETRIS_VEC_MAX_THREADS;
+  pthread_mutex_init(&vec->mutex, NULL);
+  pthread_cond_init(&vec->wake, NULL);
+  pthread_cond_init(&vec->done, NULL);
+  vec->threads = 1;
+  for (unsigned int number = 1; number < threads; number++) {
+    TetrisVecWorker* worker = &vec->workers[number];
+    worker->vec = vec;
+    worker->number = number;
+    if (pthread_create(&worker->thread, NULL, workerLoop, worker)) break;
+    vec->threads++;
+  }
+}
+
+/**
+ * Создание пакета и начало партии в каждой среде
+ *
+ * @param count количество сред
+ * @param seed зерно; среда env получает свое зерно seed + env * 0x9e3779b9
+ * @param threads количество потоков шага вместе с вызывающим, 0 и 1 -
+ * шаг в вызывающем потоке
+ *
+ * @return пакет
+ * @return NULL - не хватило памяти
+ */
+TetrisVec* createTetrisVec(unsigned int count, uint32_t seed,
+                           unsigned int threads) {
+  TetrisVec* vec = calloc(1, sizeof(TetrisVec));
+  if (!vec) return NULL;
+  vec->contexts = calloc(count ? count : 1, sizeof(TetrisContext));
+  if (!vec->contexts) {
+    free(vec);
+    return NULL;
+  }
+  vec->count = count;
+  for (unsigned int env = 0; env < count; env++)
+    vec->contexts[env].random = seedRandom(seed + env * 0x9e3779b9u);
+  resetTetrisVec(vec);
+  startWorkers(vec, threads);
+  return vec;
+}
+
+/**
+ * Остановка потоков и освобождение пакета
+ *
+ * @param vec пакет
+ */
+void freeTetrisVec(TetrisVec* vec) {
+  if (!vec) return;
+  pthread_mutex_lock(&vec->mutex);
+  vec->stop = 1;
+  pthread_cond_broadcast(&vec->wake);
+  pthread_mutex_unlock(&vec->mutex);
+  for (unsigned int number = 1; number < vec->threads; number++)
+    pthread_join(vec->workers[number].thread, NULL);
+  pthread_cond_destroy(&vec->done);
+  pthread_cond_destroy(&vec->wake);
+  pthread_mutex_destroy(&vec->mutex);
+  free(vec->contexts);
+  free(vec);
+}
+
+/**
+ * Начало новой партии во всех средах. Генераторы сред не сбрасываются
+ *
+ * @param vec пакет
+ */
+void resetTetrisVec(TetrisVec* vec) {
+  TetrisContext* previous = getTetrisContext();
+  for (unsigned int env = 0; env < vec->count; env++) {
+    switchTetrisContext(&vec->contexts[env]);
+    initGame(&vec->contexts[env].game);
+  }
+  switchTetrisContext(previous);
+  vec->episodes = 0;
+}
+
+/**
+ * Шаг всех сред с аргументами, уже записанными в пакет. Вызывающий поток
+ * ведет первый диапазон и ждет остальные потоки
+ */
+static void runStep(TetrisVec* vec) {
+  pthread_mutex_lock(&vec->mutex);
+  vec->round++;
+  vec->active = vec->threads - 1;
+  pthread_cond_broadcast(&vec->wake);
+  pthread_mutex_unlock(&vec->mutex);
+  stepRange(vec, 0);
+  pthread_mutex_lock(&vec->mutex);
+  while (vec->active) pthread_cond_wait(&vec->done, &vec->mutex);
+  pthread_mutex_unlock(&vec->mutex);
+  for (unsigned int env = 0; env < vec->count; env++)
+    vec->episodes += vec->dones[env];
+}
+
+/**
+ * Шаг всех сред: действие и такт падения фигуры, как у stepGame()
+ *
+ * @param vec пакет
+ * @param actions действия по средам
+ * @param rewards награды шага - прирост очков
+ * @param dones 1 - партия закончилась на этом шаге и среда сброшена
+ * @param observations наблюдения после шага, NULL - не нужны
+ */
+void stepTetrisVec(TetrisVec* vec, const UserAction_t* actions,
+                   float* rewards, uint8_t* dones,
+                   TetrisObservation* observations) {
+  vec->actions = actions;
+  vec->placements = NULL;
+  vec->rewards = rewards;
+  vec->dones = dones;
+  vec->observations = observations;
+  runStep(vec);
+}
+
+/**
+ * Шаг всех сред установкой текущей фигуры: один шаг - одна фигура
+ *
+ * @param vec пакет
+ * @param placements повороты и столбцы по средам
+ * @param rewards награды шага - прирост очков
+ * @param dones 1 - партия закончилась на этом шаге и среда сброшена
+ * @param observations наблюдения после шага, NULL - не нужны
+ */
+void placeTetrisVec(TetrisVec* vec, const TetrisPlacement* placements,
+                    float* rewards, uint8_t* dones,
+                    TetrisObservation* observations) {
+  vec->actions = NULL;
+  vec->placements = placements;
+  vec->rewards = rewards;
+  vec->dones = dones;
+  vec->observations = observations;
+  runStep(vec);
+}
+
+/**
+ * Запись наблюдений всех сред
+ *
+ * @param vec пакет
+ * @param observations массив из getTetrisVecCount() наблюдений
+ */
+void observeTetrisVec(const TetrisVec* vec, TetrisObservation* observations) {
+  for (unsigned int env = 0; env < vec->count; env++)
+    observeTetrisGame(&vec->contexts[env].game, &observations[env]);
+}
+
+/**
+ * Получение количества сред
+ */
+unsigned int getTetrisVecCount(const TetrisVec* vec) { return vec->count; }
+
+/**
+ * Получение количества законченных партий во всех средах
+ */
+unsigned long getTetrisVecEpisodes(const TetrisVec* vec) {
+  return vec->episodes;
+}
+
+/**
+ * Получение игры среды
+ *
+ * @param env номер среды
+ */
+const Game* getTetrisVecGame(const TetrisVec* vec, unsigned int env) {
+  return &vec->contexts[env].game;
+}
@@ -0,0 +1,54 @@
+#ifndef TETRIS_VEC_H
+#define TETRIS_VEC_H
+
+#include "tetris.h"
+
+// Наибольшее количество потоков пакета сред
+#define TETRIS_VEC_MAX_THREADS 64
+
+/**
+ * Наблюдение одной среды: установленные блоки по строкам битами (бит x -
+ * столбец x), текущая и следующая фигуры по строкам квадрата FIGURE_SIZE,
+ * положение текущей фигуры и очки партии
+ */
+typedef struct TetrisObservation {
+  uint16_t rows[FIELD_HEIGHT];
+  uint8_t figure[FIGURE_SIZE];
+  uint8_t next[FIGURE_SIZE];
+  int8_t x;
+  int8_t y;
+  int32_t score;
+} TetrisObservation;
+
+/**
+ * Установка текущей фигуры за один шаг: количество поворотов и столбец
+ * левого края квадрата фигуры, после чего фигура сбрасывается вниз
+ */
+typedef struct TetrisPlacement {
+  int8_t rotations;
+  int8_t column;
+} TetrisPlacement;
+
+/**
+ * Пакет независимых партий Tetris. Каждая партия - контекст движка, поток
+ * переключается между контекстами без копирования состояния
+ */
+typedef struct TetrisVec TetrisVec;
+
+TetrisVec* createTetrisVec(unsigned int count, uint32_t seed,
+                           unsigned int threads);
+void freeTetrisVec(TetrisVec* vec);
+void resetTetrisVec(TetrisVec* vec);
+void stepTetrisVec(TetrisVec* vec, const UserAction_t* actions,
+                   float* rewards, uint8_t* dones,
+                   TetrisObservation* observations);
+void placeTetrisVec(TetrisVec* vec, const TetrisPlacement* placements,
+                    float* rewards, uint8_t* dones,
+                    TetrisObservation* observations);
+void observeTetrisGame(const Game* game, TetrisObservation* observation);
+void observeTetrisVec(const TetrisVec* vec, TetrisObservation* observations);
+unsigned int getTetrisVecCount(const TetrisVec* vec);
+unsigned long getTetrisVecEpisodes(const TetrisVec* vec);
+const Game* getTetrisVecGame(const TetrisVec* vec, unsigned int env);
+
+#endif  // TETRIS_VEC_H
@@ -0,0 +1,104 @@
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "event_loop.h"
+
+#include <errno.h>
+#include <poll.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/timerfd.h>
+#endif
+
+/**
+ * Получение дескриптора таймера, взводимого на момент следующего шага игры
+ */
+static int* getTimerFd() {
+  static int timerFd = -1;
+  return &timerFd;
+}
+
+/**
+ * Создание таймера цикла событий
+ *
+ * @return дескриптор таймера
+ * @return -1 - таймер недоступен, используется таймаут poll()
+ */
+int initEventLoop() {
+#ifdef __linux__
+  if (*getTimerFd() < 0)
+    *getTimerFd() =
+        timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+#endif
+  return *getTimerFd();
+}
+
+/**
+ * Взвод таймера на заданную задержку
+ *
+ * @param timeout задержка в наносекундах, 0 - отключение таймера
+ */
+static void armTimer(long timeout) {
+#ifdef __linux__
+  struct itimerspec spec = {{0, 0}, {0, 0}};
+  spec.it_value.tv_sec = timeout / 1000000000L;
+  spec.it_value.tv_nsec = timeout % 1000000000L;
+  timerfd_settime(*getTimerFd(), 0, &spec, NULL);
+#else
+  (void)timeout;
+#endif
+}
+
+/**
+ * Ожидание ввода пользователя или наступления следующего шага игры.
+ * Между событиями процесс спит в poll() и не расходует процессорное время
+ *
+ * @param timeout время до следующего шага в наносекундах, -1 - шага не будет
+ *
+ * @return битовая маска EVENT_INPUT и EVENT_TICK, 0 - ожидание прервано
+ * сигналом
+ */
+int waitEvent(long timeout) {
+  struct pollfd fds[2] = {{STDIN_FILENO, POLLIN, 0},
+                          {*getTimerFd(), POLLIN, 0}};
+  nfds_t count = 1;
+  int pollTimeout = -1;
+  if (timeout == 0) {
+    pollTimeout = 0;
+  } else if (timeout > 0 && fds[1].fd >= 0) {
+    armTimer(timeout);
+    count = 2;
+  } else if (timeout > 0) {
+    pollTimeout = (int)((timeout + 999999) / 1000000);
+  }
+
+  int ready = poll(fds, count, pollTimeout);
+  int events = 0;
+  if (ready < 0 && errno == EINTR) {
+    events = 0;
+  } else {
+    if (fds[0].revents & POLLIN) events |= EVENT_INPUT;
+    if (count == 2 && (fds[1].revents & POLLIN)) {
+      uint64_t expirations = 0;
+      if (read(fds[1].fd, &expirations, sizeof(expirations)) > 0)
+        events |= EVENT_TICK;
+    } else if (timeout >= 0 && ready == 0) {
+      events |= EVENT_TICK;
+    }
+  }
+  if (count == 2 && !(events & EVENT_TICK)) armTimer(0);
+  return events;
+}
+
+/**
+ * Закрытие таймера цикла событий
+ */
+void freeEventLoop() {
+  if (*getTimerFd() >= 0) {
+    close(*getTimerFd());
+    *getTimerFd() = -1;
+  }
+}
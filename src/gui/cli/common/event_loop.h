@@ -0,0 +1,19 @@
+#ifndef EVENT_LOOP_H
+#define EVENT_LOOP_H
+
+#define EVENT_INPUT 1
+#define EVENT_TICK 2
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int initEventLoop();
+int waitEvent(long timeout);
+void freeEventLoop();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // EVENT_LOOP_H
@@ -0,0 +1,106 @@
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "playback.h"
+
+#include <ncurses.h>
+#include <time.h>
+
+#include "event_loop.h"
+#include "renderer.h"
+#include "terminal.h"
+
+#define ESCAPE 27
+#define SPACE 32
+
+/**
+ * Получение монотонного времени в наносекундах
+ */
+static long currentTime() {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec * 1000000000L + now.tv_nsec;
+}
+
+/**
+ * Обработка клавиш проигрывателя
+ *
+ * @param key код клавиши
+ * @param tick номер текущего шага
+ * @param reader структура проигрывателя
+ * @param paused состояние паузы
+ *
+ * @return 1 - проигрывание завершено
+ * @return 0 - иначе
+ */
+static int processPlaybackKey(int key, unsigned int* tick,
+                              const ReplayReader* reader, bool* paused) {
+  unsigned int interval = reader->header.keyframeInterval;
+  switch (key) {
+    case 'd':
+      *tick = *tick + interval < reader->ticks ? *tick + interval
+                                               : reader->ticks;
+      break;
+    case 'a':
+      *tick = *tick > interval ? *tick - interval : 0;
+      break;
+    case SPACE:
+      *paused = !*paused;
+      break;
+    case ESCAPE:
+      return 1;
+    default:
+      break;
+  }
+  return 0;
+}
+
+/**
+ * Проигрывание записи с шага tick. Игра идет в темпе записи, клавиши A и D
+ * перематывают на интервал опорных кадров, SPACE ставит на паузу, ESCAPE
+ * завершает проигрывание
+ *
+ * @param path путь к файлу записи
+ * @param engine функции движка
+ * @param draw отрисовка состояния игры
+ * @param tick начальный шаг
+ *
+ * @return 0 - OK
+ * @return -1 - файл не удалось открыть или он поврежден
+ * @return -2 - игра разошлась с записью
+ */
+int playReplay(const char* path, const ReplayEngine* engine,
+               void (*draw)(void), unsigned int tick) {
+  ReplayReader reader;
+  if (openReplayReader(&reader, path)) return -1;
+  if (*getTerminalBackend() == TERMINAL_NCURSES) nodelay(stdscr, TRUE);
+  bool paused = 0, exit = 0;
+  // Срок следующего шага, 0 - шаг не ожидается. Ввод срок не сдвигает
+  long deadline = 0;
+  int status = seekReplay(&reader, engine, tick);
+  while (!exit && !status) {
+    tick = reader.tick;
+    draw();
+    renderPrintf(2, 1, 2, "Replay %6u/%u", tick, reader.ticks);
+    presentFrame();
+    long now = currentTime(), timeout = -1;
+    if (paused || tick >= reader.ticks)
+      deadline = 0;
+    else if (!deadline)
+      deadline = now + engine->tickInterval();
+    if (deadline) timeout = deadline > now ? deadline - now : 0;
+    int events = waitEvent(timeout);
+    if (events & EVENT_INPUT)
+      for (int key = readKey(); key != ERR && !exit; key = readKey())
+        exit = processPlaybackKey(key, &tick, &reader, &paused);
+    // Сигнал прерывает ожидание без EVENT_TICK и шага не делает
+    if ((events & EVENT_TICK) && deadline && !paused && tick < reader.ticks) {
+      tick++;
+      deadline += engine->tickInterval();
+    }
+    status = seekReplay(&reader, engine, tick);
+  }
+  closeReplayReader(&reader);
+  return status;
+}
@@ -0,0 +1,17 @@
+#ifndef PLAYBACK_H
+#define PLAYBACK_H
+
+#include "../../../brick_game/common/replay.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int playReplay(const char* path, const ReplayEngine* engine,
+               void (*draw)(void), unsigned int tick);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // PLAYBACK_H
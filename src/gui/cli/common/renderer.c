@@ -0,0 +1,252 @@
+#include "renderer.h"
+
+#include <ncurses.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "terminal.h"
+
+/**
+ * Кадр, который собирается к следующему выводу
+ */
+static Cell* getBackBuffer() {
+  static Cell backBuffer[RENDER_ROWS * RENDER_COLS];
+  return backBuffer;
+}
+
+/**
+ * Кадр, который сейчас находится на экране
+ */
+static Cell* getFrontBuffer() {
+  static Cell frontBuffer[RENDER_ROWS * RENDER_COLS];
+  return frontBuffer;
+}
+
+/**
+ * Получение SGR-последовательностей цветовых пар для вывода в режиме ANSI
+ */
+static char (*getAnsiPairs())[ANSI_SGR_SIZE] {
+  static char ansiPairs[RENDER_PAIRS][ANSI_SGR_SIZE];
+  return ansiPairs;
+}
+
+/**
+ * Задание цветовой пары для вывода в режиме ANSI, аналог init_pair()
+ *
+ * @param pair номер цветовой пары
+ * @param foreground цвет символа в формате 0xRRGGBB
+ * @param background цвет фона в формате 0xRRGGBB
+ */
+void initAnsiPair(short pair, int foreground, int background) {
+  if (pair > 0 && pair < RENDER_PAIRS)
+    snprintf(getAnsiPairs()[pair], ANSI_SGR_SIZE,
+             "\x1b[38;2;%d;%d;%d;48;2;%d;%d;%dm", (foreground >> 16) & 0xff,
+             (foreground >> 8) & 0xff, foreground & 0xff,
+             (background >> 16) & 0xff, (background >> 8) & 0xff,
+             background & 0xff);
+}
+
+/**
+ * Запись символа в собираемый кадр, клетки за пределами кадра отбрасываются
+ */
+static void putCell(int y, int x, char ch, short pair) {
+  if (y >= 0 && y < RENDER_ROWS && x >= 0 && x < RENDER_COLS) {
+    Cell* cell = &getBackBuffer()[y * RENDER_COLS + x];
+    cell->ch = ch;
+    cell->pair = pair;
+  }
+}
+
+/**
+ * Сброс обоих кадров в пустой экран. Вызывается после clear(), когда экран
+ * действительно пуст, поэтому уже отрисованные рамки и подписи нужно
+ * записать в кадр заново
+ */
+void resetRenderer() {
+  for (int i = 0; i < RENDER_ROWS * RENDER_COLS; i++) {
+    getBackBuffer()[i] = (Cell){' ', 0};
+    getFrontBuffer()[i] = (Cell){' ', 0};
+  }
+}
+
+/**
+ * Запись строки в кадр
+ *
+ * @param y строка экрана
+ * @param x столбец экрана
+ * @param pair цветовая пара
+ * @param text строка
+ */
+void renderText(int y, int x, short pair, const char* text) {
+  for (int i = 0; text[i]; i++) putCell(y, x + i, text[i], pair);
+}
+
+/**
+ * Запись форматированной строки в кадр
+ *
+ * @param y строка экрана
+ * @param x столбец экрана
+ * @param pair цветовая пара
+ * @param format формат в стиле printf
+ */
+void renderPrintf(int y, int x, short pair, const char* format, ...) {
+  char text[RENDER_COLS + 1];
+  va_list args;
+  va_start(args, format);
+  vsnprintf(text, sizeof(text), format, args);
+  va_end(args);
+  renderText(y, x, pair, text);
+}
+
+/**
+ * Запись поля из блоков в кадр, каждый блок занимает две клетки экрана
+ *
+ * @param y строка экрана левого верхнего блока
+ * @param x столбец экрана левого верхнего блока
+ * @param blocks значения блоков, 0 - пустой блок
+ * @param rows количество строк
+ * @param cols количество столбцов
+ */
+void renderBlocks(int y, int x, int** blocks, int rows, int cols) {
+  for (int i = 0; i < rows; i++)
+    for (int j = 0; j < cols; j++) {
+      short pair = EMPTY_BLOCK_PAIR;
+      if (blocks[i][j]) pair = blocks[i][j] + BLOCK_PAIR_OFFSET;
+      putCell(y + i, x + j * 2, ' ', pair);
+      putCell(y + i, x + j * 2 + 1, ' ', pair);
+    }
+}
+
+/**
+ * Запись рамки в кадр
+ *
+ * @param x столбец левого верхнего угла
+ * @param y строка левого верхнего угла
+ * @param width ширина внутренней области
+ * @param height высота внутренней области
+ * @param pair цветовая пара
+ */
+void renderBorder(int x, int y, int width, int height, short pair) {
+  for (int i = x; i < width + 2 + x; i++) {
+    putCell(y, i, ' ', pair);               // верхняя граница
+    putCell(y + height + 1, i, ' ', pair);  // нижняя граница
+  }
+  for (int i = y; i < height + 2 + y; i++) {
+    putCell(i, x, ' ', pair);              // левая граница
+    putCell(i, x + width + 1, ' ', pair);  // правая граница
+  }
+}
+
+/**
+ * Запись рамки из псевдографики ASCII с заголовком, аналог box() для окна
+ *
+ * @param y строка левого верхнего угла
+ * @param x столбец левого верхнего угла
+ * @param height высота рамки вместе с границами
+ * @param width ширина рамки вместе с границами
+ * @param title заголовок в верхней границе
+ */
+void renderBox(int y, int x, int height, int width, const char* title) {
+  for (int i = x + 1; i < x + width - 1; i++) {
+    putCell(y, i, '-', 0);
+    putCell(y + height - 1, i, '-', 0);
+  }
+  for (int i = y + 1; i < y + height - 1; i++) {
+    putCell(i, x, '|', 0);
+    putCell(i, x + width - 1, '|', 0);
+  }
+  putCell(y, x, '+', 0);
+  putCell(y, x + width - 1, '+', 0);
+  putCell(y + height - 1, x, '+', 0);
+  putCell(y + height - 1, x + width - 1, '+', 0);
+  renderText(y, x + 9, 0, title);
+}
+
+/**
+ * Вывод изменившихся клеток через ncurses. Подряд идущие изменившиеся клетки
+ * с одной цветовой парой выводятся одним вызовом mvaddnstr()
+ */
+static void presentNcursesFrame() {
+  Cell* back = getBackBuffer();
+  Cell* front = getFrontBuffer();
+  char run[RENDER_COLS + 1];
+  for (int y = 0; y < RENDER_ROWS; y++) {
+    Cell* backRow = back + y * RENDER_COLS;
+    Cell* frontRow = front + y * RENDER_COLS;
+    int x = 0;
+    while (x < RENDER_COLS) {
+      if (backRow[x].ch == frontRow[x].ch &&
+          backRow[x].pair == frontRow[x].pair) {
+        x++;
+        continue;
+      }
+      short pair = backRow[x].pair;
+      int start = x;
+      int length = 0;
+      while (x < RENDER_COLS && backRow[x].pair == pair &&
+             (backRow[x].ch != frontRow[x].ch ||
+              backRow[x].pair != frontRow[x].pair)) {
+        run[length++] = backRow[x].ch;
+        frontRow[x] = backRow[x];
+        x++;
+      }
+      attrset(COLOR_PAIR(pair));
+      mvaddnstr(y, start, run, length);
+    }
+  }
+  attrset(A_NORMAL);
+  refresh();
+}
+
+/**
+ * Вывод изменившихся клеток escape-последовательностями ANSI. Кадр
+ * собирается в заранее выделенный буфер и выводится одним вызовом write().
+ * Перемещение курсора добавляется только при разрыве между клетками, смена
+ * цвета - только при смене цветовой пары
+ */
+static void presentAnsiFrame() {
+  static char frame[RENDER_ROWS * RENDER_COLS *
+                    (ANSI_SGR_SIZE + ANSI_MOVE_SIZE + 1)];
+  Cell* back = getBackBuffer();
+  Cell* front = getFrontBuffer();
+  size_t length = 0;
+  int cursor = -1;
+  short currentPair = -1;
+  for (int i = 0; i < RENDER_ROWS * RENDER_COLS; i++) {
+    if (back[i].ch == front[i].ch && back[i].pair == front[i].pair) continue;
+    if (cursor != i)
+      length += snprintf(frame + length, ANSI_MOVE_SIZE, "\x1b[%d;%dH",
+                         i / RENDER_COLS + 1, i % RENDER_COLS + 1);
+    if (back[i].pair != currentPair) {
+      currentPair = back[i].pair;
+      const char* sgr = getAnsiPairs()[currentPair];
+      if (currentPair <= 0 || currentPair >= RENDER_PAIRS || !*sgr)
+        sgr = "\x1b[0m";
+      size_t sgrLength = strlen(sgr);
+      memcpy(frame + length, sgr, sgrLength);
+      length += sgrLength;
+    }
+    frame[length++] = back[i].ch;
+    front[i] = back[i];
+    // После последнего столбца курсор не переходит на следующую строку сам
+    cursor = (i + 1) % RENDER_COLS ? i + 1 : -1;
+  }
+  size_t written = 0;
+  while (written < length) {
+    ssize_t result = write(STDOUT_FILENO, frame + written, length - written);
+    if (result <= 0) break;
+    written += result;
+  }
+}
+
+/**
+ * Вывод изменившихся клеток на экран выбранным способом
+ */
+void presentFrame() {
+  if (*getTerminalBackend() == TERMINAL_ANSI)
+    presentAnsiFrame();
+  else
+    presentNcursesFrame();
+}
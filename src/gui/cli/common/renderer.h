@@ -0,0 +1,36 @@
+#ifndef RENDERER_H
+#define RENDERER_H
+
+#define RENDER_ROWS 32
+#define RENDER_COLS 80
+
+#define RENDER_PAIRS 32
+#define ANSI_SGR_SIZE 48
+#define ANSI_MOVE_SIZE 12
+
+#define EMPTY_BLOCK_PAIR 1
+#define BLOCK_PAIR_OFFSET 9
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct Cell {
+  char ch;
+  short pair;
+} Cell;
+
+void initAnsiPair(short pair, int foreground, int background);
+void resetRenderer();
+void renderText(int y, int x, short pair, const char* text);
+void renderPrintf(int y, int x, short pair, const char* format, ...);
+void renderBlocks(int y, int x, int** blocks, int rows, int cols);
+void renderBorder(int x, int y, int width, int height, short pair);
+void renderBox(int y, int x, int height, int width, const char* title);
+void presentFrame();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // RENDERER_H
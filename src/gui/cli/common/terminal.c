@@ -0,0 +1,181 @@
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "terminal.h"
+
+#include <ncurses.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "renderer.h"
+
+#define ANSI_ENTER "\x1b[?1049h\x1b[?25l\x1b[2J"
+#define ANSI_LEAVE "\x1b[0m\x1b[?25h\x1b[?1049l"
+#define ANSI_CLEAR "\x1b[0m\x1b[2J"
+#define KEY_BUFFER_SIZE 64
+
+/**
+ * Выбор способа вывода по аргументам командной строки
+ *
+ * @param argc количество аргументов
+ * @param argv аргументы
+ *
+ * @return TERMINAL_ANSI - передан флаг --ansi
+ * @return TERMINAL_NCURSES - иначе
+ */
+TerminalBackend_t parseTerminalBackend(int argc, char* argv[]) {
+  TerminalBackend_t backend = TERMINAL_NCURSES;
+  for (int i = 1; i < argc; i++)
+    if (!strcmp(argv[i], ANSI_FLAG)) backend = TERMINAL_ANSI;
+  return backend;
+}
+
+/**
+ * Поиск значения параметра командной строки вида "--flag value"
+ *
+ * @param argc количество аргументов
+ * @param argv аргументы
+ * @param flag имя параметра
+ *
+ * @return значение параметра
+ * @return NULL - параметр не передан
+ */
+const char* parseOption(int argc, char* argv[], const char* flag) {
+  const char* value = NULL;
+  for (int i = 1; i + 1 < argc; i++)
+    if (!strcmp(argv[i], flag)) value = argv[i + 1];
+  return value;
+}
+
+/**
+ * Проверка наличия параметра командной строки без значения
+ *
+ * @param argc количество аргументов
+ * @param argv аргументы
+ * @param flag имя параметра
+ *
+ * @return true - параметр указан
+ */
+bool hasFlag(int argc, char* argv[], const char* flag) {
+  bool found = 0;
+  for (int i = 1; i < argc; i++)
+    if (!strcmp(argv[i], flag)) found = 1;
+  return found;
+}
+
+/**
+ * Получение текущего способа вывода
+ */
+TerminalBackend_t* getTerminalBackend() {
+  static TerminalBackend_t backend = TERMINAL_NCURSES;
+  return &backend;
+}
+
+/**
+ * Настройки терминала до перехода в посимвольный режим
+ */
+static struct termios* getSavedTermios() {
+  static struct termios saved;
+  return &saved;
+}
+
+/**
+ * Восстановление терминала при прерывании по Ctrl+C. Использует только
+ * async-signal-safe вызовы
+ */
+static void handleInterrupt(int signal) {
+  (void)signal;
+  tcsetattr(STDIN_FILENO, TCSAFLUSH, getSavedTermios());
+  if (write(STDOUT_FILENO, ANSI_LEAVE, sizeof(ANSI_LEAVE) - 1) < 0) _exit(1);
+  _exit(130);
+}
+
+/**
+ * Перевод терминала в посимвольный режим без эха и переход на
+ * альтернативный экран
+ */
+void initAnsiTerminal() {
+  tcgetattr(STDIN_FILENO, getSavedTermios());
+  struct termios raw = *getSavedTermios();
+  raw.c_lflag &= ~(ICANON | ECHO);
+  raw.c_cc[VMIN] = 0;
+  raw.c_cc[VTIME] = 0;
+  tcsetattr(STDIN_FILENO, TCSAFLUSH, &raw);
+  signal(SIGINT, handleInterrupt);
+  if (write(STDOUT_FILENO, ANSI_ENTER, sizeof(ANSI_ENTER) - 1) < 0) return;
+}
+
+/**
+ * Восстановление исходных настроек терминала
+ */
+void freeAnsiTerminal() {
+  tcsetattr(STDIN_FILENO, TCSAFLUSH, getSavedTermios());
+  signal(SIGINT, SIG_DFL);
+  if (write(STDOUT_FILENO, ANSI_LEAVE, sizeof(ANSI_LEAVE) - 1) < 0) return;
+}
+
+/**
+ * Очищение экрана и кадров отрисовщика
+ */
+void clearScreen() {
+  if (*getTerminalBackend() == TERMINAL_ANSI) {
+    if (write(STDOUT_FILENO, ANSI_CLEAR, sizeof(ANSI_CLEAR) - 1) < 0) return;
+  } else {
+    clear();
+    refresh();
+  }
+  resetRenderer();
+}
+
+/**
+ * Чтение байтов, уже доступных на стандартном вводе, без ожидания
+ *
+ * @param buffer буфер для байтов
+ * @param size размер буфера
+ *
+ * @return количество прочитанных байтов
+ */
+static int readAvailable(unsigned char* buffer, int size) {
+  struct pollfd fd = {STDIN_FILENO, POLLIN, 0};
+  int count = 0;
+  if (poll(&fd, 1, 0) > 0) {
+    ssize_t readed = read(STDIN_FILENO, buffer, size);
+    if (readed > 0) count = (int)readed;
+  }
+  return count;
+}
+
+/**
+ * Получение очередной нажатой клавиши без ожидания. В режиме ANSI
+ * escape-последовательности функциональных клавиш пропускаются, чтобы
+ * стрелки не завершали игру как одиночный ESCAPE
+ *
+ * @return код клавиши
+ * @return ERR - ввода нет
+ */
+int readKey() {
+  if (*getTerminalBackend() == TERMINAL_NCURSES) return getch();
+
+  static unsigned char keys[KEY_BUFFER_SIZE];
+  static int begin = 0, end = 0;
+  if (begin == end) {
+    begin = 0;
+    end = readAvailable(keys, KEY_BUFFER_SIZE);
+  }
+  int key = ERR;
+  if (begin < end) {
+    key = keys[begin++];
+    if (key == 27 && begin < end && (keys[begin] == '[' || keys[begin] == 'O')) {
+      begin++;
+      while (begin < end && (keys[begin] < 0x40 || keys[begin] > 0x7e)) begin++;
+      if (begin < end) begin++;
+      key = readKey();
+    }
+  }
+  return key;
+}
@@ -0,0 +1,31 @@
+#ifndef TERMINAL_H
+#define TERMINAL_H
+
+#include <stdbool.h>
+
+#define ANSI_FLAG "--ansi"
+#define RECORD_FLAG "--record"
+#define REPLAY_FLAG "--replay"
+#define SEEK_FLAG "--seek"
+#define STATS_FLAG "--stats"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum { TERMINAL_NCURSES, TERMINAL_ANSI } TerminalBackend_t;
+
+TerminalBackend_t parseTerminalBackend(int argc, char* argv[]);
+const char* parseOption(int argc, char* argv[], const char* flag);
+bool hasFlag(int argc, char* argv[], const char* flag);
+TerminalBackend_t* getTerminalBackend();
+void initAnsiTerminal();
+void freeAnsiTerminal();
+void clearScreen();
+int readKey();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // TERMINAL_H
@@ -21,6 +21,9 @@ void Controller::handleUserInput(int input) {
     case 'e':
       userInput(Action, 0);
       break;
+    case 'p':
+      toggleAutopilot();
+      break;
     case SPACE:
       userInput(Pause, 0);
       break;
@@ -30,4 +33,13 @@ void Controller::handleUserInput(int input) {
     default:
       break;
   }
-}
\ No newline at end of file
+}
+void Controller::toggleAutopilot() {
+  autopilotEnabled_ = !autopilotEnabled_;
+  autopilot_.reset();
+}
+
+// Вызывается на каждом кадре, автопилот сам решает раз за шаг змейки
+void Controller::drive() {
+  if (autopilotEnabled_) autopilot_.drive(model_);
+}
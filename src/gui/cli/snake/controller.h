@@ -1,6 +1,7 @@
 #ifndef CONTROLLER_H
 #define CONTROLLER_H
 
+#include "../../../brick_game/snake/autopilot.h"
 #include "../../../brick_game/snake/snake.h"
 
 #define ESCAPE 27
@@ -12,10 +13,15 @@ class Controller {
  public:
   Controller();
   void handleUserInput(int input);
+  void drive();
+  void toggleAutopilot();
   Game& getModel() { return model_; }
+  bool isAutopilot() const { return autopilotEnabled_; }
 
  private:
   Game& model_;
+  Autopilot autopilot_;
+  bool autopilotEnabled_ = false;
 };
 
 }  // namespace s21
@@ -1,5 +1,10 @@
+#include <cstdlib>
 #include <ctime>
 
+#include "../../../brick_game/common/latency.h"
+#include "../common/event_loop.h"
+#include "../common/playback.h"
+#include "../common/terminal.h"
 #include "view.h"
 
 #define COLOR_DARK_GREEN 11
@@ -11,6 +16,9 @@
 #define ENTER 10
 #define ESCAPE 27
 
+#define ANSI_TEXT_COLOR 0xe5e5e5
+#define ANSI_BACKGROUND_COLOR 0x262626
+
 void configureInterface() {
   cbreak();  // переключаем режим для немедленного ввода символов, ctrl+c можно
              // использовать для прерывания
@@ -21,11 +29,36 @@ void configureInterface() {
 }
 
 void initInterface() {
-  initscr();  // инициализируем библиотеку ncurses
-  configureInterface();  // настраиваем конфигурацию интерфейса
+  if (*getTerminalBackend() == TERMINAL_ANSI) {
+    initAnsiTerminal();  // переводим терминал в посимвольный режим
+  } else {
+    initscr();  // инициализируем библиотеку ncurses
+    configureInterface();  // настраиваем конфигурацию интерфейса
+  }
+}
+
+void freeInterface() {
+  if (*getTerminalBackend() == TERMINAL_ANSI)
+    freeAnsiTerminal();
+  else
+    endwin();
+}
+
+void initAnsiGameInterface() {
+  initAnsiPair(1, ANSI_TEXT_COLOR, ANSI_BACKGROUND_COLOR);
+  initAnsiPair(2, ANSI_TEXT_COLOR, 0x000000);
+  initAnsiPair(3, ANSI_TEXT_COLOR, 0x000000);
+  initAnsiPair(4, 0x000000, 0xe5e5e5);
+  initAnsiPair(10, 0x000000, 0x00cd00);
+  initAnsiPair(11, 0x000000, 0x008000);
+  initAnsiPair(12, 0x000000, 0xcd0000);
 }
 
 void initGameInterface() {
+  if (*getTerminalBackend() == TERMINAL_ANSI) {
+    initAnsiGameInterface();
+    return;
+  }
   init_color(GAME_BACKGROUND_COLOR, 150, 150, 150);
   init_pair(1, TEXT_COLOR, GAME_BACKGROUND_COLOR);
   init_pair(2, TEXT_COLOR, COLOR_BLACK);
@@ -36,31 +69,93 @@ void initGameInterface() {
   init_pair(12, 0, COLOR_RED);
 }
 
-void startGame() {
+void startGame(const char* recordPath, bool autopilot) {
   initGameInterface();
-  refresh();
-  std::srand(std::time(0));
   s21::Controller controller;
+  if (autopilot) controller.toggleAutopilot();
   s21::View view(controller);
-  halfdelay(1);
-  while (view.getController().getModel().getPlaying() == s21::PLAYING) {
-    int i = getch();
-    view.getController().handleUserInput(i);
+  bool ncurses = *getTerminalBackend() == TERMINAL_NCURSES;
+  if (ncurses) nodelay(stdscr, TRUE);
+  s21::Game& game = view.getController().getModel();
+  if (recordPath) game.startRecording(recordPath, std::time(0));
+  // Рамки записываются в кадр один раз, на экран выводятся только изменения
+  resetRenderer();
+  view.drawBorders();
+  while (game.getPlaying() == s21::PLAYING) {
+    // Ввод считывается только после того, как poll() сообщил о его наличии
     updateCurrentState();
+    controller.drive();
+    TRACE_BEGIN("draw");
     view.drawGame();
     view.drawInterfaceExtras();
-    view.drawBorders();
-    refresh();
+    presentFrame();
+    TRACE_END("draw");
+    unsigned long presented = game.getGeneration();
+    recordFramePresented(presented);
+    if (waitEvent(s21::getTickTimeout()) & EVENT_INPUT)
+      for (int key = readKey(); key != ERR && game.getPlaying() == s21::PLAYING;
+           key = readKey()) {
+        uint64_t inputNs = engineStatsNow();
+        TRACE_BEGIN("handleUserInput");
+        view.getController().handleUserInput(key);
+        TRACE_END("handleUserInput");
+        // Клавиши без действия версию не меняют и не учитываются
+        if (game.getInputGeneration() > presented)
+          recordInputApplied(inputNs, game.getInputGeneration());
+      }
   }
-  view.getController().getModel().resetGame();
-  cbreak();
+  game.stopRecording();
+  game.resetGame();
+  if (ncurses) nodelay(stdscr, FALSE);
+}
+
+void drawReplay() {
+  s21::Controller controller;
+  s21::View view(controller);
+  controller.getModel().updateInfoField();
+  view.drawGame();
+  view.drawInterfaceExtras();
+}
+
+int startReplay(const char* path, const char* seek) {
+  ReplayEngine engine = {s21::loadReplayState, userInput, s21::stepReplay,
+                         s21::getReplayTickInterval, s21::getReplayChecksum};
+  initGameInterface();
+  s21::Controller controller;
+  s21::View view(controller);
+  resetRenderer();
+  view.drawBorders();
+  int status = playReplay(path, &engine, drawReplay,
+                          seek ? std::strtoul(seek, nullptr, 10) : 0);
+  controller.getModel().resetGame();
+  return status;
+}
+
+void createAnsiMenuInterface(const char* controls[], int count) {
+  renderBox(2, 10, 4, 25, "Snake");
+  renderBox(6, 10, count + 2, 25, "Control");
+  renderText(3, 12, 3, "Press ENTER to start");
+  renderText(4, 12, 3, "Press ESCAPE to exit");
+  for (int i = 0; i < count; i++) renderText(7 + i, 12, 3, controls[i]);
+  presentFrame();
 }
 
 void createMenuInterface() {
+  const char* controls[] = {"W      move up",    "A      move left",
+                            "S      move down",  "D      move right",
+                            "E      boost speed", "P      autopilot",
+                            "SPACE  to pause",    "ESCAPE to finish"};
+  int count = sizeof(controls) / sizeof(controls[0]);
+  if (*getTerminalBackend() == TERMINAL_ANSI) {
+    initAnsiGameInterface();
+    createAnsiMenuInterface(controls, count);
+    return;
+  }
+
   init_pair(3, TEXT_COLOR, MENU_BACKGROUND_COLOR);
 
   WINDOW* menu = newwin(4, 25, 2, 10);
-  WINDOW* control = newwin(9, 25, 6, 10);
+  WINDOW* control = newwin(count + 2, 25, 6, 10);
   box(menu, 0, 0);
   box(control, 0, 0);
   mvwprintw(menu, 0, 9, "Snake");
@@ -68,13 +163,8 @@ void createMenuInterface() {
   attron(COLOR_PAIR(3));
   mvwprintw(menu, 1, 2, "Press ENTER to start");
   mvwprintw(menu, 2, 2, "Press ESCAPE to exit");
-  mvwprintw(control, 1, 2, "W      move up");
-  mvwprintw(control, 2, 2, "A      move left");
-  mvwprintw(control, 3, 2, "S      move down");
-  mvwprintw(control, 4, 2, "D      move right");
-  mvwprintw(control, 5, 2, "E      boost speed");
-  mvwprintw(control, 6, 2, "SPACE  to pause");
-  mvwprintw(control, 7, 2, "ESCAPE to finish");
+  for (int i = 0; i < count; i++)
+    mvwprintw(control, i + 1, 2, "%s", controls[i]);
   attroff(COLOR_PAIR(3));
   refresh();
   wrefresh(menu);
@@ -84,17 +174,35 @@ void createMenuInterface() {
   delwin(control);
 }
 
-int main() {
+int main(int argc, char* argv[]) {
+  initTrace();
+  setTraceThreadName("main");
+  *getTerminalBackend() = parseTerminalBackend(argc, argv);
+  const char* recordPath = parseOption(argc, argv, RECORD_FLAG);
+  const char* replayPath = parseOption(argc, argv, REPLAY_FLAG);
   initInterface();
-  refresh();
+  clearScreen();
+  initEventLoop();
+  if (replayPath) {
+    int status = startReplay(replayPath, parseOption(argc, argv, SEEK_FLAG));
+    freeInterface();
+    freeEventLoop();
+    if (status == REPLAY_DESYNC)
+      std::fprintf(stderr, "Replay %s diverged from the recorded game\n",
+                   replayPath);
+    else if (status)
+      std::fprintf(stderr, "Cannot play replay %s\n", replayPath);
+    return status ? 1 : 0;
+  }
   createMenuInterface();
   bool exit = 0;
   while (!exit) {
-    switch (getch()) {
+    waitEvent(-1);
+    switch (readKey()) {
       case ENTER:
-        clear();
-        startGame();
-        clear();
+        clearScreen();
+        startGame(recordPath, hasFlag(argc, argv, AUTOPILOT_FLAG));
+        clearScreen();
         createMenuInterface();
         break;
       case ESCAPE:
@@ -104,6 +212,11 @@ int main() {
         break;
     }
   }
-  endwin();
+  freeInterface();
+  freeEventLoop();
+  if (hasFlag(argc, argv, STATS_FLAG))
+    printEngineStats(s21::getEngineStats(), stderr);
+  if (hasFlag(argc, argv, LATENCY_FLAG))
+    printEngineStats(getLatencyStats(), stderr);
   return 0;
-}
\ No newline at end of file
+}
@@ -3,6 +3,7 @@
 
 #include <ncurses.h>
 
+#include "../common/renderer.h"
 #include "controller.h"
 
 #define SNAKE_X 10
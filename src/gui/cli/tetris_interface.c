@@ -1,6 +1,12 @@
 #include <ncurses.h>
+#include <stdlib.h>
 
+#include "../../brick_game/common/latency.h"
 #include "../../brick_game/tetris/tetris.h"
+#include "common/event_loop.h"
+#include "common/playback.h"
+#include "common/renderer.h"
+#include "common/terminal.h"
 
 #define COLOR_ORANGE 11
 #define COLOR_BRIGHT_YELLOW 12
@@ -21,6 +27,9 @@
 #define ESCAPE 27
 #define SPACE 32
 
+#define ANSI_TEXT_COLOR 0xe5e5e5
+#define ANSI_BACKGROUND_COLOR 0x262626
+
 void configureInterface() {
   cbreak();  // переключаем режим для немедленного ввода символов, ctrl+c можно
              // использовать для прерывания
@@ -33,11 +42,41 @@ void configureInterface() {
 }
 
 void initInterface() {
-  initscr();  // инициализируем библиотеку ncurses
-  configureInterface();  // настраиваем конфигурацию интерфейса
+  if (*getTerminalBackend() == TERMINAL_ANSI) {
+    initAnsiTerminal();  // переводим терминал в посимвольный режим
+  } else {
+    initscr();  // инициализируем библиотеку ncurses
+    configureInterface();  // настраиваем конфигурацию интерфейса
+  }
+}
+
+void freeInterface() {
+  if (*getTerminalBackend() == TERMINAL_ANSI)
+    freeAnsiTerminal();
+  else
+    endwin();
+}
+
+void initAnsiGameInterface() {
+  initAnsiPair(1, ANSI_TEXT_COLOR, ANSI_BACKGROUND_COLOR);
+  initAnsiPair(2, ANSI_TEXT_COLOR, 0x000000);
+  initAnsiPair(3, ANSI_TEXT_COLOR, 0x000000);
+  initAnsiPair(4, 0x000000, 0xe5e5e5);
+  // Цвета фигур
+  initAnsiPair(10, 0x000000, 0xcd0000);
+  initAnsiPair(11, 0x000000, 0xe57300);
+  initAnsiPair(12, 0x000000, 0xe5e500);
+  initAnsiPair(13, 0x000000, 0xffafd7);
+  initAnsiPair(14, 0x000000, 0x00cd00);
+  initAnsiPair(15, 0x000000, 0x0000b2);
+  initAnsiPair(16, 0x000000, 0xcd00cd);
 }
 
 void initGameInterface() {
+  if (*getTerminalBackend() == TERMINAL_ANSI) {
+    initAnsiGameInterface();
+    return;
+  }
   init_color(GAME_BACKGROUND_COLOR, 150, 150, 150);
   init_pair(1, TEXT_COLOR, GAME_BACKGROUND_COLOR);
   init_pair(2, TEXT_COLOR, COLOR_BLACK);
@@ -56,98 +95,132 @@ void initGameInterface() {
   init_pair(16, 0, COLOR_MAGENTA);
 }
 
-void drawBorder(int x, int y, int width, int height) {
-  attron(COLOR_PAIR(4));
-  for (int i = x; i < width + 2 + x; i++)
-    mvaddch(y, i, ' ');  // верхняя граница
-  for (int i = x; i < width + 2 + x; i++)
-    mvaddch(y + height + 1, i, ' ');  // нижняя граница
-  for (int i = y; i < height + 2 + y; i++) mvaddch(i, x, ' ');  // левая граница
-  for (int i = y; i < height + 2 + y; i++)
-    mvaddch(i, x + width + 1, ' ');  // правая граница
-  attroff(COLOR_PAIR(4));
-}
-
 void drawBorders() {
-  drawBorder(TETRIS_X - 1, TETRIS_Y - 1, FIELD_WIDTH * 2,
-             FIELD_HEIGHT);                           // поле
-  drawBorder(25 + TETRIS_X - 1, GAME_INFO_Y, 20, 5);  // игровая информация
-  drawBorder(29 + TETRIS_X, GAME_INFO_Y + 10, 10, 5);  // следующая фигура
+  renderBorder(TETRIS_X - 1, TETRIS_Y - 1, FIELD_WIDTH * 2, FIELD_HEIGHT,
+               4);                                       // поле
+  renderBorder(25 + TETRIS_X - 1, GAME_INFO_Y, 20, 5, 4);  // игровая информация
+  renderBorder(29 + TETRIS_X, GAME_INFO_Y + 10, 10, 5, 4);  // следующая фигура
 }
 
 void drawInterfaceExtras() {
-  attron(COLOR_PAIR(2));
-  mvprintw(GAME_INFO_Y + 1, GAME_INFO_X, "Score: %d", getGame()->score);
-  mvprintw(GAME_INFO_Y + 2, GAME_INFO_X, "High Score: %d",
-           getGame()->high_score);
-  mvprintw(GAME_INFO_Y + 3, GAME_INFO_X, "Level: %d", getGameInfo()->level);
-  mvprintw(GAME_INFO_Y + 4, GAME_INFO_X, "Speed: %d", getGameInfo()->speed);
-  mvprintw(1, 1, "%s", getGameInfo()->pause ? "PAUSE" : "     ");
-  attroff(COLOR_PAIR(2));
-
-  GameInfo_t* info = getGameInfo();
-  for (int i = 0; i < FIGURE_SIZE; i++)
-    for (int j = 0; j < FIGURE_SIZE; j++) {
-      int ch = info->next[i][j];
-      attron(COLOR_PAIR(ch == 0 ? 1 : info->next[i][j] + 9));
-      mvaddch(GAME_INFO_Y + 11 + i, 30 + j * 2 + TETRIS_X, ' ');
-      mvaddch(GAME_INFO_Y + 11 + i, 30 + j * 2 + TETRIS_X + 1, ' ');
-      attroff(COLOR_PAIR(ch == 0 ? 1 : info->next[i][j] + 9));
-    }
+  renderPrintf(GAME_INFO_Y + 1, GAME_INFO_X, 2, "Score: %d", getGame()->score);
+  renderPrintf(GAME_INFO_Y + 2, GAME_INFO_X, 2, "High Score: %d",
+               getGame()->high_score);
+  renderPrintf(GAME_INFO_Y + 3, GAME_INFO_X, 2, "Level: %d",
+               getGameInfo()->level);
+  renderPrintf(GAME_INFO_Y + 4, GAME_INFO_X, 2, "Speed: %d",
+               getGameInfo()->speed);
+  renderText(1, 1, 2, getGameInfo()->pause ? "PAUSE" : "     ");
+  renderBlocks(GAME_INFO_Y + 11, 30 + TETRIS_X, getGameInfo()->next,
+               FIGURE_SIZE, FIGURE_SIZE);
 }
 
 void drawGame(GameInfo_t* info) {
-  for (int i = 0; i < FIELD_HEIGHT; i++)
-    for (int j = 0; j < FIELD_WIDTH; j++) {
-      int color = 1;
-      if (info->field[i][j]) color = info->field[i][j] + 9;
-      attron(COLOR_PAIR(color));
-      mvaddch(i + TETRIS_Y, j * 2 + TETRIS_X, ' ');
-      mvaddch(i + TETRIS_Y, j * 2 + TETRIS_X + 1, ' ');
-      attroff(COLOR_PAIR(color));
-    }
+  renderBlocks(TETRIS_Y, TETRIS_X, info->field, FIELD_HEIGHT, FIELD_WIDTH);
+}
+
+void processUserInput(int key) {
+  switch (key) {
+    case 'w':
+      userInput(Action, 0);
+      break;
+    case 's':
+      userInput(Down, 0);
+      break;
+    case 'a':
+      userInput(Left, 0);
+      break;
+    case 'd':
+      userInput(Right, 0);
+      break;
+    case SPACE:
+      userInput(Pause, 0);
+      break;
+    case ESCAPE:
+      userInput(Terminate, 0);
+      break;
+    default:
+      break;
+  }
 }
 
-void startGame() {
+void startGame(const char* recordPath) {
   initGameInterface();
-  refresh();
+  if (recordPath) startRecording(recordPath, time(NULL));
+  // Рамки записываются в кадр один раз, на экран выводятся только изменения
+  resetRenderer();
+  drawBorders();
   while (getGame()->playing) {
-    switch (getch()) {
-      case 'w':
-        userInput(Action, 0);
-        break;
-      case 's':
-        userInput(Down, 0);
-        break;
-      case 'a':
-        userInput(Left, 0);
-        break;
-      case 'd':
-        userInput(Right, 0);
-        break;
-      case SPACE:
-        userInput(Pause, 0);
-        break;
-      case ESCAPE:
-        userInput(Terminate, 0);
-        break;
-      default:
-        break;
-    }
+    // Ввод считывается только после того, как poll() сообщил о его наличии
     GameInfo_t info = updateCurrentState();
+    TRACE_BEGIN("draw");
     drawGame(&info);
     drawInterfaceExtras();
-    drawBorders();
-    refresh();
+    presentFrame();
+    TRACE_END("draw");
+    unsigned long presented = *getGeneration();
+    recordFramePresented(presented);
+    if (waitEvent(getTickTimeout()) & EVENT_INPUT)
+      for (int key = readKey(); key != ERR && getGame()->playing;
+           key = readKey()) {
+        uint64_t inputNs = engineStatsNow();
+        TRACE_BEGIN("processUserInput");
+        processUserInput(key);
+        TRACE_END("processUserInput");
+        // Клавиши без действия версию не меняют и не учитываются
+        if (*getGeneration() > presented)
+          recordInputApplied(inputNs, *getGeneration());
+      }
   }
+  stopRecording();
   resetSingletones();
 }
 
+void drawReplay() {
+  drawGame(updateGameInfoField());
+  drawInterfaceExtras();
+}
+
+int startReplay(const char* path, const char* seek) {
+  ReplayEngine engine = {loadReplayState, userInput, stepGame, getTickInterval,
+                         getGameChecksum};
+  initGameInterface();
+  resetRenderer();
+  drawBorders();
+  // Terminate из записи не должен перезаписывать файл рекорда игрока
+  bool saveHighScore = *getSaveHighScore();
+  *getSaveHighScore() = 0;
+  int status =
+      playReplay(path, &engine, drawReplay, seek ? strtoul(seek, NULL, 10) : 0);
+  *getSaveHighScore() = saveHighScore;
+  resetSingletones();
+  return status;
+}
+
+void createAnsiMenuInterface(const char* controls[], int count) {
+  renderBox(2, 10, 4, 25, "Tetris");
+  renderBox(6, 10, count + 2, 25, "Control");
+  renderText(3, 12, 3, "Press ENTER to start");
+  renderText(4, 12, 3, "Press ESCAPE to exit");
+  for (int i = 0; i < count; i++) renderText(7 + i, 12, 3, controls[i]);
+  presentFrame();
+}
+
 void createMenuInterface() {
+  const char* controls[] = {"W      rotate",    "A      move left",
+                            "S      drop",      "D      move right",
+                            "SPACE  to pause",  "ESCAPE to finish"};
+  int count = sizeof(controls) / sizeof(controls[0]);
+  if (*getTerminalBackend() == TERMINAL_ANSI) {
+    initAnsiGameInterface();
+    createAnsiMenuInterface(controls, count);
+    return;
+  }
+
   init_pair(3, TEXT_COLOR, MENU_BACKGROUND_COLOR);
 
   WINDOW* menu = newwin(4, 25, 2, 10);
-  WINDOW* control = newwin(8, 25, 6, 10);
+  WINDOW* control = newwin(count + 2, 25, 6, 10);
   box(menu, 0, 0);
   box(control, 0, 0);
   mvwprintw(menu, 0, 9, "Tetris");
@@ -155,12 +228,8 @@ void createMenuInterface() {
   attron(COLOR_PAIR(3));
   mvwprintw(menu, 1, 2, "Press ENTER to start");
   mvwprintw(menu, 2, 2, "Press ESCAPE to exit");
-  mvwprintw(control, 1, 2, "W      rotate");
-  mvwprintw(control, 2, 2, "A      move left");
-  mvwprintw(control, 3, 2, "S      drop");
-  mvwprintw(control, 4, 2, "D      move right");
-  mvwprintw(control, 5, 2, "SPACE  to pause");
-  mvwprintw(control, 6, 2, "ESCAPE to finish");
+  for (int i = 0; i < count; i++)
+    mvwprintw(control, i + 1, 2, "%s", controls[i]);
   attroff(COLOR_PAIR(3));
   refresh();
   wrefresh(menu);
@@ -170,17 +239,36 @@ void createMenuInterface() {
   delwin(control);
 }
 
-int main() {
+int main(int argc, char* argv[]) {
+  initTrace();
+  setTraceThreadName("main");
+  *getTerminalBackend() = parseTerminalBackend(argc, argv);
+  const char* recordPath = parseOption(argc, argv, RECORD_FLAG);
+  const char* replayPath = parseOption(argc, argv, REPLAY_FLAG);
   initInterface();
-  refresh();
+  clearScreen();
+  initEventLoop();
+  if (replayPath) {
+    int status = startReplay(replayPath, parseOption(argc, argv, SEEK_FLAG));
+    freeInterface();
+    freeEventLoop();
+    freeSingletones();
+    if (status == REPLAY_DESYNC)
+      fprintf(stderr, "Replay %s diverged from the recorded game\n",
+              replayPath);
+    else if (status)
+      fprintf(stderr, "Cannot play replay %s\n", replayPath);
+    return status ? 1 : 0;
+  }
   createMenuInterface();
   bool exit = 0;
   while (!exit) {
-    switch (getch()) {
+    waitEvent(-1);
+    switch (readKey()) {
       case ENTER:
-        clear();
-        startGame();
-        clear();
+        clearScreen();
+        startGame(recordPath);
+        clearScreen();
         createMenuInterface();
         break;
       case ESCAPE:
@@ -190,7 +278,12 @@ int main() {
         break;
     }
   }
-  endwin();
+  freeInterface();
+  freeEventLoop();
+  if (hasFlag(argc, argv, STATS_FLAG))
+    printEngineStats(getEngineStats(), stderr);
+  if (hasFlag(argc, argv, LATENCY_FLAG))
+    printEngineStats(getLatencyStats(), stderr);
   freeSingletones();
   return 0;
-}
\ No newline at end of file
+}
@@ -2,30 +2,54 @@
 
 using namespace s21;
 
-Controller::Controller() : model_(s21::Game::getGame()) {}
+// Игровая логика работает в отдельном потоке, графический поток только
+// передает ввод и рисует опубликованные снимки
+Controller::Controller() : worker_(new Worker) {
+  worker_->moveToThread(&thread_);
+  QObject::connect(&thread_, &QThread::finished, worker_,
+                   &QObject::deleteLater);
+  thread_.start();
+}
+
+Controller::~Controller() {
+  thread_.quit();
+  thread_.wait();
+}
+
+void Controller::startGame() {
+  QMetaObject::invokeMethod(worker_, &Worker::startGame, Qt::QueuedConnection);
+}
+
+void Controller::toggleAutopilot() {
+  QMetaObject::invokeMethod(worker_, &Worker::toggleAutopilot,
+                            Qt::QueuedConnection);
+}
 
 void Controller::handleUserInput(int input, bool hold) {
   switch (input) {
     case Qt::Key_W:
-      userInput(Up, hold);
+      worker_->pushInput(Up, hold);
       break;
     case Qt::Key_S:
-      userInput(Down, hold);
+      worker_->pushInput(Down, hold);
       break;
     case Qt::Key_A:
-      userInput(Left, hold);
+      worker_->pushInput(Left, hold);
       break;
     case Qt::Key_D:
-      userInput(Right, hold);
+      worker_->pushInput(Right, hold);
       break;
     case Qt::Key_E:
-      userInput(Action, hold);
+      worker_->pushInput(Action, hold);
+      break;
+    case Qt::Key_P:
+      if (!hold) toggleAutopilot();
       break;
     case Qt::Key_Space:
-      userInput(Pause, hold);
+      worker_->pushInput(Pause, hold);
       break;
     case Qt::Key_Escape:
-      userInput(Terminate, hold);
+      worker_->pushInput(Terminate, hold);
       break;
     default:
       break;
@@ -2,20 +2,26 @@
 #define CONTROLLER_H
 
 #include <QKeyEvent>
+#include <QThread>
 
 #include "../../../brick_game/library_specification.h"
 #include "../../../brick_game/snake/snake.h"
+#include "worker.h"
 
 namespace s21 {
 
 class Controller {
  public:
   Controller();
+  ~Controller();
   void handleUserInput(int input, bool hold);
-  Game& getModel() { return model_; }
+  void startGame();
+  void toggleAutopilot();
+  Worker* getWorker() { return worker_; }
 
  private:
-  Game& model_;
+  QThread thread_;
+  Worker* worker_;
 };
 
 }  // namespace s21
@@ -1,14 +1,24 @@
 #include <QApplication>
+#include <cstdio>
+#include <cstring>
 
 #include "controller.h"
 #include "snake_qt.h"
 
 int main(int argc, char *argv[]) {
   QApplication a(argc, argv);
+  initTrace();
+  setTraceThreadName("gui");
 
   s21::Controller controller;
   s21::View view(controller);
   view.show();
+  for (int i = 1; i < argc; i++)
+    if (!std::strcmp(argv[i], AUTOPILOT_FLAG)) controller.toggleAutopilot();
 
-  return a.exec();
+  int status = a.exec();
+  for (int i = 1; i < argc; i++)
+    if (!std::strcmp(argv[i], LATENCY_FLAG))
+      printEngineStats(getLatencyStats(), stderr);
+  return status;
 }
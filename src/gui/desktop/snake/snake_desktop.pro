@@ -15,11 +15,30 @@ SOURCES += \
     controller.cpp \
     main.cpp \
     snake_qt.cpp \
+    worker.cpp \
+    ../../../brick_game/common/engine_stats.c \
+    ../../../brick_game/common/latency.c \
+    ../../../brick_game/common/replay.c \
+    ../../../brick_game/common/rewind.c \
+    ../../../brick_game/common/trace.c \
+    ../../../brick_game/snake/autopilot.cpp \
     ../../../brick_game/snake/snake.cpp
 
 HEADERS += \
     controller.h \
     snake_qt.h \
+    worker.h \
+    ../../../brick_game/common/engine_stats.h \
+    ../../../brick_game/common/latency.h \
+    ../../../brick_game/common/random.h \
+    ../../../brick_game/common/replay.h \
+    ../../../brick_game/common/rewind.h \
+    ../../../brick_game/common/trace.h \
+    ../../../brick_game/common/spsc_queue.h \
+    ../../../brick_game/common/triple_buffer.h \
+    ../../../brick_game/common/zobrist.h \
+    ../../../brick_game/snake/autopilot.h \
+    ../../../brick_game/snake/board.h \
     ../../../brick_game/snake/snake.h
 
 # Default rules for deployment.
@@ -11,34 +11,113 @@ View::View(Controller& controller, QWidget* parent)
   menu->show();
   setFocusPolicy(Qt::StrongFocus);
   setFocus();
-  timer_ = new QTimer(this);
-  connect(timer_, &QTimer::timeout, this, &View::updateGame);
-  std::srand(std::time(0));
+  connect(controller_.getWorker(), &Worker::frameReady, this,
+          &View::updateGame);
+  initCache();
+}
+
+void View::initCache() {
+  for (int block = 0; block < BLOCK_TYPES; block++)
+    brushes_[block] = QBrush(getColorForBlock(block));
+  board_ = QImage(FIELD_WIDTH * cellSize + 1, FIELD_HEIGHT * cellSize + 1,
+                  QImage::Format_ARGB32_Premultiplied);
+  borders_ = QPixmap(size());
+  borders_.fill(Qt::transparent);
+  QPainter painter(&borders_);
+  painter.setPen(Qt::black);
+  // Отрисовка границ игрового поля
+  painter.drawRect((SNAKE_X)*cellSize, (SNAKE_Y - 1) * cellSize,
+                   FIELD_WIDTH * cellSize, FIELD_HEIGHT * cellSize);
+  // Отрисовка границ информации об игре
+  painter.drawRect((GAME_INFO_X - 1) * cellSize, (GAME_INFO_Y - 1) * cellSize,
+                   10 * cellSize, 5 * cellSize + 10);
+}
+
+void View::resetCache() {
+  board_.fill(Qt::transparent);
+  for (int i = 0; i < FIELD_HEIGHT; i++)
+    for (int j = 0; j < FIELD_WIDTH; j++) drawnField_[i][j] = -1;
+  drawnInfo_.clear();
+  drawnPause_ = false;
+}
+
+QRect View::boardRect() const {
+  return QRect((SNAKE_X)*cellSize, (SNAKE_Y - 1) * cellSize, board_.width(),
+               board_.height());
+}
+
+QRect View::infoRect() const {
+  return QRect((GAME_INFO_X - 1) * cellSize, (GAME_INFO_Y - 1) * cellSize,
+               10 * cellSize + 1, 5 * cellSize + 11);
+}
+
+QRect View::pauseRect() const {
+  return QRect(0, 0, 5 * cellSize, 2 * cellSize);
 }
 
 void View::startGame() {
   menu->hide();
   isGameRunning_ = true;
   setFocus();
-  controller_.getModel().resetGame();
-  timer_->start(100);
+  resetCache();
+  update();
+  controller_.startGame();
+}
+
+void View::updateBoard(const Frame& frame) {
+  QPainter painter(&board_);
+  painter.setPen(Qt::black);
+  for (int i = 0; i < FIELD_HEIGHT; i++)
+    for (int j = 0; j < FIELD_WIDTH; j++) {
+      int block = frame.field[i][j];
+      if (block == drawnField_[i][j]) continue;
+      drawnField_[i][j] = block;
+      QRect cell(j * cellSize, i * cellSize, cellSize, cellSize);
+      painter.fillRect(cell, brushes_[block < BLOCK_TYPES ? block : 0]);
+      painter.drawRect(cell);
+      update(cell.translated(boardRect().topLeft()).adjusted(0, 0, 1, 1));
+    }
+}
+
+void View::updateInterfaceExtras(const Frame& frame) {
+  QStringList lines = {QString("Score: %1").arg(frame.score),
+                       QString("High Score: %1").arg(frame.high_score),
+                       QString("Level: %1").arg(frame.level),
+                       QString("Speed: %1 %2")
+                           .arg(frame.speed)
+                           .arg(frame.boost ? "Boosted" : ""),
+                       QString("Length: %1 %2")
+                           .arg(frame.length)
+                           .arg(frame.autopilot ? "Auto" : "")};
+  if (lines != drawnInfo_) {
+    drawnInfo_ = lines;
+    update(infoRect());
+  }
+  if (static_cast<bool>(frame.pause) != drawnPause_) {
+    drawnPause_ = frame.pause;
+    update(pauseRect());
+  }
 }
 
 void View::updateGame() {
-  if (controller_.getModel().getPlaying() == s21::PLAYING) {
-    updateCurrentState();
-    update();
+  if (!isGameRunning_ || !controller_.getWorker()->takeFrame()) return;
+  const Frame& frame = controller_.getWorker()->getFrame();
+  frameGeneration_ = frame.generation;
+  if (frame.playing == s21::PLAYING) {
+    updateBoard(frame);
+    updateInterfaceExtras(frame);
   } else {
-    timer_->stop();
     isGameRunning_ = false;
-    controller_.getModel().resetGame();
     menu->show();
+    update();
   }
 }
 
 void View::keyPressEvent(QKeyEvent* event) {
   if (isGameRunning_) {
+    TRACE_BEGIN("handleUserInput");
     controller_.handleUserInput(event->key(), event->isAutoRepeat());
+    TRACE_END("handleUserInput");
   } else {
     if (event->key() == Qt::Key_Enter || event->key() == Qt::Key_Return) {
       startGame();
@@ -49,13 +128,17 @@ void View::keyPressEvent(QKeyEvent* event) {
 }
 
 void View::paintEvent(QPaintEvent* event) {
-  Q_UNUSED(event);
+  TRACE_BEGIN("paintEvent");
   QPainter painter(this);
   if (isGameRunning_) {
-    drawGame(painter);
-    drawInterfaceExtras(painter);
+    if (event->rect().intersects(boardRect())) drawGame(painter);
+    if (event->rect().intersects(infoRect()) ||
+        event->rect().intersects(pauseRect()))
+      drawInterfaceExtras(painter);
     drawBorders(painter);
+    recordFramePresented(frameGeneration_);
   }
+  TRACE_END("paintEvent");
 }
 
 QColor View::getColorForBlock(int block) {
@@ -78,52 +161,22 @@ QColor View::getColorForBlock(int block) {
 }
 
 void View::drawGame(QPainter& painter) {
-  for (int i = 0; i < FIELD_HEIGHT; i++) {
-    for (int j = 0; j < FIELD_WIDTH; j++) {
-      int block = controller_.getModel().getGameInfo().field[i][j];
-      QColor color = getColorForBlock(block);
-      painter.fillRect((SNAKE_X + j) * cellSize, (SNAKE_Y + i - 1) * cellSize,
-                       cellSize, cellSize, color);
-      painter.setPen(Qt::black);
-      painter.drawRect((SNAKE_X + j) * cellSize, (SNAKE_Y + i - 1) * cellSize,
-                       cellSize, cellSize);
-    }
-  }
+  painter.drawImage(boardRect().topLeft(), board_);
 }
 
 void View::drawInterfaceExtras(QPainter& painter) {
   painter.setPen(Qt::white);
-  painter.drawText(
-      (GAME_INFO_X)*cellSize, GAME_INFO_Y * cellSize,
-      QString("Score: %1").arg(controller_.getModel().getGameInfo().score));
-  painter.drawText((GAME_INFO_X)*cellSize, (GAME_INFO_Y + 1) * cellSize,
-                   QString("High Score: %1")
-                       .arg(controller_.getModel().getGameInfo().high_score));
-  painter.drawText(
-      (GAME_INFO_X)*cellSize, (GAME_INFO_Y + 2) * cellSize,
-      QString("Level: %1").arg(controller_.getModel().getGameInfo().level));
-  painter.drawText(
-      (GAME_INFO_X)*cellSize, (GAME_INFO_Y + 3) * cellSize,
-      QString("Speed: %1 %2")
-          .arg(controller_.getModel().getGameInfo().speed)
-          .arg(controller_.getModel().getBoost() ? "Boosted" : ""));
-  painter.drawText(
-      (GAME_INFO_X)*cellSize, (GAME_INFO_Y + 4) * cellSize,
-      QString("Length: %1").arg(controller_.getModel().getSnake().getLength()));
-
-  if (controller_.getModel().getGameInfo().pause) {
+  for (int i = 0; i < drawnInfo_.size(); i++)
+    painter.drawText((GAME_INFO_X)*cellSize, (GAME_INFO_Y + i) * cellSize,
+                     drawnInfo_[i]);
+
+  if (drawnPause_) {
     painter.drawText(20, 20, "PAUSE");
   }
 }
 
 void View::drawBorders(QPainter& painter) {
-  painter.setPen(Qt::black);
-  // Отрисовка границ игрового поля
-  painter.drawRect((SNAKE_X)*cellSize, (SNAKE_Y - 1) * cellSize,
-                   FIELD_WIDTH * cellSize, FIELD_HEIGHT * cellSize);
-  // Отрисовка границ информации об игре
-  painter.drawRect((GAME_INFO_X - 1) * cellSize, (GAME_INFO_Y - 1) * cellSize,
-                   10 * cellSize, 5 * cellSize + 10);
+  painter.drawPixmap(0, 0, borders_);
 }
 
 Menu::Menu(QWidget* parent) : QWidget(parent) {
@@ -164,6 +217,7 @@ Menu::Menu(QWidget* parent) : QWidget(parent) {
       "S                move down\n"
       "D                move right\n"
       "E                boost speed\n"
+      "P                autopilot\n"
       "SPACE       to pause\n"
       "ESCAPE     to finish",
       this);
@@ -1,8 +1,12 @@
 #ifndef SNAKE_QT_H
 #define SNAKE_QT_H
 
+#include <QImage>
 #include <QLabel>
+#include <QPaintEvent>
 #include <QPainter>
+#include <QPixmap>
+#include <QStringList>
 #include <QTimer>
 #include <QVBoxLayout>
 #include <QWidget>
@@ -16,6 +20,8 @@
 #define GAME_INFO_X SNAKE_X + 15
 #define GAME_INFO_Y SNAKE_Y
 
+#define BLOCK_TYPES 4
+
 namespace s21 {
 
 class Menu : public QWidget {
@@ -47,11 +53,29 @@ class View : public QWidget {
   void paintEvent(QPaintEvent* event) override;
 
  private:
+  void initCache();
+  void resetCache();
+  void updateBoard(const Frame& frame);
+  void updateInterfaceExtras(const Frame& frame);
+  QRect boardRect() const;
+  QRect infoRect() const;
+  QRect pauseRect() const;
+
   Menu* menu;
   Controller& controller_;
-  QTimer* timer_;
   bool isGameRunning_;
   int cellSize = 20;
+  // Версия состояния в последнем полученном снимке, для замера задержки
+  unsigned long frameGeneration_ = 0;
+
+  // Кэш отрисовки: поле перерисовывается в board_ только в изменившихся
+  // клетках, рамки рисуются один раз в borders_
+  QImage board_;
+  QPixmap borders_;
+  QBrush brushes_[BLOCK_TYPES];
+  int drawnField_[FIELD_HEIGHT][FIELD_WIDTH];
+  QStringList drawnInfo_;
+  bool drawnPause_;
 };
 
 }  // namespace s21
@@ -0,0 +1,94 @@
+#include "worker.h"
+
+using namespace s21;
+
+Worker::Worker(QObject* parent)
+    : QObject(parent), model_(s21::Game::getGame()) {
+  timer_ = new QTimer(this);
+  timer_->setSingleShot(true);
+  timer_->setTimerType(Qt::PreciseTimer);
+  connect(timer_, &QTimer::timeout, this, &Worker::updateGame);
+}
+
+void Worker::pushInput(UserAction_t action, bool hold) {
+  if (input_.push({action, hold, engineStatsNow()}))
+    QMetaObject::invokeMethod(this, &Worker::processInput,
+                              Qt::QueuedConnection);
+}
+
+bool Worker::takeFrame() { return frames_.update(); }
+
+void Worker::startGame() {
+  setTraceThreadName("engine");
+  model_.resetGame();
+  autopilot_.reset();
+  running_ = true;
+  updateGame();
+}
+
+void Worker::processInput() {
+  Input input;
+  bool processed = false;
+  while (input_.pop(input)) {
+    TRACE_BEGIN("userInput");
+    userInput(input.action, input.hold);
+    TRACE_END("userInput");
+    if (model_.getInputGeneration() > published_)
+      recordInputApplied(input.time, model_.getInputGeneration());
+    processed = true;
+  }
+  if (processed && running_) updateGame();
+}
+
+void Worker::updateGame() {
+  if (model_.getPlaying() == s21::PLAYING) updateCurrentState();
+  // Поворот автопилота ставится сразу после шага и применится на следующем
+  if (autopilotEnabled_) autopilot_.drive(model_);
+  publishFrame();
+  if (model_.getPlaying() != s21::PLAYING) {
+    running_ = false;
+    timer_->stop();
+    model_.resetGame();
+  } else {
+    armTimer();
+  }
+}
+
+void Worker::toggleAutopilot() {
+  autopilotEnabled_ = !autopilotEnabled_;
+  autopilot_.reset();
+  if (running_) updateGame();
+}
+
+/**
+ * Взвод таймера на момент следующего шага игры. Во время паузы таймер
+ * остановлен, его перезапускает ввод пользователя
+ */
+void Worker::armTimer() {
+  long timeout = getTickTimeout();
+  if (timeout < 0) {
+    timer_->stop();
+    return;
+  }
+  timer_->start(static_cast<int>((timeout + NANOSECONDS_PER_MILLISECOND - 1) /
+                                 NANOSECONDS_PER_MILLISECOND));
+}
+
+void Worker::publishFrame() {
+  Frame& frame = frames_.getBack();
+  GameInfo_t info = model_.getGameInfo();
+  for (int i = 0; i < FIELD_HEIGHT; i++)
+    for (int j = 0; j < FIELD_WIDTH; j++) frame.field[i][j] = info.field[i][j];
+  frame.score = info.score;
+  frame.high_score = info.high_score;
+  frame.level = info.level;
+  frame.speed = info.speed;
+  frame.pause = info.pause;
+  frame.boost = model_.getBoost();
+  frame.length = model_.getSnake().getLength();
+  frame.playing = model_.getPlaying();
+  frame.autopilot = autopilotEnabled_;
+  frame.generation = published_ = model_.getGeneration();
+  frames_.publish();
+  emit frameReady();
+}
@@ -0,0 +1,84 @@
+#ifndef WORKER_H
+#define WORKER_H
+
+#include <QObject>
+#include <QTimer>
+
+#include "../../../brick_game/common/latency.h"
+#include "../../../brick_game/common/spsc_queue.h"
+#include "../../../brick_game/common/triple_buffer.h"
+#include "../../../brick_game/snake/autopilot.h"
+#include "../../../brick_game/snake/snake.h"
+
+#define INPUT_QUEUE_SIZE 64
+#define NANOSECONDS_PER_MILLISECOND 1000000
+
+namespace s21 {
+
+/**
+ * Неизменяемый снимок состояния игры, который рисует графический поток
+ */
+struct Frame {
+  int field[FIELD_HEIGHT][FIELD_WIDTH];
+  int score;
+  int high_score;
+  int level;
+  int speed;
+  int pause;
+  bool boost;
+  size_t length;
+  char playing;
+  bool autopilot;
+  unsigned long generation;
+};
+
+/**
+ * Действие пользователя, переданное из графического потока
+ */
+struct Input {
+  UserAction_t action;
+  bool hold;
+  uint64_t time;
+};
+
+class Worker : public QObject {
+  Q_OBJECT
+
+ public:
+  explicit Worker(QObject* parent = nullptr);
+  void pushInput(UserAction_t action, bool hold);
+  bool takeFrame();
+
+  /**
+   * Получение последнего снимка, полученного через takeFrame()
+   *
+   * @return снимок состояния игры
+   */
+  const Frame& getFrame() const { return frames_.getFront(); }
+
+ public slots:
+  void startGame();
+  void processInput();
+  void updateGame();
+  void toggleAutopilot();
+
+ signals:
+  void frameReady();
+
+ private:
+  void publishFrame();
+  void armTimer();
+
+  Game& model_;
+  QTimer* timer_;
+  bool running_ = false;
+  Autopilot autopilot_;
+  bool autopilotEnabled_ = false;
+  unsigned long published_ = 0;
+  SpscQueue<Input, INPUT_QUEUE_SIZE> input_;
+  TripleBuffer<Frame> frames_;
+};
+
+}  // namespace s21
+
+#endif  // WORKER_H
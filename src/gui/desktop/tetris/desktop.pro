@@ -7,8 +7,6 @@ greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
 CONFIG += c++17
 
-DEFINES += DESKTOP_VERSION
-
 # You can make your code fail to compile if it uses deprecated APIs.
 # In order to do so, uncomment the following line.
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
@@ -16,10 +14,24 @@ DEFINES += DESKTOP_VERSION
 SOURCES += \
     main.cpp \
     tetris_qt.cpp \
+    ../../../brick_game/common/engine_stats.c \
+    ../../../brick_game/common/latency.c \
+    ../../../brick_game/common/replay.c \
+    ../../../brick_game/common/rewind.c \
+    ../../../brick_game/common/trace.c \
     ../../../brick_game/tetris/tetris.c
 
 HEADERS += \
     tetris_qt.h \
+    ../../../brick_game/common/engine_stats.h \
+    ../../../brick_game/common/latency.h \
+    ../../../brick_game/common/random.h \
+    ../../../brick_game/common/replay.h \
+    ../../../brick_game/common/rewind.h \
+    ../../../brick_game/common/trace.h \
+    ../../../brick_game/common/spsc_queue.h \
+    ../../../brick_game/common/triple_buffer.h \
+    ../../../brick_game/common/zobrist.h \
     ../../../brick_game/tetris/tetris.h
 
 # Default rules for deployment.
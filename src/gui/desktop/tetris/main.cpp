@@ -1,4 +1,6 @@
 #include <QApplication>
+#include <cstdio>
+#include <cstring>
 
 #include "tetris_qt.h"
 
@@ -6,7 +8,13 @@ using namespace s21;
 
 int main(int argc, char *argv[]) {
   QApplication app(argc, argv);
+  initTrace();
+  setTraceThreadName("gui");
   Tetris tetris;
   tetris.show();
-  return app.exec();
+  int status = app.exec();
+  for (int i = 1; i < argc; i++)
+    if (!std::strcmp(argv[i], LATENCY_FLAG))
+      printEngineStats(getLatencyStats(), stderr);
+  return status;
 }
@@ -11,59 +11,111 @@ Tetris::Tetris(QWidget *parent) : QWidget(parent) {
   gameIsRunning = false;
   setFocusPolicy(Qt::StrongFocus);
   setFocus();
+  initCache();
 }
 
-Tetris::~Tetris() { freeSingletones(); }
+void Tetris::initCache() {
+  for (int block = 0; block < BLOCK_TYPES; block++)
+    brushes[block] = QBrush(getColorForBlock(block));
+  board = QImage(FIELD_WIDTH * cellSize + 1, FIELD_HEIGHT * cellSize + 1,
+                 QImage::Format_ARGB32_Premultiplied);
+  nextFigureImage =
+      QImage(FIGURE_SIZE * cellSize + 1, FIGURE_SIZE * cellSize + 1,
+             QImage::Format_ARGB32_Premultiplied);
+  borders = QPixmap(size());
+  borders.fill(Qt::transparent);
+  QPainter painter(&borders);
+  painter.setPen(Qt::black);
+  // Отрисовка границ игрового поля
+  painter.drawRect((TETRIS_X)*cellSize, (TETRIS_Y)*cellSize,
+                   FIELD_WIDTH * cellSize, FIELD_HEIGHT * cellSize);
+  // Отрисовка границ информации об игре
+  painter.drawRect((GAME_INFO_X - 1) * cellSize, (GAME_INFO_Y)*cellSize,
+                   10 * cellSize, 5 * cellSize - 8);
+  // Отрисовка границ следующей фигуры
+  painter.drawRect((TETRIS_X + 17) * cellSize, (GAME_INFO_Y + 10) * cellSize,
+                   5 * cellSize, 5 * cellSize);
+  resetCache();
+}
+
+void Tetris::resetCache() {
+  board.fill(Qt::transparent);
+  nextFigureImage.fill(Qt::transparent);
+  for (int y = 0; y < FIELD_HEIGHT; ++y)
+    for (int x = 0; x < FIELD_WIDTH; ++x) drawnField[y][x] = -1;
+  for (int y = 0; y < FIGURE_SIZE; ++y)
+    for (int x = 0; x < FIGURE_SIZE; ++x) drawnNext[y][x] = -1;
+  drawnInfo.clear();
+  drawnPause = false;
+}
+
+QRect Tetris::boardRect() const {
+  return QRect((TETRIS_X)*cellSize, (TETRIS_Y)*cellSize, board.width(),
+               board.height());
+}
+
+QRect Tetris::nextFigureRect() const {
+  return QRect((18 + TETRIS_X) * cellSize, (GAME_INFO_Y + 11) * cellSize,
+               nextFigureImage.width(), nextFigureImage.height());
+}
+
+QRect Tetris::infoRect() const {
+  return QRect((GAME_INFO_X - 1) * cellSize, (GAME_INFO_Y)*cellSize,
+               10 * cellSize + 1, 5 * cellSize - 7);
+}
+
+QRect Tetris::pauseRect() const {
+  return QRect(0, 0, 5 * cellSize, 2 * cellSize);
+}
+
+Tetris::~Tetris() { Controller::getController(this)->stopWorker(); }
 
 void Tetris::startGame() {
   menu->hide();
   gameIsRunning = true;
   setFocus();
-  Controller::getController(this)->updateGame();
+  resetCache();
+  update();
+  Controller::getController(this)->startGame();
 }
 
 void Tetris::endGame() {
   gameIsRunning = false;
   menu->show();
+  update();
 }
 
 void Tetris::paintEvent(QPaintEvent *event) {
-  Q_UNUSED(event);
+  TRACE_BEGIN("paintEvent");
   if (gameIsRunning) {
     QPainter painter(this);
+    if (event->rect().intersects(boardRect())) drawGame(painter);
+    if (event->rect().intersects(nextFigureRect())) drawNextFigure(painter);
+    if (event->rect().intersects(infoRect()) ||
+        event->rect().intersects(pauseRect()))
+      drawInterfaceExtras(painter);
     drawBorders(painter);
-    drawGame(painter);
-    drawNextFigure(painter);
-    drawInterfaceExtras(painter);
+    recordFramePresented(frame.generation);
   }
+  TRACE_END("paintEvent");
 }
 
 void Tetris::keyPressEvent(QKeyEvent *event) {
+  TRACE_BEGIN("processUserInput");
   Controller::getController(this)->processUserInput(event->key(),
                                                     event->isAutoRepeat());
+  TRACE_END("processUserInput");
 }
 
 void Tetris::drawBorders(QPainter &painter) {
-  painter.setPen(Qt::black);
-  // Отрисовка границ игрового поля
-  painter.drawRect((TETRIS_X)*cellSize, (TETRIS_Y)*cellSize,
-                   FIELD_WIDTH * cellSize, FIELD_HEIGHT * cellSize);
-  // Отрисовка границ информации об игре
-  painter.drawRect((GAME_INFO_X - 1) * cellSize, (GAME_INFO_Y)*cellSize,
-                   10 * cellSize, 5 * cellSize - 8);
-  // Отрисовка границ следующей фигуры
-  painter.drawRect((TETRIS_X + 17) * cellSize, (GAME_INFO_Y + 10) * cellSize,
-                   5 * cellSize, 5 * cellSize);
+  painter.drawPixmap(0, 0, borders);
 }
 
-void Tetris::setGameInfo(GameInfo_t gi) {
-  gameInfo.field = gi.field;
-  gameInfo.next = gi.next;
-  gameInfo.score = gi.score;
-  gameInfo.high_score = gi.high_score;
-  gameInfo.level = gi.level;
-  gameInfo.speed = gi.speed;
-  gameInfo.pause = gi.pause;
+void Tetris::setFrame(const Frame &f) {
+  frame = f;
+  updateBoard();
+  updateNextFigure();
+  updateInterfaceExtras();
 }
 
 QColor Tetris::getColorForBlock(int block) {
@@ -87,53 +139,160 @@ QColor Tetris::getColorForBlock(int block) {
   }
 }
 
-void Tetris::drawGame(QPainter &painter) {
+void Tetris::updateBoard() {
+  QPainter painter(&board);
+  painter.setPen(Qt::black);
   for (int y = 0; y < FIELD_HEIGHT; ++y) {
     for (int x = 0; x < FIELD_WIDTH; ++x) {
-      int block = gameInfo.field[y][x];
-      painter.fillRect((TETRIS_X + x) * cellSize, (TETRIS_Y + y) * cellSize,
-                       cellSize, cellSize, getColorForBlock(block));
-      painter.setPen(Qt::black);
-      painter.drawRect((TETRIS_X + x) * cellSize, (TETRIS_Y + y) * cellSize,
-                       cellSize, cellSize);
+      int block = frame.field[y][x];
+      if (block == drawnField[y][x]) continue;
+      drawnField[y][x] = block;
+      QRect cell(x * cellSize, y * cellSize, cellSize, cellSize);
+      painter.fillRect(cell, brushes[block < BLOCK_TYPES ? block : 0]);
+      painter.drawRect(cell);
+      update(cell.translated(boardRect().topLeft()).adjusted(0, 0, 1, 1));
     }
   }
 }
 
-void Tetris::drawNextFigure(QPainter &painter) {
+void Tetris::updateNextFigure() {
+  QPainter painter(&nextFigureImage);
+  painter.setPen(Qt::black);
   for (int y = 0; y < FIGURE_SIZE; ++y) {
     for (int x = 0; x < FIGURE_SIZE; ++x) {
-      int block = gameInfo.next[y][x];
+      int block = frame.next[y][x];
+      if (block == drawnNext[y][x]) continue;
+      drawnNext[y][x] = block;
+      QRect cell(x * cellSize, y * cellSize, cellSize, cellSize);
+      painter.setCompositionMode(QPainter::CompositionMode_Source);
+      painter.fillRect(cell.adjusted(0, 0, 1, 1), Qt::transparent);
+      painter.setCompositionMode(QPainter::CompositionMode_SourceOver);
       if (block) {
-        painter.fillRect((18 + TETRIS_X + x) * cellSize,
-                         (GAME_INFO_Y + 11 + y) * cellSize, cellSize, cellSize,
-                         getColorForBlock(block));
-        painter.drawRect((18 + TETRIS_X + x) * cellSize,
-                         (GAME_INFO_Y + 11 + y) * cellSize, cellSize, cellSize);
+        painter.fillRect(cell, brushes[block < BLOCK_TYPES ? block : 0]);
+        painter.drawRect(cell);
       }
+      update(cell.translated(nextFigureRect().topLeft()).adjusted(0, 0, 1, 1));
     }
   }
 }
 
+void Tetris::updateInterfaceExtras() {
+  QStringList lines = {QString("Score: %1").arg(frame.score),
+                       QString("High Score: %1").arg(frame.high_score),
+                       QString("Level: %1").arg(frame.level),
+                       QString("Speed: %1").arg(frame.speed)};
+  if (lines != drawnInfo) {
+    drawnInfo = lines;
+    update(infoRect());
+  }
+  if (static_cast<bool>(frame.pause) != drawnPause) {
+    drawnPause = frame.pause;
+    update(pauseRect());
+  }
+}
+
+void Tetris::drawGame(QPainter &painter) {
+  painter.drawImage(boardRect().topLeft(), board);
+}
+
+void Tetris::drawNextFigure(QPainter &painter) {
+  painter.drawImage(nextFigureRect().topLeft(), nextFigureImage);
+}
+
 void Tetris::drawInterfaceExtras(QPainter &painter) {
   QFont font = painter.font();
   font.setPointSize(14);
   painter.setFont(font);
   painter.setPen(Qt::white);
-  painter.drawText((GAME_INFO_X)*cellSize, (GAME_INFO_Y + 1) * cellSize,
-                   QString("Score: %1").arg(getGame()->score));
-  painter.drawText((GAME_INFO_X)*cellSize, (GAME_INFO_Y + 2) * cellSize,
-                   QString("High Score: %1").arg(getGame()->high_score));
-  painter.drawText((GAME_INFO_X)*cellSize, (GAME_INFO_Y + 3) * cellSize,
-                   QString("Level: %1").arg(gameInfo.level));
-  painter.drawText((GAME_INFO_X)*cellSize, (GAME_INFO_Y + 4) * cellSize,
-                   QString("Speed: %1").arg(gameInfo.speed));
-
-  if (getGameInfo()->pause) {
-    painter.drawText(20, 20, "PAUSE");
+  for (int i = 0; i < drawnInfo.size(); i++)
+    painter.drawText((GAME_INFO_X)*cellSize, (GAME_INFO_Y + 1 + i) * cellSize,
+                     drawnInfo[i]);
+
+  if (drawnPause) painter.drawText(20, 20, "PAUSE");
+}
+
+Worker::Worker(QObject *parent) : QObject(parent) {
+  timer = new QTimer(this);
+  timer->setSingleShot(true);
+  timer->setTimerType(Qt::PreciseTimer);
+  connect(timer, &QTimer::timeout, this, &Worker::updateGame);
+}
+
+void Worker::pushInput(UserAction_t action, bool hold) {
+  if (input.push({action, hold, engineStatsNow()}))
+    QMetaObject::invokeMethod(this, &Worker::processInput,
+                              Qt::QueuedConnection);
+}
+
+bool Worker::takeFrame() { return frames.update(); }
+
+void Worker::startGame() {
+  setTraceThreadName("engine");
+  running = true;
+  updateGame();
+}
+
+void Worker::processInput() {
+  Input in;
+  bool processed = false;
+  while (input.pop(in)) {
+    TRACE_BEGIN("userInput");
+    userInput(in.action, in.hold);
+    TRACE_END("userInput");
+    if (*getGeneration() > published)
+      recordInputApplied(in.time, *getGeneration());
+    processed = true;
+  }
+  if (processed && running) updateGame();
+}
+
+void Worker::updateGame() {
+  if (getGame()->playing) updateCurrentState();
+  publishFrame();
+  if (!getGame()->playing) {
+    running = false;
+    timer->stop();
+    resetSingletones();
   } else {
-    painter.drawText(20, 20, "     ");
+    armTimer();
+  }
+}
+
+// Синглтоны движка свои у каждого потока, поэтому освобождаются в игровом
+// потоке перед его остановкой
+void Worker::freeGame() {
+  timer->stop();
+  freeSingletones();
+}
+
+// Таймер взводится на момент следующего падения фигуры, во время паузы
+// он остановлен до следующего ввода
+void Worker::armTimer() {
+  long timeout = getTickTimeout();
+  if (timeout < 0) {
+    timer->stop();
+    return;
   }
+  timer->start(static_cast<int>((timeout + NANOSECONDS_PER_MILLISECOND - 1) /
+                                NANOSECONDS_PER_MILLISECOND));
+}
+
+void Worker::publishFrame() {
+  Frame &frame = frames.getBack();
+  GameInfo_t *info = getGameInfo();
+  for (int y = 0; y < FIELD_HEIGHT; y++)
+    for (int x = 0; x < FIELD_WIDTH; x++) frame.field[y][x] = info->field[y][x];
+  for (int y = 0; y < FIGURE_SIZE; y++)
+    for (int x = 0; x < FIGURE_SIZE; x++) frame.next[y][x] = info->next[y][x];
+  frame.score = getGame()->score;
+  frame.high_score = getGame()->high_score;
+  frame.level = info->level;
+  frame.speed = info->speed;
+  frame.pause = info->pause;
+  frame.playing = getGame()->playing;
+  frame.generation = published = *getGeneration();
+  frames.publish();
+  emit frameReady();
 }
 
 Controller *Controller::getController(Tetris *t) {
@@ -146,10 +305,7 @@ void Controller::processUserInput(int key, bool hold) {
     switch (key) {
       case Qt::Key_Enter:
       case Qt::Key_Return:
-        if (!tetris->gameIsRunning) {
-          timer->start(1);
-          tetris->startGame();
-        }
+        tetris->startGame();
         break;
       case Qt::Key_Escape:
         tetris->close();
@@ -158,50 +314,56 @@ void Controller::processUserInput(int key, bool hold) {
   } else {
     switch (key) {
       case Qt::Key_D:
-        userInput(Right, hold);
+        worker->pushInput(Right, hold);
         break;
       case Qt::Key_A:
-        userInput(Left, hold);
+        worker->pushInput(Left, hold);
         break;
       case Qt::Key_S:
-        userInput(Down, hold);
+        worker->pushInput(Down, hold);
         break;
       case Qt::Key_W:
-        userInput(Action, hold);
+        worker->pushInput(Action, hold);
         break;
       case Qt::Key_Space:
-        userInput(Pause, hold);
+        worker->pushInput(Pause, hold);
         break;
       case Qt::Key_Escape:
-        userInput(Terminate, hold);
-        if (timer->isActive()) {
-          updateGame();
-          timer->stop();
-        }
+        worker->pushInput(Terminate, hold);
         break;
     }
   }
 }
 
-void Controller::resetTetris() { resetSingletones(); }
+void Controller::startGame() {
+  QMetaObject::invokeMethod(worker, &Worker::startGame, Qt::QueuedConnection);
+}
+
+void Controller::stopWorker() {
+  if (!thread->isRunning()) return;
+  QMetaObject::invokeMethod(worker, &Worker::freeGame,
+                            Qt::BlockingQueuedConnection);
+  thread->quit();
+  thread->wait();
+}
 
 void Controller::updateGame() {
-  GameInfo_t gameInfo = updateCurrentState();
-  tetris->setGameInfo(gameInfo);
-  tetris->update();
-  if (!getGame()->playing) {
-    timer->stop();
-    tetris->endGame();
-    resetTetris();
-  }
+  if (!worker->takeFrame()) return;
+  const Frame &frame = worker->getFrame();
+  tetris->setFrame(frame);
+  if (!frame.playing) tetris->endGame();
 }
 
 Controller::Controller(Tetris *t) : tetris(t) {
-  timer = new QTimer(this);
-  connect(timer, &QTimer::timeout, this, &Controller::updateGame);
+  thread = new QThread(this);
+  worker = new Worker;
+  worker->moveToThread(thread);
+  connect(thread, &QThread::finished, worker, &QObject::deleteLater);
+  connect(worker, &Worker::frameReady, this, &Controller::updateGame);
+  thread->start();
 }
 
-Controller::~Controller() { delete timer; }
+Controller::~Controller() { stopWorker(); }
 
 Menu::Menu(QWidget *parent) : QWidget(parent) {
   QVBoxLayout *layout = new QVBoxLayout(this);
@@ -1,13 +1,22 @@
 #ifndef TETRIS_QT_H
 #define TETRIS_QT_H
 
+#include <QImage>
 #include <QKeyEvent>
 #include <QLabel>
+#include <QPaintEvent>
 #include <QPainter>
+#include <QPixmap>
+#include <QStringList>
+#include <QThread>
 #include <QTimer>
 #include <QVBoxLayout>
 #include <QWidget>
 
+#include "../../../brick_game/common/latency.h"
+#include "../../../brick_game/common/spsc_queue.h"
+#include "../../../brick_game/common/triple_buffer.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -22,8 +31,32 @@ extern "C" {
 #define GAME_INFO_X TETRIS_X + 15
 #define GAME_INFO_Y TETRIS_Y
 
+#define BLOCK_TYPES 8
+#define INPUT_QUEUE_SIZE 64
+#define NANOSECONDS_PER_MILLISECOND 1000000
+
 namespace s21 {
 
+// Неизменяемый снимок состояния игры, который рисует графический поток
+struct Frame {
+  int field[FIELD_HEIGHT][FIELD_WIDTH];
+  int next[FIGURE_SIZE][FIGURE_SIZE];
+  int score;
+  int high_score;
+  int level;
+  int speed;
+  int pause;
+  char playing;
+  unsigned long generation;
+};
+
+// Действие пользователя, переданное из графического потока
+struct Input {
+  UserAction_t action;
+  bool hold;
+  uint64_t time;
+};
+
 class Menu : public QWidget {
   Q_OBJECT
 
@@ -50,22 +83,74 @@ class Tetris : public QWidget {
  private:
   Menu *menu;
   bool gameIsRunning;
-  GameInfo_t gameInfo;
+  Frame frame;
   int cellSize = 20;
 
   void startGame();
   void endGame();
 
   void drawBorders(QPainter &painter);
-  void setGameInfo(GameInfo_t gi);
+  void setFrame(const Frame &f);
   QColor getColorForBlock(int block);
   void drawGame(QPainter &painter);
   void drawNextFigure(QPainter &painter);
   void drawInterfaceExtras(QPainter &painter);
 
+  void initCache();
+  void resetCache();
+  void updateBoard();
+  void updateNextFigure();
+  void updateInterfaceExtras();
+  QRect boardRect() const;
+  QRect nextFigureRect() const;
+  QRect infoRect() const;
+  QRect pauseRect() const;
+
+  // Кэш отрисовки: поле и следующая фигура перерисовываются только в
+  // изменившихся клетках, рамки рисуются один раз в borders
+  QImage board;
+  QImage nextFigureImage;
+  QPixmap borders;
+  QBrush brushes[BLOCK_TYPES];
+  int drawnField[FIELD_HEIGHT][FIELD_WIDTH];
+  int drawnNext[FIGURE_SIZE][FIGURE_SIZE];
+  QStringList drawnInfo;
+  bool drawnPause;
+
   friend class Controller;
 };
 
+// Игровая логика выполняется в отдельном потоке: ввод поступает через
+// очередь без блокировок, готовые кадры публикуются через тройной буфер
+class Worker : public QObject {
+  Q_OBJECT
+
+ public:
+  explicit Worker(QObject *parent = nullptr);
+  void pushInput(UserAction_t action, bool hold);
+  bool takeFrame();
+  const Frame &getFrame() const { return frames.getFront(); }
+
+ public slots:
+  void startGame();
+  void processInput();
+  void updateGame();
+  void freeGame();
+
+ signals:
+  void frameReady();
+
+ private:
+  void publishFrame();
+  void armTimer();
+
+  QTimer *timer;
+  bool running = false;
+  unsigned long published = 0;
+  SpscQueue<Input, INPUT_QUEUE_SIZE> input;
+  TripleBuffer<Frame> frames;
+};
+
 class Controller : public QObject {
   Q_OBJECT
 
@@ -80,7 +165,8 @@ class Controller : public QObject {
   // экземпляру контроллера
   static Controller *getController(Tetris *t);
   void processUserInput(int key, bool hold);
-  void resetTetris();
+  void startGame();
+  void stopWorker();
 
  public slots:
   void updateGame();
@@ -90,7 +176,8 @@ class Controller : public QObject {
   ~Controller();
 
   Tetris *tetris;
-  QTimer *timer;
+  QThread *thread;
+  Worker *worker;
 };
 }  // namespace s21
 #endif  // TETRIS_QT_H
@@ -0,0 +1,99 @@
+#ifndef PROTOCOL_H
+#define PROTOCOL_H
+
+#include <stdint.h>
+
+#include "../brick_game/library_specification.h"
+
+#define SESSION_SOCKET_PATH "brick_game.sock"
+
+// Поле у обеих игр одного размера, клетка кадра - номер y * ширина + x
+#define SESSION_WIDTH 10
+#define SESSION_HEIGHT 20
+#define SESSION_CELLS (SESSION_WIDTH * SESSION_HEIGHT)
+#define SESSION_NEXT_SIZE 5
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum { SESSION_TETRIS, SESSION_SNAKE } SessionGame_t;
+
+typedef enum {
+  SESSION_HELLO = 1,
+  SESSION_INPUT,
+  SESSION_FRAME
+} SessionMessage_t;
+
+/**
+ * Флаги кадра: опорный кадр передает все непустые клетки, остальные -
+ * только изменившиеся с прошлого кадра
+ */
+enum SESSION_FLAGS { SESSION_KEYFRAME = 1, SESSION_PAUSED = 2 };
+
+// Состояние партии, значения совпадают с GAME_STATE обоих движков
+enum SESSION_STATE { SESSION_GAMEOVER, SESSION_PLAYING, SESSION_WIN };
+
+/**
+ * Сообщение клиента фиксированного размера. SESSION_HELLO начинает партию
+ * игры game с зерном seed, SESSION_INPUT передает действие action
+ */
+typedef struct SessionRequest {
+  uint8_t type;
+  uint8_t game;
+  uint8_t action;
+  uint8_t reserved;
+  uint32_t seed;
+} SessionRequest;
+
+/**
+ * Заголовок кадра сервера. За ним следуют changes пар SessionCell.
+ * Следующая фигура - маска квадрата SESSION_NEXT_SIZE по строкам, бит
+ * y * SESSION_NEXT_SIZE + x
+ */
+typedef struct SessionFrameHeader {
+  uint8_t type;
+  uint8_t flags;
+  uint8_t changes;
+  uint8_t state;
+  uint32_t tick;
+  int32_t score;
+  int32_t highScore;
+  uint8_t level;
+  uint8_t speed;
+  uint16_t reserved;
+  uint32_t next;
+} SessionFrameHeader;
+
+/**
+ * Новое значение клетки поля
+ */
+typedef struct SessionCell {
+  uint8_t index;
+  uint8_t value;
+} SessionCell;
+
+#define SESSION_MAX_FRAME \
+  (sizeof(SessionFrameHeader) + SESSION_CELLS * sizeof(SessionCell))
+
+/**
+ * Кадр целиком: то, что движок сессии отрисовывает на сервере и что клиент
+ * собирает из опорного кадра и изменений
+ */
+typedef struct SessionView {
+  uint8_t cells[SESSION_CELLS];
+  uint32_t next;
+  uint32_t tick;
+  int32_t score;
+  int32_t highScore;
+  uint8_t level;
+  uint8_t speed;
+  uint8_t state;
+  uint8_t paused;
+} SessionView;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // PROTOCOL_H
@@ -0,0 +1,40 @@
+#ifndef SESSION_H
+#define SESSION_H
+
+#include <stddef.h>
+
+#include "protocol.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Движок сессии: партия хранится в памяти размером stateSize, которую
+ * выделяет сервер, а функции движка работают только с ней. Так партии
+ * обеих игр ведутся в одном процессе на любом потоке пула, и заголовки
+ * движков не встречаются в одной единице трансляции
+ */
+typedef struct SessionEngine {
+  size_t stateSize;
+  // Новая партия с зерном
+  void (*start)(void* state, uint32_t seed);
+  // Новая партия с продолжением генератора прошлой
+  void (*restart)(void* state);
+  // Действие игрока, кроме Start и Pause, которые ведет сервер
+  void (*input)(void* state, UserAction_t action);
+  // Шаг игры по сроку такта
+  void (*tick)(void* state);
+  // Длина такта в наносекундах
+  long (*interval)(const void* state);
+  void (*render)(const void* state, SessionView* view);
+} SessionEngine;
+
+const SessionEngine* getTetrisSessionEngine(void);
+const SessionEngine* getSnakeSessionEngine(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // SESSION_H
@@ -0,0 +1,151 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include "session_client.h"
+
+#include <errno.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+/**
+ * Отправка сообщения целиком
+ *
+ * @return 0 - сообщение отправлено, -1 - соединение разорвано
+ */
+static int sendRequest(SessionClient* client, const SessionRequest* request) {
+  const unsigned char* data = (const unsigned char*)request;
+  size_t sent = 0;
+  while (sent < sizeof(*request)) {
+    ssize_t size =
+        send(client->fd, data + sent, sizeof(*request) - sent, MSG_NOSIGNAL);
+    if (size < 0 && errno == EINTR) continue;
+    if (size <= 0) return -1;
+    sent += size;
+  }
+  return 0;
+}
+
+/**
+ * Подключение к серверу и начало партии
+ *
+ * @param client соединение
+ * @param path путь к сокету сервера
+ * @param game игра
+ * @param seed зерно генератора партии
+ *
+ * @return 0 - партия начата, -1 - сервер недоступен
+ */
+int connectSession(SessionClient* client, const char* path,
+                   SessionGame_t game, uint32_t seed) {
+  memset(client, 0, sizeof(*client));
+  struct sockaddr_un address = {0};
+  address.sun_family = AF_UNIX;
+  size_t length = strlen(path);
+  if (length >= sizeof(address.sun_path)) return -1;
+  memcpy(address.sun_path, path, length);
+  client->fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (client->fd < 0) return -1;
+  SessionRequest hello = {SESSION_HELLO, game, 0, 0, seed};
+  if (connect(client->fd, (struct sockaddr*)&address, sizeof(address)) ||
+      sendRequest(client, &hello)) {
+    closeSession(client);
+    return -1;
+  }
+  return 0;
+}
+
+/**
+ * Отправка действия игрока
+ *
+ * @return 0 - действие отправлено, -1 - соединение разорвано
+ */
+int sendSessionInput(SessionClient* client, UserAction_t action) {
+  SessionRequest request = {SESSION_INPUT, 0, action, 0, 0};
+  return sendRequest(client, &request);
+}
+
+/**
+ * Применение первого полного кадра из буфера к view
+ *
+ * @return 1 - кадр применен, 0 - кадр получен не целиком
+ */
+static int applyFrame(SessionClient* client) {
+  SessionFrameHeader header;
+  if (client->size < sizeof(header)) return 0;
+  memcpy(&header, client->buffer, sizeof(header));
+  size_t size = sizeof(header) + header.changes * sizeof(SessionCell);
+  if (client->size < size) return 0;
+  SessionView* view = &client->view;
+  if (header.flags & SESSION_KEYFRAME) memset(view->cells, 0, SESSION_CELLS);
+  const SessionCell* cells =
+      (const SessionCell*)(client->buffer + sizeof(header));
+  for (int i = 0; i < header.changes; i++)
+    if (cells[i].index < SESSION_CELLS)
+      view->cells[cells[i].index] = cells[i].value;
+  view->next = header.next;
+  view->tick = header.tick;
+  view->score = header.score;
+  view->highScore = header.highScore;
+  view->level = header.level;
+  view->speed = header.speed;
+  view->state = header.state;
+  view->paused = (header.flags & SESSION_PAUSED) != 0;
+  client->size -= size;
+  memmove(client->buffer, client->buffer + size, client->size);
+  return 1;
+}
+
+/**
+ * Ожидание следующего кадра
+ *
+ * @param client соединение
+ * @param timeoutMs наибольшее ожидание в миллисекундах, -1 - без предела
+ *
+ * @return 1 - кадр применен к view, 0 - кадра не было, -1 - сервер закрыл
+ * соединение
+ */
+int receiveSessionFrame(SessionClient* client, int timeoutMs) {
+  while (!applyFrame(client)) {
+    struct pollfd event = {client->fd, POLLIN, 0};
+    int ready = poll(&event, 1, timeoutMs);
+    if (ready < 0 && errno == EINTR) continue;
+    if (ready < 0) return -1;
+    if (!ready) return 0;
+    ssize_t size = recv(client->fd, client->buffer + client->size,
+                        sizeof(client->buffer) - client->size, 0);
+    if (size < 0 && errno == EINTR) continue;
+    if (size <= 0) return -1;
+    client->size += size;
+  }
+  return 1;
+}
+
+/**
+ * Закрытие соединения; партия на сервере заканчивается
+ */
+void closeSession(SessionClient* client) {
+  if (client->fd >= 0) close(client->fd);
+  client->fd = -1;
+}
+
+/**
+ * Копирование кадра в GameInfo_t фронтенда. Поля field и next выделяет
+ * фронтенд, next может отсутствовать
+ */
+void copySessionInfo(const SessionView* view, GameInfo_t* info) {
+  for (int y = 0; y < SESSION_HEIGHT; y++)
+    for (int x = 0; x < SESSION_WIDTH; x++)
+      info->field[y][x] = view->cells[y * SESSION_WIDTH + x];
+  if (info->next)
+    for (int y = 0; y < SESSION_NEXT_SIZE; y++)
+      for (int x = 0; x < SESSION_NEXT_SIZE; x++)
+        info->next[y][x] = (view->next >> (y * SESSION_NEXT_SIZE + x)) & 1;
+  info->score = view->score;
+  info->high_score = view->highScore;
+  info->level = view->level;
+  info->speed = view->speed;
+  info->pause = view->paused;
+}
@@ -0,0 +1,35 @@
+#ifndef SESSION_CLIENT_H
+#define SESSION_CLIENT_H
+
+#include <stddef.h>
+
+#include "protocol.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Соединение тонкого клиента с сервером партий. Кадр собирается в view из
+ * опорного кадра и изменений; фронтенды CLI и Qt получают его через
+ * copySessionInfo() в привычном GameInfo_t
+ */
+typedef struct SessionClient {
+  int fd;
+  SessionView view;
+  unsigned char buffer[SESSION_MAX_FRAME * 2];
+  size_t size;
+} SessionClient;
+
+int connectSession(SessionClient* client, const char* path,
+                   SessionGame_t game, uint32_t seed);
+int sendSessionInput(SessionClient* client, UserAction_t action);
+int receiveSessionFrame(SessionClient* client, int timeoutMs);
+void closeSession(SessionClient* client);
+void copySessionInfo(const SessionView* view, GameInfo_t* info);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // SESSION_CLIENT_H
@@ -0,0 +1,455 @@
+#include "session_server.h"
+
+#include <errno.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+
+using namespace s21;
+
+namespace {
+
+/**
+ * Совпадение всего, кроме клеток, в двух кадрах
+ */
+bool sameStatus(const SessionView& a, const SessionView& b) {
+  return a.next == b.next && a.tick == b.tick && a.score == b.score &&
+         a.highScore == b.highScore && a.level == b.level &&
+         a.speed == b.speed && a.state == b.state && a.paused == b.paused;
+}
+
+/**
+ * Наибольший размер партии среди движков: память сессии выделяется при
+ * подключении и подходит для любой игры
+ */
+size_t stateSize() {
+  return std::max(getTetrisSessionEngine()->stateSize,
+                  getSnakeSessionEngine()->stateSize);
+}
+
+}  // namespace
+
+/**
+ * Создание сервера и запуск потоков пула
+ *
+ * @param path путь к сокету
+ * @param threads количество потоков пула, 0 - один поток
+ */
+SessionServer::SessionServer(const std::string& path, unsigned int threads)
+    : path_(path),
+      listen_(-1),
+      epoll_(-1),
+      stopEvent_(-1),
+      stop_(false),
+      sessions_(0),
+      missed_(0),
+      throttles_(0) {
+  for (unsigned int i = 0; i < (threads ? threads : 1); i++)
+    workers_.emplace_back(new Worker());
+  for (std::unique_ptr<Worker>& worker : workers_)
+    worker->thread = std::thread(&SessionServer::loop, this, std::ref(*worker));
+}
+
+/**
+ * Остановка потоков пула, закрытие соединений и удаление сокета
+ */
+SessionServer::~SessionServer() {
+  for (std::unique_ptr<Worker>& worker : workers_) {
+    {
+      std::lock_guard<std::mutex> lock(worker->mutex);
+      stop_ = true;
+    }
+    worker->wake.notify_one();
+  }
+  for (std::unique_ptr<Worker>& worker : workers_) {
+    worker->thread.join();
+    for (std::unique_ptr<Session>& session : worker->incoming)
+      ::close(session->fd);
+    for (std::unique_ptr<Session>& session : worker->sessions)
+      ::close(session->fd);
+  }
+  if (stopEvent_ >= 0) ::close(stopEvent_);
+  if (epoll_ >= 0) ::close(epoll_);
+  if (listen_ >= 0) {
+    ::close(listen_);
+    ::unlink(path_.c_str());
+  }
+}
+
+/**
+ * Создание сокета и очереди событий. Оставшийся от прошлого запуска файл
+ * сокета удаляется
+ *
+ * @return true - сервер готов к run()
+ * @return false - сокет не удалось создать
+ */
+bool SessionServer::open() {
+  sockaddr_un address = {};
+  address.sun_family = AF_UNIX;
+  if (path_.size() >= sizeof(address.sun_path)) return false;
+  std::memcpy(address.sun_path, path_.c_str(), path_.size());
+  ::unlink(path_.c_str());
+  listen_ = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  if (listen_ < 0) return false;
+  if (::bind(listen_, reinterpret_cast<sockaddr*>(&address),
+             sizeof(address)) ||
+      ::listen(listen_, SOMAXCONN)) {
+    ::close(listen_);
+    listen_ = -1;
+    return false;
+  }
+  epoll_ = epoll_create1(EPOLL_CLOEXEC);
+  stopEvent_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (epoll_ < 0 || stopEvent_ < 0) return false;
+  epoll_event event = {};
+  event.events = EPOLLIN;
+  event.data.fd = listen_;
+  if (epoll_ctl(epoll_, EPOLL_CTL_ADD, listen_, &event)) return false;
+  event.data.fd = stopEvent_;
+  return !epoll_ctl(epoll_, EPOLL_CTL_ADD, stopEvent_, &event);
+}
+
+/**
+ * Цикл событий главного потока до вызова stop()
+ */
+void SessionServer::run() {
+  epoll_event events[SESSION_MAX_EVENTS];
+  bool running = true;
+  while (running) {
+    int count = epoll_wait(epoll_, events, SESSION_MAX_EVENTS, -1);
+    if (count < 0 && errno != EINTR) break;
+    for (int i = 0; i < count; i++) {
+      int fd = events[i].data.fd;
+      if (fd == stopEvent_)
+        running = false;
+      else if (fd == listen_)
+        accept();
+      else
+        receive(fd);
+    }
+  }
+}
+
+/**
+ * Остановка цикла событий. Можно вызывать из другого потока и из
+ * обработчика сигнала
+ */
+void SessionServer::stop() {
+  uint64_t one = 1;
+  if (::write(stopEvent_, &one, sizeof(one)) < 0) return;
+}
+
+/**
+ * Прием всех ожидающих соединений. Сессия достается наименее занятому
+ * потоку пула
+ */
+void SessionServer::accept() {
+  while (true) {
+    int fd = accept4(listen_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+    if (fd < 0) {
+      if (errno == EINTR) continue;
+      return;
+    }
+    epoll_event event = {};
+    event.events = EPOLLIN | EPOLLRDHUP;
+    event.data.fd = fd;
+    if (epoll_ctl(epoll_, EPOLL_CTL_ADD, fd, &event)) {
+      ::close(fd);
+      continue;
+    }
+    std::unique_ptr<Session> session(new Session());
+    session->fd = fd;
+    session->state.reset(new unsigned char[stateSize()]);
+    unsigned int index = 0;
+    for (unsigned int i = 1; i < workers_.size(); i++)
+      if (workers_[i]->load < workers_[index]->load) index = i;
+    Worker& worker = *workers_[index];
+    worker.load++;
+    clients_[fd] = {session.get(), index};
+    sessions_++;
+    {
+      std::lock_guard<std::mutex> lock(worker.mutex);
+      worker.incoming.push_back(std::move(session));
+      worker.signaled = true;
+    }
+    worker.wake.notify_one();
+  }
+}
+
+/**
+ * Чтение сообщений клиента в очередь сессии. Читается не больше, чем
+ * помещается в очередь; если она заполнена, чтение останавливается до
+ * разбора очереди потоком пула. Конец потока или ошибка закрывают сессию
+ *
+ * @param fd дескриптор клиента
+ */
+void SessionServer::receive(int fd) {
+  auto client = clients_.find(fd);
+  if (client == clients_.end()) return;
+  Session& session = *client->second.first;
+  Worker& worker = *workers_[client->second.second];
+  if (session.throttled.load(std::memory_order_acquire)) return;
+  unsigned char buffer[SESSION_RECEIVE_SIZE];
+  while (true) {
+    size_t slots = SESSION_INPUT_QUEUE - session.requests.size();
+    if (!slots) {
+      throttle(fd, session);
+      break;
+    }
+    size_t room = slots * sizeof(SessionRequest) - session.partialSize;
+    ssize_t size = ::recv(fd, buffer, std::min(sizeof(buffer), room), 0);
+    if (size < 0 && errno == EINTR) continue;
+    if (size < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+    if (size <= 0) {
+      drop(fd);
+      return;
+    }
+    for (ssize_t i = 0; i < size; i++) {
+      session.partial[session.partialSize++] = buffer[i];
+      if (session.partialSize < sizeof(SessionRequest)) continue;
+      SessionRequest request;
+      std::memcpy(&request, session.partial, sizeof(request));
+      // Место в очереди обеспечено размером чтения
+      session.requests.push(request);
+      session.partialSize = 0;
+    }
+  }
+  notify(worker);
+}
+
+/**
+ * Отключение клиента. Дескриптор закрывает поток пула, когда увидит флаг,
+ * поэтому номер дескриптора не достанется новому клиенту раньше времени
+ *
+ * @param fd дескриптор клиента
+ */
+void SessionServer::drop(int fd) {
+  auto client = clients_.find(fd);
+  Session* session = client->second.first;
+  Worker& worker = *workers_[client->second.second];
+  epoll_ctl(epoll_, EPOLL_CTL_DEL, fd, nullptr);
+  clients_.erase(client);
+  worker.load--;
+  sessions_--;
+  session->closed.store(true, std::memory_order_release);
+  notify(worker);
+}
+
+/**
+ * Остановка чтения клиента с заполненной очередью. Флаг ставится после
+ * снятия EPOLLIN, а поток пула будится следом, поэтому он обязательно
+ * увидит флаг после разбора очереди и вернет чтение
+ */
+void SessionServer::throttle(int fd, Session& session) {
+  epoll_event event = {};
+  event.data.fd = fd;
+  epoll_ctl(epoll_, EPOLL_CTL_MOD, fd, &event);
+  session.throttled.store(true, std::memory_order_release);
+  throttles_++;
+}
+
+/**
+ * Возврат чтения клиента после разбора очереди. Вызывается потоком пула;
+ * если клиент уже отключен, дескриптор снят с epoll и вызов ничего не
+ * меняет
+ */
+void SessionServer::resume(Session& session) {
+  epoll_event event = {};
+  event.events = EPOLLIN | EPOLLRDHUP;
+  event.data.fd = session.fd;
+  epoll_ctl(epoll_, EPOLL_CTL_MOD, session.fd, &event);
+}
+
+/**
+ * Пробуждение потока пула
+ */
+void SessionServer::notify(Worker& worker) {
+  {
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    worker.signaled = true;
+  }
+  worker.wake.notify_one();
+}
+
+/**
+ * Цикл потока пула: сон до ближайшего срока такта его сессий или до
+ * сообщения, затем обход сессий
+ */
+void SessionServer::loop(Worker& worker) {
+  Clock::time_point wakeAt = Clock::time_point::max();
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(worker.mutex);
+      auto ready = [&] { return worker.signaled || stop_; };
+      if (wakeAt == Clock::time_point::max())
+        worker.wake.wait(lock, ready);
+      else
+        worker.wake.wait_until(lock, wakeAt, ready);
+      if (stop_) return;
+      worker.signaled = false;
+      for (std::unique_ptr<Session>& session : worker.incoming)
+        worker.sessions.push_back(std::move(session));
+      worker.incoming.clear();
+    }
+    Clock::time_point now = Clock::now();
+    wakeAt = Clock::time_point::max();
+    for (size_t i = 0; i < worker.sessions.size();) {
+      Session& session = *worker.sessions[i];
+      if (session.closed.load(std::memory_order_acquire)) {
+        ::close(session.fd);
+        worker.sessions[i] = std::move(worker.sessions.back());
+        worker.sessions.pop_back();
+        continue;
+      }
+      serve(session, now);
+      if (session.engine && session.playing && !session.paused)
+        wakeAt = std::min(wakeAt, session.deadline);
+      if (session.outputSize)
+        wakeAt = std::min(
+            wakeAt, now + std::chrono::nanoseconds(SESSION_RETRY_NANO));
+      i++;
+    }
+  }
+}
+
+/**
+ * Обход сессии: сообщения клиента, шаг по сроку такта и кадр, если
+ * что-то изменилось. Если шаг опоздал на целый такт, срок отсчитывается
+ * заново, а не догоняется пачкой шагов
+ */
+void SessionServer::serve(Session& session, Clock::time_point now) {
+  bool changed = false;
+  SessionRequest request;
+  while (session.requests.pop(request)) {
+    handle(session, request, now);
+    changed = true;
+  }
+  if (session.throttled.exchange(false, std::memory_order_acq_rel))
+    resume(session);
+  if (session.engine && session.playing && !session.paused &&
+      now >= session.deadline) {
+    session.engine->tick(session.state.get());
+    std::chrono::nanoseconds interval(
+        session.engine->interval(session.state.get()));
+    session.deadline += interval;
+    if (session.deadline <= now) {
+      missed_++;
+      session.deadline = now + interval;
+    }
+    changed = true;
+  }
+  if (changed && session.engine) sendFrame(session);
+  if (session.outputSize) flush(session);
+}
+
+/**
+ * Сообщение клиента. Start и Pause ведет сервер, остальные действия
+ * передаются движку; до SESSION_HELLO ввод пропускается
+ */
+void SessionServer::handle(Session& session, const SessionRequest& request,
+                           Clock::time_point now) {
+  void* state = session.state.get();
+  if (request.type == SESSION_HELLO) {
+    if (request.game == SESSION_TETRIS)
+      session.engine = getTetrisSessionEngine();
+    else if (request.game == SESSION_SNAKE)
+      session.engine = getSnakeSessionEngine();
+    else
+      return;
+    session.engine->start(state, request.seed);
+    session.best = 0;
+  } else if (request.type != SESSION_INPUT || !session.engine) {
+    return;
+  } else if (request.action == Start) {
+    session.engine->restart(state);
+  } else if (request.action == Pause) {
+    session.paused = !session.paused;
+    if (!session.paused)
+      session.deadline =
+          now + std::chrono::nanoseconds(session.engine->interval(state));
+    return;
+  } else {
+    if (!session.paused || request.action == Terminate)
+      session.engine->input(state, static_cast<UserAction_t>(request.action));
+    return;
+  }
+  session.keyframe = true;
+  session.playing = true;
+  session.paused = false;
+  session.deadline =
+      now + std::chrono::nanoseconds(session.engine->interval(state));
+}
+
+/**
+ * Кадр сессии в буфер отправки: опорный - все непустые клетки, иначе -
+ * клетки, изменившиеся с последнего записанного кадра. Если буфер занят
+ * медленным клиентом, кадр пропускается: следующий кадр сравнивается с
+ * тем же последним записанным и передаст изменения за оба шага
+ */
+void SessionServer::sendFrame(Session& session) {
+  SessionView view;
+  session.engine->render(session.state.get(), &view);
+  session.playing = view.state == SESSION_PLAYING;
+  session.best = std::max({session.best, view.score, view.highScore});
+  view.highScore = session.best;
+  view.paused = session.paused;
+
+  SessionCell cells[SESSION_CELLS];
+  int changes = 0;
+  for (int i = 0; i < SESSION_CELLS; i++)
+    if (session.keyframe ? view.cells[i] != 0
+                         : view.cells[i] != session.sent.cells[i])
+      cells[changes++] = {static_cast<uint8_t>(i), view.cells[i]};
+  if (!session.keyframe && !changes && sameStatus(view, session.sent)) return;
+  size_t size = sizeof(SessionFrameHeader) + changes * sizeof(SessionCell);
+  if (session.outputSize + size > SESSION_OUTPUT_SIZE) return;
+
+  SessionFrameHeader header = {};
+  header.type = SESSION_FRAME;
+  header.flags = (session.keyframe ? SESSION_KEYFRAME : 0) |
+                 (session.paused ? SESSION_PAUSED : 0);
+  header.changes = changes;
+  header.state = view.state;
+  header.tick = view.tick;
+  header.score = view.score;
+  header.highScore = view.highScore;
+  header.level = view.level;
+  header.speed = view.speed;
+  header.next = view.next;
+  unsigned char* output = session.output + session.outputSize;
+  std::memcpy(output, &header, sizeof(header));
+  std::memcpy(output + sizeof(header), cells, changes * sizeof(SessionCell));
+  session.outputSize += size;
+  session.sent = view;
+  session.keyframe = false;
+}
+
+/**
+ * Отправка накопленных кадров без ожидания. Остаток ждет следующего
+ * обхода; после ошибки отправки кадры отбрасываются до отключения клиента
+ */
+void SessionServer::flush(Session& session) {
+  size_t sent = 0;
+  while (!session.broken && sent < session.outputSize) {
+    ssize_t size = ::send(session.fd, session.output + sent,
+                          session.outputSize - sent,
+                          MSG_NOSIGNAL | MSG_DONTWAIT);
+    if (size > 0)
+      sent += size;
+    else if (size < 0 && errno == EINTR)
+      continue;
+    else if (size < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+      break;
+    else
+      session.broken = true;
+  }
+  if (session.broken) sent = session.outputSize;
+  std::memmove(session.output, session.output + sent,
+               session.outputSize - sent);
+  session.outputSize -= sent;
+}
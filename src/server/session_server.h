@@ -0,0 +1,147 @@
+#ifndef SESSION_SERVER_H
+#define SESSION_SERVER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "../brick_game/common/spsc_queue.h"
+#include "session.h"
+
+// Необработанных сообщений на сессию; пока очередь заполнена, сокет
+// клиента не читается и сам сдерживает клиента
+#define SESSION_INPUT_QUEUE 64
+// Неотправленных байтов на сессию; кадр, который не помещается,
+// пропускается, а следующий кадр передает изменения и за него
+#define SESSION_OUTPUT_SIZE (SESSION_MAX_FRAME * 8)
+#define SESSION_MAX_EVENTS 64
+#define SESSION_RECEIVE_SIZE 512
+// Повтор отправки, если сокет клиента был заполнен
+#define SESSION_RETRY_NANO 1000000
+
+namespace s21 {
+
+/**
+ * Сервер партий Snake и Tetris на сокете UNIX. Главный поток ведет цикл
+ * epoll: принимает соединения и разбирает сообщения клиентов в очереди
+ * сессий. Сессии распределяются по небольшому постоянному пулу потоков;
+ * поток пула применяет ввод своих сессий, делает шаги по срокам тактов
+ * каждой сессии и отправляет кадры - опорный при начале партии и только
+ * изменившиеся клетки после
+ */
+class SessionServer {
+ public:
+  SessionServer(const std::string& path, unsigned int threads);
+  ~SessionServer();
+  SessionServer(const SessionServer&) = delete;
+  SessionServer& operator=(const SessionServer&) = delete;
+
+  bool open();
+  void run();
+  void stop();
+
+  /**
+   * Получение количества подключенных сессий
+   */
+  unsigned int getSessions() const {
+    return sessions_.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * Получение количества шагов, сделанных позже срока на целый такт
+   */
+  unsigned long getMissedDeadlines() const {
+    return missed_.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * Получение количества остановок чтения из-за заполненной очереди
+   */
+  unsigned long getThrottles() const {
+    return throttles_.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * Получение количества потоков пула
+   */
+  unsigned int getThreads() const { return workers_.size(); }
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  /**
+   * Сессия одного клиента. Очередь сообщений и флаги закрытия и остановки
+   * чтения делят главный поток и поток пула, остальное принадлежит одному
+   * из них
+   */
+  struct Session {
+    int fd = -1;
+    SpscQueue<SessionRequest, SESSION_INPUT_QUEUE> requests;
+    std::atomic<bool> closed{false};
+    std::atomic<bool> throttled{false};
+    // Поля главного потока: недочитанное сообщение
+    unsigned char partial[sizeof(SessionRequest)];
+    size_t partialSize = 0;
+    // Поля потока пула
+    const SessionEngine* engine = nullptr;
+    std::unique_ptr<unsigned char[]> state;
+    SessionView sent = {};
+    bool keyframe = false;
+    bool playing = false;
+    bool paused = false;
+    bool broken = false;
+    int32_t best = 0;
+    Clock::time_point deadline;
+    unsigned char output[SESSION_OUTPUT_SIZE];
+    size_t outputSize = 0;
+  };
+
+  /**
+   * Поток пула и его сессии. Новые сессии и пробуждения передаются под
+   * мьютексом, сессии потока после этого трогает только он
+   */
+  struct Worker {
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::vector<std::unique_ptr<Session>> incoming;
+    bool signaled = false;
+    std::vector<std::unique_ptr<Session>> sessions;
+    unsigned int load = 0;
+  };
+
+  void accept();
+  void receive(int fd);
+  void drop(int fd);
+  void throttle(int fd, Session& session);
+  void resume(Session& session);
+  void notify(Worker& worker);
+  void loop(Worker& worker);
+  void serve(Session& session, Clock::time_point now);
+  void handle(Session& session, const SessionRequest& request,
+              Clock::time_point now);
+  void sendFrame(Session& session);
+  void flush(Session& session);
+
+  std::string path_;
+  int listen_;
+  int epoll_;
+  int stopEvent_;
+  std::vector<std::unique_ptr<Worker>> workers_;
+  // Сессия и номер ее потока по дескриптору, только для главного потока
+  std::unordered_map<int, std::pair<Session*, unsigned int>> clients_;
+  std::atomic<bool> stop_;
+  std::atomic<unsigned int> sessions_;
+  std::atomic<unsigned long> missed_;
+  std::atomic<unsigned long> throttles_;
+};
+
+}  // namespace s21
+
+#endif  // SESSION_SERVER_H
@@ -0,0 +1,121 @@
+#include <cstring>
+#include <new>
+
+#include "../brick_game/snake/snake.h"
+#include "session.h"
+
+using namespace s21;
+
+static_assert(FIELD_WIDTH == SESSION_WIDTH && FIELD_HEIGHT == SESSION_HEIGHT,
+              "Snake field must match the session frame");
+
+namespace {
+
+/**
+ * Партия сессии и ее повороты: как у Game, нажатия за один такт не
+ * теряются, а применяются по одному на шаг
+ */
+struct SnakeSession {
+  SnakeState state;
+  Snake::Direction turns[TURN_QUEUE_SIZE];
+  int turnCount;
+};
+
+/**
+ * Новая партия в памяти сессии
+ */
+void startSnake(void* state, uint32_t seed) {
+  SnakeSession& session = *new (state) SnakeSession();
+  initState(session.state, seed);
+}
+
+/**
+ * Новая партия с продолжением генератора
+ */
+void restartSnake(void* state) {
+  SnakeSession& session = *static_cast<SnakeSession*>(state);
+  restartState(session.state);
+  session.turnCount = 0;
+}
+
+/**
+ * Действие игрока: стрелки ставят поворот в очередь, Action переключает
+ * ускорение, Terminate заканчивает партию
+ */
+void inputSnake(void* state, UserAction_t action) {
+  SnakeSession& session = *static_cast<SnakeSession*>(state);
+  if (session.state.playing != PLAYING) return;
+  if (action == Terminate) session.state.playing = GAMEOVER;
+  if (action == Action) session.state.boost = !session.state.boost;
+  if (action >= Left && action <= Down && session.turnCount < TURN_QUEUE_SIZE)
+    session.turns[session.turnCount++] =
+        static_cast<Snake::Direction>(action - Left);
+}
+
+/**
+ * Применение одного поворота из очереди, как Game::applyTurn(): повороты,
+ * совпадающие с текущим направлением или противоположные последнему,
+ * отбрасываются
+ */
+void applyTurn(SnakeSession& session) {
+  Snake& snake = session.state.snake;
+  int used = 0;
+  while (used < session.turnCount) {
+    Snake::Direction direction = session.turns[used++];
+    if (direction == snake.getDirection() || snake.isOpposite(direction))
+      continue;
+    snake.setDirection(direction);
+    break;
+  }
+  session.turnCount -= used;
+  std::memmove(session.turns, session.turns + used,
+               session.turnCount * sizeof(*session.turns));
+}
+
+/**
+ * Шаг змейки
+ */
+void tickSnake(void* state) {
+  SnakeSession& session = *static_cast<SnakeSession*>(state);
+  applyTurn(session);
+  advanceState(session.state);
+}
+
+/**
+ * Длина такта по скорости партии и ускорению, как Game::getTickInterval()
+ */
+long intervalSnake(const void* state) {
+  const SnakeState& snake = static_cast<const SnakeSession*>(state)->state;
+  double speed = snake.speed;
+  if (snake.boost) speed *= BOOST_FACTOR;
+  return static_cast<long>(FRAME_DELAY_NANO / speed);
+}
+
+/**
+ * Кадр: блоки поля как в GameInfo_t игры, рекорд ведет сервер
+ */
+void renderSnake(const void* state, SessionView* view) {
+  const SnakeState& snake = static_cast<const SnakeSession*>(state)->state;
+  for (int y = 0; y < FIELD_HEIGHT; y++)
+    for (int x = 0; x < FIELD_WIDTH; x++)
+      view->cells[y * FIELD_WIDTH + x] = snake.field.getBlock(x, y);
+  view->next = 0;
+  view->tick = snake.tick;
+  view->score = snake.score;
+  view->highScore = 0;
+  view->level = snake.level;
+  view->speed = snake.speed;
+  view->state = snake.playing;
+}
+
+}  // namespace
+
+/**
+ * Получение движка сессий Snake
+ */
+const SessionEngine* getSnakeSessionEngine(void) {
+  static const SessionEngine engine = {
+      sizeof(SnakeSession), startSnake,    restartSnake, inputSnake,
+      tickSnake,            intervalSnake, renderSnake};
+  return &engine;
+}
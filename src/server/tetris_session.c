@@ -0,0 +1,104 @@
+#include "../brick_game/tetris/tetris.h"
+#include "session.h"
+
+_Static_assert(FIELD_WIDTH == SESSION_WIDTH && FIELD_HEIGHT == SESSION_HEIGHT,
+               "Tetris field must match the session frame");
+_Static_assert(FIGURE_SIZE == SESSION_NEXT_SIZE,
+               "Next figure must fit the frame mask");
+
+/**
+ * Новая партия в контексте сессии. Контекст подменяется только на время
+ * вызова, поэтому поток пула ведет партии всех своих сессий по очереди
+ */
+static void startTetris(void* state, uint32_t seed) {
+  TetrisContext* context = state;
+  memset(context, 0, sizeof(*context));
+  context->random = seedRandom(seed);
+  TetrisContext* previous = switchTetrisContext(context);
+  initGame(&context->game);
+  switchTetrisContext(previous);
+}
+
+/**
+ * Новая партия с продолжением генератора
+ */
+static void restartTetris(void* state) {
+  TetrisContext* context = state;
+  TetrisContext* previous = switchTetrisContext(context);
+  int highScore = context->game.high_score;
+  initGame(&context->game);
+  context->game.high_score = highScore;
+  switchTetrisContext(previous);
+}
+
+/**
+ * Действие игрока. Terminate заканчивает партию без записи рекорда в файл
+ */
+static void inputTetris(void* state, UserAction_t action) {
+  TetrisContext* context = state;
+  if (context->game.playing != PLAYING) return;
+  if (action == Terminate) {
+    context->game.playing = GAMEOVER;
+    return;
+  }
+  if (action != Left && action != Right && action != Down && action != Action)
+    return;
+  TetrisContext* previous = switchTetrisContext(context);
+  applyInput(action);
+  switchTetrisContext(previous);
+}
+
+/**
+ * Шаг падения фигуры
+ */
+static void tickTetris(void* state) {
+  TetrisContext* context = state;
+  if (context->game.playing != PLAYING) return;
+  TetrisContext* previous = switchTetrisContext(context);
+  advanceGame();
+  switchTetrisContext(previous);
+}
+
+/**
+ * Длина такта по скорости партии, как getTickInterval()
+ */
+static long intervalTetris(const void* state) {
+  const TetrisContext* context = state;
+  return FRAME_DELAY_NANO / context->game.speed;
+}
+
+/**
+ * Кадр: установленные блоки и падающая фигура, как updateGameInfoField()
+ */
+static void renderTetris(const void* state, SessionView* view) {
+  const Game* game = &((const TetrisContext*)state)->game;
+  const Figure* figure = &game->figure;
+  for (int i = 0; i < FIELD_HEIGHT; i++)
+    for (int j = 0; j < FIELD_WIDTH; j++) {
+      int cell = i * FIELD_WIDTH + j;
+      int x = j - figure->x, y = i - figure->y;
+      char block = game->field.blocks[cell];
+      if (!block && x >= 0 && x < figure->size && y >= 0 && y < figure->size)
+        block = figure->blocks[y * figure->size + x];
+      view->cells[cell] = block;
+    }
+  view->next = 0;
+  for (int i = 0; i < FIGURE_AREA; i++)
+    if (game->next.blocks[i]) view->next |= 1u << i;
+  view->tick = game->tick;
+  view->score = game->score;
+  view->highScore = game->high_score;
+  view->level = game->speed;
+  view->speed = game->speed;
+  view->state = game->playing;
+}
+
+/**
+ * Получение движка сессий Tetris
+ */
+const SessionEngine* getTetrisSessionEngine(void) {
+  static const SessionEngine engine = {
+      sizeof(TetrisContext), startTetris,    restartTetris, inputTetris,
+      tickTetris,            intervalTetris, renderTetris};
+  return &engine;
+}
@@ -0,0 +1,127 @@
+#include "alloc_counter.h"
+
+#include <execinfo.h>
+
+#include <atomic>
+#include <cstring>
+
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+}
+
+namespace {
+
+/**
+ * Место выделения: стек вызова и количество выделений из него
+ */
+struct AllocSite {
+  void* frames[ALLOC_SITE_DEPTH];
+  int depth;
+  unsigned long count;
+};
+
+std::atomic<unsigned long> allocCount{0};
+AllocSite sites[ALLOC_SITES];
+int siteCount = 0;
+unsigned long counted = 0;
+thread_local bool counting = false;
+// Сам backtrace() при первом вызове обращается к куче
+thread_local bool inHook = false;
+
+/**
+ * Запоминание места выделения. Кадры самого счетчика и malloc
+ * отбрасываются
+ */
+void recordAllocSite() {
+  void* frames[ALLOC_SITE_DEPTH + 2];
+  int depth = backtrace(frames, ALLOC_SITE_DEPTH + 2) - 2;
+  if (depth < 0) depth = 0;
+  size_t size = depth * sizeof(void*);
+  for (AllocSite* site = sites; site < sites + siteCount; site++)
+    if (site->depth == depth && !std::memcmp(site->frames, frames + 2, size)) {
+      site->count++;
+      return;
+    }
+  if (siteCount == ALLOC_SITES) return;
+  AllocSite* site = &sites[siteCount++];
+  std::memcpy(site->frames, frames + 2, size);
+  site->depth = depth;
+  site->count = 1;
+}
+
+/**
+ * Учет одного выделения
+ */
+void countAlloc() {
+  allocCount.fetch_add(1, std::memory_order_relaxed);
+  if (!counting || inHook) return;
+  inHook = true;
+  counted++;
+  recordAllocSite();
+  inHook = false;
+}
+
+}  // namespace
+
+extern "C" {
+
+void* malloc(size_t size) noexcept {
+  countAlloc();
+  return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) noexcept {
+  countAlloc();
+  return __libc_calloc(count, size);
+}
+
+void* realloc(void* ptr, size_t size) noexcept {
+  countAlloc();
+  return __libc_realloc(ptr, size);
+}
+
+}  // extern "C"
+
+/**
+ * Получение количества выделений во всех потоках с запуска программы
+ */
+unsigned long getAllocCount() {
+  return allocCount.load(std::memory_order_relaxed);
+}
+
+/**
+ * Начало замера: запомненные места выделения сбрасываются
+ */
+void startAllocCounting() {
+  void* frame;
+  backtrace(&frame, 1);
+  siteCount = 0;
+  counted = 0;
+  counting = true;
+}
+
+/**
+ * Окончание замера
+ *
+ * @return количество выделений текущего потока за время замера
+ */
+unsigned long stopAllocCounting() {
+  counting = false;
+  return counted;
+}
+
+/**
+ * Вывод мест выделения последнего замера. Имена функций видны, если
+ * программа собрана с -rdynamic
+ *
+ * @param out поток вывода
+ */
+void printAllocSites(std::FILE* out) {
+  for (int i = 0; i < siteCount; i++) {
+    std::fprintf(out, "%lu allocation(s) at:\n", sites[i].count);
+    std::fflush(out);
+    backtrace_symbols_fd(sites[i].frames, sites[i].depth, fileno(out));
+  }
+}
@@ -0,0 +1,22 @@
+#ifndef ALLOC_COUNTER_H
+#define ALLOC_COUNTER_H
+
+#include <cstdio>
+
+// Количество различных мест выделения, запоминаемых за один замер
+#define ALLOC_SITES 16
+// Глубина стека, по которой различаются места выделения
+#define ALLOC_SITE_DEPTH 8
+
+/**
+ * Счетчик обращений к куче для тестов и замеров. Подменяет malloc, calloc и
+ * realloc, а через них и operator new, поэтому видны выделения и из C, и из
+ * C++. Между startAllocCounting() и stopAllocCounting() выделения текущего
+ * потока запоминаются вместе со стеком вызова
+ */
+unsigned long getAllocCount();
+void startAllocCounting();
+unsigned long stopAllocCounting();
+void printAllocSites(std::FILE* out);
+
+#endif  // ALLOC_COUNTER_H
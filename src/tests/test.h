@@ -1,3 +1,14 @@
 #include <gtest/gtest.h>
 
-#include "../brick_game/snake/snake.h"
\ No newline at end of file
+#include "../brick_game/snake/snake.h"
+
+/**
+ * Обход поля по периметру прямоугольника, чтобы змейка не погибла
+ */
+inline UserAction_t chooseTurn(std::pair<int, int> head) {
+  int x = head.first, y = head.second;
+  if (y == 1 && x < FIELD_WIDTH - 2) return Right;
+  if (x == FIELD_WIDTH - 2 && y < FIELD_HEIGHT - 2) return Down;
+  if (y == FIELD_HEIGHT - 2 && x > 1) return Left;
+  return Up;
+}
@@ -0,0 +1,89 @@
+#include "../brick_game/snake/planner.h"
+#include "alloc_counter.h"
+#include "test.h"
+
+namespace {
+
+/**
+ * Перенос яблока на клетку, в которую змейка шагнет следующей
+ */
+void placeAppleAhead(s21::Game& game) {
+  s21::SnakeState state = game.snapshot();
+  std::pair<int, int> head = state.snake.getSegment(0);
+  switch (chooseTurn(head)) {
+    case Right:
+      head.first++;
+      break;
+    case Down:
+      head.second++;
+      break;
+    case Left:
+      head.first--;
+      break;
+    default:
+      head.second--;
+      break;
+  }
+  state.field.setBlock(state.appleX, state.appleY, 0);
+  state.field.setBlock(head.first, head.second, 3);
+  state.appleX = head.first;
+  state.appleY = head.second;
+  game.restore(state);
+}
+
+}  // namespace
+
+TEST(AllocTest, SnakeSteadyState) {
+  s21::Game& game = s21::Game::getGame();
+  game.resetGame();
+  updateCurrentState();
+
+  startAllocCounting();
+  for (int tick = 0; tick < 600; tick++) {
+    if (tick % 50 == 0) placeAppleAhead(game);
+    userInput(chooseTurn(game.getSnake().getHead()), 0);
+    if (tick % 100 == 50) {
+      userInput(Action, 0);
+      userInput(Pause, 0);
+      userInput(Pause, 0);
+    }
+    game.step(std::chrono::steady_clock::now());
+    updateCurrentState();
+  }
+  unsigned long allocs = stopAllocCounting();
+  if (allocs) printAllocSites(stderr);
+  EXPECT_EQ(allocs, 0u);
+
+  EXPECT_EQ(game.getPlaying(), s21::PLAYING);
+  EXPECT_GT(game.getGameInfo().score, 0);
+  game.resetGame();
+}
+
+TEST(AllocTest, PlannerDecide) {
+  s21::Game& game = s21::Game::getGame();
+  game.resetGame();
+  s21::MonteCarloPlanner planner(2, 192, PLANNER_DEPTH,
+                                 std::chrono::seconds(1));
+  s21::SnakeState state = game.snapshot();
+  planner.decide(state);
+
+  // Счетчик ведется по потокам: здесь видны партии вызывающего потока
+  startAllocCounting();
+  for (int tick = 0; tick < 20; tick++) {
+    state.snake.setDirection(planner.decide(state));
+    s21::advanceState(state);
+  }
+  unsigned long allocs = stopAllocCounting();
+  if (allocs) printAllocSites(stderr);
+  EXPECT_EQ(allocs, 0u);
+  EXPECT_EQ(state.playing, s21::PLAYING);
+  game.resetGame();
+}
+
+TEST(AllocTest, CountsCallSites) {
+  startAllocCounting();
+  for (int i = 0; i < 3; i++) delete new int(i);
+  void* block = std::malloc(16);
+  std::free(block);
+  EXPECT_EQ(stopAllocCounting(), 4u);
+}
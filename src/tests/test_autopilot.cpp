@@ -0,0 +1,55 @@
+#include "../brick_game/snake/autopilot.h"
+
+#include "test.h"
+
+TEST(AutopilotTest, EatsApplesWithoutDying) {
+  s21::Game& game = s21::Game::getGame();
+  game.seed(RANDOM_DEFAULT_SEED);
+  game.resetGame();
+  s21::Autopilot autopilot;
+  for (int tick = 0; tick < 3000 && game.getGameInfo().score < 40; tick++) {
+    s21::Snake::Direction direction = autopilot.decide(game);
+    EXPECT_FALSE(game.getSnake().isOpposite(direction));
+    game.getSnake().setDirection(direction);
+    game.step(std::chrono::steady_clock::now());
+    ASSERT_EQ(game.getPlaying(), s21::PLAYING);
+  }
+  EXPECT_GE(game.getGameInfo().score, 40);
+  // Поле расстояний пересчитывается в основном только после яблок
+  EXPECT_LT(autopilot.getRecomputes(), autopilot.getDecisions() / 4);
+  game.resetGame();
+}
+
+TEST(AutopilotTest, DriveOncePerTick) {
+  s21::Game& game = s21::Game::getGame();
+  game.resetGame();
+  s21::Autopilot autopilot;
+  autopilot.drive(game);
+  EXPECT_FALSE(autopilot.drive(game));
+  EXPECT_EQ(autopilot.getDecisions(), 1u);
+
+  game.step(std::chrono::steady_clock::now());
+  autopilot.drive(game);
+  EXPECT_EQ(autopilot.getDecisions(), 2u);
+
+  userInput(Pause, 0);
+  game.step(std::chrono::steady_clock::now());
+  EXPECT_FALSE(autopilot.drive(game));
+  EXPECT_EQ(autopilot.getDecisions(), 2u);
+  game.resetGame();
+}
+
+TEST(AutopilotTest, FillsBoard) {
+  s21::Game& game = s21::Game::getGame();
+  s21::Autopilot autopilot;
+  game.seed(RANDOM_DEFAULT_SEED);
+  game.resetGame();
+  for (int tick = 0; tick < 20000 && game.getPlaying() == s21::PLAYING;
+       tick++) {
+    game.getSnake().setDirection(autopilot.decide(game));
+    game.step(std::chrono::steady_clock::now());
+  }
+  EXPECT_NE(game.getPlaying(), s21::GAMEOVER);
+  EXPECT_GT(game.getSnake().getLength(), BOARD_CELLS * 3u / 4);
+  game.resetGame();
+}
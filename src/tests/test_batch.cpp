@@ -0,0 +1,119 @@
+#include "../brick_game/snake/batch.h"
+#include "../brick_game/snake/hamiltonian.h"
+#include "test.h"
+
+namespace {
+
+/**
+ * Количество занятых клеток в наблюдении
+ */
+int countBody(const s21::SnakeObservation& observation) {
+  int count = 0;
+  for (uint64_t word : observation.body) count += __builtin_popcountll(word);
+  return count;
+}
+
+}  // namespace
+
+TEST(SnakeBatchTest, LoadRejectsFinishedGame) {
+  s21::SnakeState state;
+  s21::initState(state, RANDOM_DEFAULT_SEED);
+  s21::SnakeBatch batch(1, 1);
+  s21::SnakeObservation before, after;
+  batch.observe(&before);
+  for (int tick = 0; tick < 30 && state.playing == s21::PLAYING; tick++)
+    s21::advanceState(state);
+  ASSERT_EQ(state.playing, s21::GAMEOVER);
+  EXPECT_THROW(batch.load(0, state), std::invalid_argument);
+  state.playing = s21::PLAYING;
+  EXPECT_THROW(batch.load(0, state), std::out_of_range);
+  batch.observe(&after);
+  EXPECT_EQ(before.head, after.head);
+  EXPECT_EQ(before.length, after.length);
+}
+
+TEST(SnakeBatchTest, MatchesAdvanceState) {
+  s21::Game& game = s21::Game::getGame();
+  game.seed(RANDOM_DEFAULT_SEED);
+  game.resetGame();
+  s21::SnakeState state = game.snapshot();
+  s21::SnakeBatch batch(3, 1);
+  batch.load(1, state);
+  s21::HamiltonianSolver solver;
+  uint8_t actions[3] = {};
+  float rewards[3];
+  uint8_t dones[3];
+  s21::SnakeObservation observations[3];
+  int apples = 0;
+  for (int tick = 0; tick < 3000 && state.playing == s21::PLAYING; tick++) {
+    s21::Snake::Direction direction =
+        solver.decide(state.snake, {state.appleX, state.appleY});
+    state.snake.setDirection(direction);
+    s21::advanceState(state);
+    actions[1] = direction;
+    batch.step(actions, rewards, dones, observations);
+    if (state.playing != s21::PLAYING) break;
+    ASSERT_EQ(dones[1], 0);
+    const s21::SnakeObservation& observation = observations[1];
+    std::pair<int, int> head = state.snake.getHead();
+    ASSERT_EQ(observation.head, head.second * FIELD_WIDTH + head.first);
+    ASSERT_EQ(observation.apple, state.appleY * FIELD_WIDTH + state.appleX);
+    ASSERT_EQ(observation.length, state.snake.getLength());
+    ASSERT_EQ(countBody(observation), observation.length);
+    ASSERT_EQ(batch.getScore(1), static_cast<uint32_t>(state.score));
+    ASSERT_EQ(batch.getRandom(1), state.random);
+    apples += rewards[1] == BATCH_APPLE_REWARD;
+  }
+  EXPECT_GT(state.score, 20);
+  EXPECT_EQ(apples, state.score);
+  game.resetGame();
+}
+
+TEST(SnakeBatchTest, ResetsFinishedEpisodes) {
+  s21::SnakeBatch batch(4, 7);
+  std::vector<uint8_t> actions(4, s21::Snake::Left);
+  // Поворот назад не применяется: змейка продолжает идти вверх
+  actions[3] = s21::Snake::Down;
+  std::vector<float> rewards(4);
+  std::vector<uint8_t> dones(4);
+  std::vector<s21::SnakeObservation> observations(4);
+  int steps = 0;
+  while (!dones[0]) {
+    batch.step(actions.data(), rewards.data(), dones.data(),
+               observations.data());
+    steps++;
+    ASSERT_LE(steps, FIELD_WIDTH);
+  }
+  EXPECT_EQ(steps, START_X + 1);
+  EXPECT_EQ(rewards[0], BATCH_DEATH_REWARD);
+  EXPECT_EQ(observations[0].length, 4);
+  EXPECT_EQ(observations[0].direction, s21::Snake::Up);
+  EXPECT_EQ(observations[0].head, START_Y * FIELD_WIDTH + START_X);
+  EXPECT_EQ(observations[3].direction, s21::Snake::Up);
+  EXPECT_EQ(observations[3].head, (START_Y - steps) * FIELD_WIDTH + START_X);
+  EXPECT_GE(batch.getEpisodes(), 3u);
+}
+
+TEST(SnakeBatchTest, RandomPlayKeepsBoardsConsistent) {
+  const unsigned int count = 256;
+  s21::SnakeBatch batch(count, RANDOM_DEFAULT_SEED);
+  std::vector<uint8_t> actions(count), dones(count);
+  std::vector<float> rewards(count);
+  std::vector<s21::SnakeObservation> observations(count);
+  uint32_t random = RANDOM_DEFAULT_SEED;
+  for (int tick = 0; tick < 500; tick++) {
+    for (uint8_t& action : actions) action = nextRandom(&random) % 4;
+    batch.step(actions.data(), rewards.data(), dones.data(),
+               observations.data());
+    for (const s21::SnakeObservation& observation : observations) {
+      ASSERT_EQ(countBody(observation), observation.length);
+      ASSERT_TRUE(observation.body[observation.head / 64] >>
+                      (observation.head % 64) &
+                  1);
+      ASSERT_FALSE(observation.body[observation.apple / 64] >>
+                       (observation.apple % 64) &
+                   1);
+    }
+  }
+  EXPECT_GT(batch.getEpisodes(), count);
+}
@@ -0,0 +1,52 @@
+#include "test.h"
+
+TEST(EngineStatsTest, Buckets) {
+  EXPECT_EQ(engineStatsBucket(0), 0u);
+  EXPECT_EQ(engineStatsBucket(1), 0u);
+  EXPECT_EQ(engineStatsBucket(2), 1u);
+  EXPECT_EQ(engineStatsBucket(1023), 9u);
+  EXPECT_EQ(engineStatsBucket(1024), 10u);
+  EXPECT_EQ(engineStatsBucket(UINT64_MAX), ENGINE_STATS_BUCKETS - 1u);
+}
+
+TEST(EngineStatsTest, Percentile) {
+  const char* const names[] = {"phase"};
+  EngineStats stats;
+  initEngineStats(&stats, names, 1);
+  for (int i = 0; i < 99; i++) recordEnginePhase(&stats, 0, 100);
+  recordEnginePhase(&stats, 0, 5000);
+
+  const EnginePhaseStats& phase = stats.phases[0];
+  EXPECT_EQ(phase.count, 100u);
+  EXPECT_EQ(phase.totalNs, 99u * 100 + 5000);
+  EXPECT_EQ(phase.maxNs, 5000u);
+  EXPECT_EQ(engineStatsPercentile(&phase, 0.5), 128u);
+  EXPECT_EQ(engineStatsPercentile(&phase, 0.99), 128u);
+  EXPECT_EQ(engineStatsPercentile(&phase, 1.0), 5000u);
+
+  resetEngineStats(&stats);
+  EXPECT_EQ(stats.phases[0].count, 0u);
+  EXPECT_STREQ(stats.phases[0].name, "phase");
+}
+
+TEST(EngineStatsTest, CountSnakePhases) {
+  s21::Game& game = s21::Game::getGame();
+  game.resetGame();
+  EngineStats* stats = s21::getEngineStats();
+  resetEngineStats(stats);
+
+  game.setLastActionTime(std::chrono::steady_clock::time_point());
+  updateCurrentState();
+
+  EXPECT_EQ(stats->phaseCount, static_cast<unsigned>(s21::SNAKE_PHASES));
+  EXPECT_EQ(stats->phases[s21::SNAKE_PHASE_FRAME].count, 1u);
+  EXPECT_EQ(stats->phases[s21::SNAKE_PHASE_STEP].count, 1u);
+  EXPECT_EQ(stats->phases[s21::SNAKE_PHASE_RESET_SNAKE].count, 1u);
+  EXPECT_EQ(stats->phases[s21::SNAKE_PHASE_UPDATE_SNAKE].count, 1u);
+  EXPECT_EQ(stats->phases[s21::SNAKE_PHASE_CALCULATE_TURN].count, 0u);
+  EXPECT_EQ(stats->phases[s21::SNAKE_PHASE_COLLISION].count, 1u);
+  EXPECT_EQ(stats->phases[s21::SNAKE_PHASE_COMPOSITE].count, 1u);
+  EXPECT_GE(stats->phases[s21::SNAKE_PHASE_FRAME].totalNs,
+            stats->phases[s21::SNAKE_PHASE_STEP].totalNs);
+  game.resetGame();
+}
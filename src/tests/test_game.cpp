@@ -38,20 +38,20 @@ TEST(GameTest, ResetSnake) {
   s21::Game& game = s21::Game::getGame();
   game.resetGame();
 
-  std::deque<std::pair<int, int>>& body = game.getSnake().getBody();
+  s21::Snake& snake = game.getSnake();
   game.addSnake();
 
-  for (size_t i = 0; i < body.size(); i++) {
-    int x = body[i].first;
-    int y = body[i].second;
+  for (size_t i = 0; i < snake.getLength(); i++) {
+    int x = snake.getSegment(i).first;
+    int y = snake.getSegment(i).second;
     EXPECT_NE(game.getField().getBlock(x, y), 0);
   }
 
   game.resetSnake();
 
-  for (size_t i = 0; i < body.size(); i++) {
-    int x = body[i].first;
-    int y = body[i].second;
+  for (size_t i = 0; i < snake.getLength(); i++) {
+    int x = snake.getSegment(i).first;
+    int y = snake.getSegment(i).second;
     EXPECT_EQ(game.getField().getBlock(x, y), 0);
   }
 }
@@ -85,7 +85,7 @@ TEST(GameTest, ResetGame) {
 TEST(GameTest, SnakeCollision) {
   s21::Game& game = s21::Game::getGame();
 
-  game.getSnake().getBody().front() = {-1, 0};
+  game.getSnake().setSegment(0, {-1, 0});
 
   EXPECT_TRUE(game.snakeCollision());
 }
@@ -103,7 +103,7 @@ TEST(GameTest, CalculateTurn) {
   s21::Game& game = s21::Game::getGame();
 
   std::pair<int, int> apple = game.getApple();
-  game.getSnake().getBody().front() = apple;
+  game.getSnake().setSegment(0, apple);
 
   game.calculateTurn();
 
@@ -111,4 +111,56 @@ TEST(GameTest, CalculateTurn) {
 
   std::pair<int, int> newApple = game.getApple();
   EXPECT_NE(newApple, apple);
-}
\ No newline at end of file
+}
+
+namespace {
+
+/**
+ * Шаг змейки по кругу 2x2, чтобы она не покидала поле
+ */
+void circleStep(s21::Game& game) {
+  static const s21::Snake::Direction directions[] = {
+      s21::Snake::Direction::Right, s21::Snake::Direction::Down,
+      s21::Snake::Direction::Left, s21::Snake::Direction::Up};
+  game.getSnake().setDirection(directions[game.getTick() % 4]);
+  game.step(std::chrono::steady_clock::now());
+}
+
+}  // namespace
+
+TEST(GameTest, SnapshotRestore) {
+  s21::Game& game = s21::Game::getGame();
+  game.resetGame();
+  s21::SnakeState state = game.snapshot();
+
+  for (int i = 0; i < 3; i++) circleStep(game);
+  EXPECT_EQ(game.getTick(), 3ul);
+
+  game.restore(state);
+
+  EXPECT_EQ(game.getTick(), 0ul);
+  EXPECT_EQ(game.getApple(), std::make_pair(state.appleX, state.appleY));
+  for (size_t i = 0; i < game.getSnake().getLength(); i++)
+    EXPECT_EQ(game.getSnake().getSegment(i), state.snake.getSegment(i));
+  EXPECT_EQ(game.snapshot().random, state.random);
+}
+
+TEST(GameTest, Rewind) {
+  s21::Game& game = s21::Game::getGame();
+  game.resetGame();
+  std::pair<int, int> head = game.getSnake().getHead();
+
+  for (int i = 0; i < 5; i++) circleStep(game);
+  EXPECT_TRUE(game.rewind(2));
+  EXPECT_EQ(game.getTick(), 3ul);
+  EXPECT_FALSE(game.rewind(4));
+  EXPECT_TRUE(game.rewind(3));
+  EXPECT_EQ(game.getTick(), 0ul);
+  EXPECT_EQ(game.getSnake().getHead(), head);
+
+  for (int i = 0; i < REWIND_CAPACITY + 10; i++) circleStep(game);
+  EXPECT_FALSE(game.rewind(REWIND_CAPACITY));
+  EXPECT_TRUE(game.rewind(REWIND_CAPACITY - 1));
+  EXPECT_EQ(game.getTick(), 11ul);
+  game.resetGame();
+}
@@ -0,0 +1,58 @@
+#include <cstdlib>
+
+#include "../brick_game/snake/hamiltonian.h"
+#include "test.h"
+
+namespace {
+
+void expectCycle(const s21::HamiltonianCycle& cycle) {
+  int cells = cycle.width * cycle.height;
+  for (int position = 0; position < cells; position++) {
+    int cell = cycle.cells[position];
+    int next = cycle.cells[(position + 1) % cells];
+    ASSERT_EQ(cycle.order[cell], position);
+    int dx = std::abs(cell % cycle.width - next % cycle.width);
+    int dy = std::abs(cell / cycle.width - next / cycle.width);
+    EXPECT_EQ(dx + dy, 1);
+  }
+}
+
+}  // namespace
+
+TEST(HamiltonianTest, BuildCycle) {
+  expectCycle(s21::getHamiltonianCycle());
+  EXPECT_EQ(&s21::getHamiltonianCycle(), &s21::getHamiltonianCycle());
+
+  s21::HamiltonianCycle cycle;
+  ASSERT_TRUE(s21::buildHamiltonianCycle(4, 3, &cycle));
+  expectCycle(cycle);
+  ASSERT_TRUE(s21::buildHamiltonianCycle(2, 2, &cycle));
+  expectCycle(cycle);
+  EXPECT_FALSE(s21::buildHamiltonianCycle(3, 5, &cycle));
+  EXPECT_FALSE(s21::buildHamiltonianCycle(1, 4, &cycle));
+}
+
+TEST(HamiltonianTest, WinsGame) {
+  s21::Game& game = s21::Game::getGame();
+  s21::HamiltonianSolver solver;
+  for (unsigned int seed = 1; seed <= 3; seed++) {
+    game.seed(seed);
+    game.resetGame();
+    solver.reset();
+    int tick = 0;
+    for (; tick < BOARD_CELLS * BOARD_CELLS; tick++) {
+      if (game.getPlaying() != s21::PLAYING) break;
+      s21::Snake::Direction direction = solver.decide(game);
+      EXPECT_FALSE(game.getSnake().isOpposite(direction));
+      game.getSnake().setDirection(direction);
+      game.step(std::chrono::steady_clock::now());
+    }
+    ASSERT_EQ(game.getPlaying(), s21::WIN);
+    EXPECT_EQ(game.getSnake().getLength(), static_cast<size_t>(BOARD_CELLS));
+    // Со срезками поле заполняется быстрее, чем обходом цикла за каждым
+    // яблоком
+    EXPECT_LT(tick, BOARD_CELLS * BOARD_CELLS / 2);
+  }
+  EXPECT_GT(solver.getShortcuts(), 0u);
+  game.resetGame();
+}
@@ -0,0 +1,48 @@
+#include "../brick_game/common/latency.h"
+
+#include "test.h"
+
+TEST(LatencyTest, CompleteOnPresentedGeneration) {
+  resetLatency();
+  EngineStats* stats = getLatencyStats();
+  uint64_t inputNs = engineStatsNow();
+  recordInputApplied(inputNs, 5);
+  recordInputApplied(inputNs, 6);
+
+  recordFramePresented(4);
+  EXPECT_EQ(stats->phases[LATENCY_INPUT_TO_PRESENT].count, 0u);
+  recordFramePresented(5);
+  EXPECT_EQ(stats->phases[LATENCY_INPUT_TO_PRESENT].count, 1u);
+  recordFramePresented(7);
+  EXPECT_EQ(stats->phases[LATENCY_INPUT_TO_APPLY].count, 2u);
+  EXPECT_EQ(stats->phases[LATENCY_APPLY_TO_PRESENT].count, 2u);
+  EXPECT_EQ(stats->phases[LATENCY_INPUT_TO_PRESENT].count, 2u);
+  EXPECT_GE(stats->phases[LATENCY_INPUT_TO_PRESENT].maxNs,
+            stats->phases[LATENCY_APPLY_TO_PRESENT].maxNs);
+  resetLatency();
+}
+
+TEST(LatencyTest, SnakeInputGeneration) {
+  s21::Game& game = s21::Game::getGame();
+  game.resetGame();
+  unsigned long generation = game.getGeneration();
+
+  // Поворот в текущем направлении и разворот будут отброшены
+  UserAction_t forward =
+      static_cast<UserAction_t>(Left + game.getSnake().getDirection());
+  bool horizontal = forward == Left || forward == Right;
+  userInput(forward, 0);
+  userInput(horizontal ? Up : Left, 0);
+  userInput(horizontal ? Down : Right, 0);
+  userInput(forward, 0);
+  EXPECT_EQ(game.getGeneration(), generation);
+  EXPECT_EQ(game.getInputGeneration(), generation + 2);
+
+  game.step(std::chrono::steady_clock::now());
+  EXPECT_EQ(game.getGeneration(), generation + 1);
+  EXPECT_EQ(game.getInputGeneration(), generation + 2);
+
+  userInput(Action, 0);
+  EXPECT_EQ(game.getGeneration(), generation + 2);
+  game.resetGame();
+}
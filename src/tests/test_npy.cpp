@@ -0,0 +1,93 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+#include "../brick_game/common/npy_writer.h"
+
+#define NPY_TEST_PATH "test_export.npy"
+
+namespace {
+
+const NpyColumn kColumns[] = {
+    {"cells", "<u2", 3}, {"action", "|u1", 1}, {"reward", "<f4", 1}};
+
+/**
+ * Содержимое файла целиком
+ */
+std::string readFile(const char* path) {
+  std::ifstream file(path, std::ios::binary);
+  return std::string(std::istreambuf_iterator<char>(file),
+                     std::istreambuf_iterator<char>());
+}
+
+/**
+ * Размер заголовка вместе с магией: 10 байт и длина словаря
+ */
+size_t headerSize(const std::string& data) {
+  return 10 + (static_cast<uint8_t>(data[8]) |
+               static_cast<uint8_t>(data[9]) << 8);
+}
+
+}  // namespace
+
+TEST(NpyTest, WritesChunksInOrder) {
+  NpyWriter* writer = openNpyWriter(NPY_TEST_PATH, kColumns, 3, 3);
+  ASSERT_NE(writer, nullptr);
+  EXPECT_EQ(getNpyRecordSize(writer), 11u);
+  for (int i = 0; i < 10; i++) {
+    void* record = nextNpyRecord(writer);
+    uint16_t cells[3] = {static_cast<uint16_t>(i), 7, 0xffff};
+    uint8_t action = i * 2;
+    float reward = i * 0.5f;
+    setNpyColumn(writer, record, 0, cells);
+    setNpyColumn(writer, record, 1, &action);
+    setNpyColumn(writer, record, 2, &reward);
+  }
+  EXPECT_EQ(getNpyRecords(writer), 10u);
+  EXPECT_EQ(closeNpyWriter(writer), 0);
+
+  std::string data = readFile(NPY_TEST_PATH);
+  ASSERT_GT(data.size(), 10u);
+  EXPECT_EQ(data.compare(0, 6, NPY_MAGIC), 0);
+  EXPECT_EQ(data[6], 1);
+  size_t header = headerSize(data);
+  EXPECT_EQ(header % NPY_ALIGNMENT, 0u);
+  EXPECT_EQ(data[header - 1], '\n');
+  std::string dict = data.substr(10, header - 10);
+  EXPECT_NE(dict.find("('cells', '<u2', (3,)), ('action', '|u1'), "
+                      "('reward', '<f4')"),
+            std::string::npos);
+  EXPECT_NE(dict.find("'shape': (10,)"), std::string::npos);
+  ASSERT_EQ(data.size(), header + 10 * 11);
+  for (int i = 0; i < 10; i++) {
+    const char* record = data.data() + header + i * 11;
+    uint16_t cells[3];
+    float reward;
+    std::memcpy(cells, record, sizeof(cells));
+    std::memcpy(&reward, record + 7, sizeof(reward));
+    EXPECT_EQ(cells[0], i);
+    EXPECT_EQ(cells[2], 0xffff);
+    EXPECT_EQ(static_cast<uint8_t>(record[6]), i * 2);
+    EXPECT_FLOAT_EQ(reward, i * 0.5f);
+  }
+  std::remove(NPY_TEST_PATH);
+}
+
+TEST(NpyTest, EmptyAndInvalid) {
+  NpyWriter* writer = openNpyWriter(NPY_TEST_PATH, kColumns, 3, 16);
+  ASSERT_NE(writer, nullptr);
+  EXPECT_EQ(closeNpyWriter(writer), 0);
+  std::string data = readFile(NPY_TEST_PATH);
+  EXPECT_EQ(data.size(), headerSize(data));
+  EXPECT_NE(data.find("'shape': (0,)"), std::string::npos);
+  std::remove(NPY_TEST_PATH);
+
+  const NpyColumn unknown[] = {{"cells", "u2", 1}};
+  EXPECT_EQ(openNpyWriter(NPY_TEST_PATH, unknown, 1, 16), nullptr);
+  EXPECT_EQ(openNpyWriter(NPY_TEST_PATH, kColumns, 0, 16), nullptr);
+  EXPECT_EQ(openNpyWriter("missing/dir/file.npy", kColumns, 3, 16), nullptr);
+}
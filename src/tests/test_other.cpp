@@ -5,16 +5,57 @@ TEST(UserInputTest, HandleDirectionChanges) {
   game.resetGame();
 
   userInput(Left, 1);
+  userInput(Up, 1);
+  EXPECT_EQ(game.getSnake().getDirection(), s21::Snake::Direction::Up);
+
+  auto now = std::chrono::steady_clock::now();
+  game.applyTurn(now);
   EXPECT_EQ(game.getSnake().getDirection(), s21::Snake::Direction::Left);
+  game.updateSnake();
+
+  game.applyTurn(now);
+  EXPECT_EQ(game.getSnake().getDirection(), s21::Snake::Direction::Up);
+}
+
+TEST(UserInputTest, QueueQuickUTurn) {
+  s21::Game& game = s21::Game::getGame();
+  game.resetGame();
+
+  userInput(Left, 1);
+  userInput(Down, 1);
+  auto now = std::chrono::steady_clock::now();
+  game.applyTurn(now);
+  game.updateSnake();
+  game.applyTurn(now);
+  game.updateSnake();
+
+  EXPECT_EQ(game.getSnake().getDirection(), s21::Snake::Direction::Down);
+  EXPECT_EQ(game.getSnake().getHead(),
+            std::make_pair(START_X - 1, START_Y + 1));
+}
+
+TEST(UserInputTest, DropInvalidTurns) {
+  s21::Game& game = s21::Game::getGame();
+  game.resetGame();
 
+  userInput(Down, 1);
+  userInput(Up, 1);
   userInput(Right, 1);
+  game.applyTurn(std::chrono::steady_clock::now());
   EXPECT_EQ(game.getSnake().getDirection(), s21::Snake::Direction::Right);
+}
 
-  userInput(Up, 1);
+TEST(UserInputTest, DelayLateTurns) {
+  s21::Game& game = s21::Game::getGame();
+  game.resetGame();
+
+  auto deadline = std::chrono::steady_clock::now();
+  userInput(Left, 1);
+  game.applyTurn(deadline - std::chrono::milliseconds(1));
   EXPECT_EQ(game.getSnake().getDirection(), s21::Snake::Direction::Up);
 
-  userInput(Down, 1);
-  EXPECT_NE(game.getSnake().getDirection(), s21::Snake::Direction::Down);
+  game.applyTurn(std::chrono::steady_clock::now());
+  EXPECT_EQ(game.getSnake().getDirection(), s21::Snake::Direction::Left);
 }
 
 TEST(UserInputTest, HandleBoost) {
@@ -65,4 +106,21 @@ TEST(GetFrameDelayLeftTest, ReturnFrameDelayLeft) {
   long* frameDelayLeft = s21::getFrameDelayLeft();
   EXPECT_NE(frameDelayLeft, nullptr);
   EXPECT_EQ(*frameDelayLeft, FRAME_DELAY_NANO);
-}
\ No newline at end of file
+}
+
+TEST(GetTickTimeoutTest, ReturnTimeUntilNextStep) {
+  s21::Game& game = s21::Game::getGame();
+  game.resetGame();
+
+  long timeout = s21::getTickTimeout();
+  EXPECT_GE(timeout, 0);
+  EXPECT_LE(timeout, FRAME_DELAY_NANO);
+
+  game.setLastActionTime(std::chrono::steady_clock::now() -
+                         std::chrono::seconds(2));
+  EXPECT_EQ(s21::getTickTimeout(), 0);
+
+  userInput(Pause, 0);
+  EXPECT_EQ(s21::getTickTimeout(), -1);
+  userInput(Pause, 0);
+}
@@ -0,0 +1,29 @@
+#include "../brick_game/common/perf_counters.h"
+
+#include "test.h"
+
+TEST(PerfCountersTest, CountAvailableEvents) {
+  PerfCounters counters;
+  int opened = openPerfCounters(&counters);
+  int available = 0;
+  for (int i = 0; i < PERF_COUNTERS; i++)
+    available += perfCounterAvailable(&counters, i);
+  EXPECT_EQ(available, opened);
+
+  startPerfCounters(&counters);
+  volatile unsigned long sum = 0;
+  for (unsigned long i = 0; i < 100000; i++) sum = sum + i;
+  stopPerfCounters(&counters);
+  for (int i = 0; i < PERF_COUNTERS; i++)
+    EXPECT_TRUE(perfCounterAvailable(&counters, i) || !counters.values[i]);
+  // Если ядро дает считать инструкции, цикл выше их не меньше 100000
+  if (perfCounterAvailable(&counters, PERF_INSTRUCTIONS)) {
+    EXPECT_GE(counters.values[PERF_INSTRUCTIONS], 100000u);
+  }
+
+  closePerfCounters(&counters);
+  for (int i = 0; i < PERF_COUNTERS; i++) {
+    EXPECT_FALSE(perfCounterAvailable(&counters, i));
+  }
+  EXPECT_STREQ(perfCounterName(PERF_CYCLES), "cycles");
+}
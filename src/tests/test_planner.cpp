@@ -0,0 +1,96 @@
+#include <atomic>
+
+#include "../brick_game/snake/hamiltonian.h"
+#include "../brick_game/snake/planner.h"
+#include "test.h"
+
+namespace {
+
+struct PoolContext {
+  std::atomic<int> hits[1000];
+  std::atomic<unsigned int> workers;
+};
+
+void countHit(void* context, unsigned int index, unsigned int worker) {
+  PoolContext* pool = static_cast<PoolContext*>(context);
+  // Неравные задачи: потокам есть что перехватывать
+  if (index < 10) std::this_thread::sleep_for(std::chrono::milliseconds(2));
+  pool->hits[index]++;
+  pool->workers |= 1u << worker;
+}
+
+}  // namespace
+
+TEST(WorkPoolTest, RunsEveryTaskOnce) {
+  s21::WorkPool pool(4);
+  EXPECT_EQ(pool.getThreads(), 4u);
+  static PoolContext context;
+  for (int round = 0; round < 3; round++) {
+    for (std::atomic<int>& hit : context.hits) hit = 0;
+    context.workers = 0;
+    pool.run(countHit, &context, 1000);
+    for (std::atomic<int>& hit : context.hits) ASSERT_EQ(hit, 1);
+    EXPECT_TRUE(context.workers & 1u);
+  }
+  EXPECT_GT(pool.getSteals(), 0u);
+  pool.run(countHit, &context, 0);
+}
+
+TEST(PlannerTest, AdvanceStateMatchesGame) {
+  s21::Game& game = s21::Game::getGame();
+  game.seed(RANDOM_DEFAULT_SEED);
+  game.resetGame();
+  s21::SnakeState state = game.snapshot();
+  s21::HamiltonianSolver solver;
+  for (int tick = 0; tick < 2000 && game.getPlaying() == s21::PLAYING;
+       tick++) {
+    s21::Snake::Direction direction = solver.decide(game);
+    game.getSnake().setDirection(direction);
+    game.step(std::chrono::steady_clock::time_point::max());
+    state.snake.setDirection(direction);
+    s21::advanceState(state);
+    s21::SnakeState expected = game.snapshot();
+    ASSERT_EQ(std::memcmp(&state.field, &expected.field, sizeof(s21::Field)),
+              0);
+    ASSERT_EQ(state.snake.getLength(), expected.snake.getLength());
+    EXPECT_EQ(state.snake.getHead(), expected.snake.getHead());
+    EXPECT_EQ(state.appleX, expected.appleX);
+    EXPECT_EQ(state.appleY, expected.appleY);
+    EXPECT_EQ(state.score, expected.score);
+    EXPECT_EQ(state.speed, expected.speed);
+    EXPECT_EQ(state.random, expected.random);
+    EXPECT_EQ(state.tick, expected.tick);
+    EXPECT_EQ(state.playing, expected.playing);
+  }
+  EXPECT_GT(state.score, 20);
+  game.resetGame();
+}
+
+TEST(PlannerTest, EatsApplesWithoutDying) {
+  s21::Game& game = s21::Game::getGame();
+  game.seed(RANDOM_DEFAULT_SEED);
+  game.resetGame();
+  s21::MonteCarloPlanner planner(2, 192, PLANNER_DEPTH,
+                                 std::chrono::seconds(1));
+  for (int tick = 0; tick < 400 && game.getGameInfo().score < 10; tick++) {
+    game.getSnake().setDirection(planner.decide(game));
+    game.step(std::chrono::steady_clock::now());
+    ASSERT_EQ(game.getPlaying(), s21::PLAYING);
+  }
+  EXPECT_GE(game.getGameInfo().score, 10);
+  EXPECT_EQ(planner.getPlayouts(), planner.getDecisions() * 3 * 2 * 32);
+  EXPECT_EQ(planner.getSkipped(), 0u);
+  game.resetGame();
+}
+
+TEST(PlannerTest, SkipsWorkAfterBudget) {
+  s21::Game& game = s21::Game::getGame();
+  game.resetGame();
+  s21::MonteCarloPlanner planner(1, PLANNER_PLAYOUTS, PLANNER_DEPTH,
+                                 std::chrono::nanoseconds(0));
+  s21::Snake::Direction direction = planner.decide(game);
+  EXPECT_FALSE(game.getSnake().isOpposite(direction));
+  EXPECT_EQ(planner.getPlayouts(), 0u);
+  EXPECT_GT(planner.getSkipped(), 0u);
+  game.resetGame();
+}
@@ -0,0 +1,156 @@
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "test.h"
+
+#define REPLAY_PATH "test_replay.bin"
+#define REPLAY_TICKS 600
+#define REPLAY_SEED 12
+
+namespace {
+
+std::vector<s21::SnakeState> recordSession() {
+  s21::Game& game = s21::Game::getGame();
+  std::vector<s21::SnakeState> states(REPLAY_TICKS + 1);
+  EXPECT_TRUE(game.startRecording(REPLAY_PATH, REPLAY_SEED));
+  states[0] = game.snapshot();
+  for (int tick = 1; tick <= REPLAY_TICKS; tick++) {
+    userInput(chooseTurn(game.getSnake().getHead()), 0);
+    if (tick == 100) userInput(Action, 0);
+    s21::stepReplay();
+    states[tick] = game.snapshot();
+  }
+  game.stopRecording();
+  return states;
+}
+
+void expectSameState(const s21::SnakeState& a, const s21::SnakeState& b) {
+  EXPECT_EQ(a.tick, b.tick);
+  ASSERT_EQ(a.snake.getLength(), b.snake.getLength());
+  for (size_t i = 0; i < a.snake.getLength(); i++)
+    EXPECT_EQ(a.snake.getSegment(i), b.snake.getSegment(i));
+  for (int i = 0; i < FIELD_HEIGHT; i++)
+    for (int j = 0; j < FIELD_WIDTH; j++)
+      EXPECT_EQ(a.field.getBlock(j, i), b.field.getBlock(j, i));
+  EXPECT_EQ(a.snake.getDirection(), b.snake.getDirection());
+  EXPECT_EQ(a.appleX, b.appleX);
+  EXPECT_EQ(a.appleY, b.appleY);
+  EXPECT_EQ(a.score, b.score);
+  EXPECT_EQ(a.random, b.random);
+  EXPECT_EQ(a.playing, b.playing);
+  EXPECT_EQ(a.boost, b.boost);
+}
+
+}  // namespace
+
+TEST(ReplayTest, SeekRestoresRecordedState) {
+  std::vector<s21::SnakeState> states = recordSession();
+  ASSERT_EQ(states.back().playing, s21::PLAYING);
+  EXPECT_GT(states.back().score, 0);
+
+  ReplayReader reader;
+  ASSERT_EQ(openReplayReader(&reader, REPLAY_PATH), 0);
+  EXPECT_EQ(reader.header.game, REPLAY_SNAKE);
+  EXPECT_EQ(reader.header.seed, static_cast<uint32_t>(REPLAY_SEED));
+  EXPECT_EQ(reader.ticks, static_cast<uint32_t>(REPLAY_TICKS));
+  EXPECT_EQ(reader.keyframes, REPLAY_TICKS / REPLAY_KEYFRAME_INTERVAL + 1u);
+
+  ReplayEngine engine = {s21::loadReplayState, userInput, s21::stepReplay,
+                         s21::getReplayTickInterval, s21::getReplayChecksum};
+  s21::Game& game = s21::Game::getGame();
+  for (uint32_t tick : {0u, 1u, 255u, 256u, 300u, 599u, 600u, 10u, 520u}) {
+    ASSERT_EQ(seekReplay(&reader, &engine, tick), 0);
+    expectSameState(game.snapshot(), states[tick]);
+  }
+
+  closeReplayReader(&reader);
+  std::remove(REPLAY_PATH);
+  game.resetGame();
+}
+
+TEST(ReplayTest, FindNearestKeyframe) {
+  recordSession();
+  ReplayReader reader;
+  ASSERT_EQ(openReplayReader(&reader, REPLAY_PATH), 0);
+  EXPECT_EQ(findReplayKeyframe(&reader, 0).tick, 0u);
+  EXPECT_EQ(findReplayKeyframe(&reader, 255).tick, 0u);
+  EXPECT_EQ(findReplayKeyframe(&reader, 256).tick, 256u);
+  EXPECT_EQ(findReplayKeyframe(&reader, 599).tick, 512u);
+  closeReplayReader(&reader);
+  std::remove(REPLAY_PATH);
+  s21::Game::getGame().resetGame();
+}
+
+TEST(ReplayTest, RejectInvalidFile) {
+  ReplayReader reader;
+  EXPECT_EQ(openReplayReader(&reader, "missing_replay.bin"), -1);
+
+  std::FILE* file = std::fopen(REPLAY_PATH, "wb");
+  std::fputs("not a replay file, just some text long enough", file);
+  std::fclose(file);
+  EXPECT_EQ(openReplayReader(&reader, REPLAY_PATH), -1);
+  std::remove(REPLAY_PATH);
+}
+
+TEST(ReplayTest, DetectsDesync) {
+  recordSession();
+  std::FILE* file = std::fopen(REPLAY_PATH, "rb");
+  std::vector<unsigned char> data(1 << 20);
+  data.resize(std::fread(data.data(), 1, data.size(), file));
+  std::fclose(file);
+
+  // Порча контрольной суммы после шага 300
+  size_t position = sizeof(ReplayHeader);
+  ReplayRecord record = {};
+  while (record.type != REPLAY_CHECKSUM || record.tick != 300) {
+    position += record.type == REPLAY_KEYFRAME ? sizeof(s21::SnakeState) : 0;
+    position += record.type == REPLAY_CHECKSUM ? sizeof(uint64_t) : 0;
+    ASSERT_LT(position, data.size());
+    std::memcpy(&record, &data[position], sizeof(record));
+    position += sizeof(record);
+  }
+  data[position] ^= 1;
+  file = std::fopen(REPLAY_PATH, "wb");
+  std::fwrite(data.data(), 1, data.size(), file);
+  std::fclose(file);
+
+  ReplayReader reader;
+  ASSERT_EQ(openReplayReader(&reader, REPLAY_PATH), 0);
+  ReplayEngine engine = {s21::loadReplayState, userInput, s21::stepReplay,
+                         s21::getReplayTickInterval, s21::getReplayChecksum};
+  EXPECT_EQ(seekReplay(&reader, &engine, 300), REPLAY_OK);
+  EXPECT_EQ(seekReplay(&reader, &engine, 301), REPLAY_DESYNC);
+  EXPECT_EQ(reader.desyncTick, 300u);
+  // Без сверки сумм запись проигрывается как раньше
+  engine.checksum = nullptr;
+  EXPECT_EQ(seekReplay(&reader, &engine, 0), REPLAY_OK);
+  EXPECT_EQ(seekReplay(&reader, &engine, 600), REPLAY_OK);
+  closeReplayReader(&reader);
+  std::remove(REPLAY_PATH);
+  s21::Game::getGame().resetGame();
+}
+
+TEST(ReplayTest, ChecksumFollowsState) {
+  s21::Game& game = s21::Game::getGame();
+  game.seed(REPLAY_SEED);
+  game.resetGame();
+  s21::SnakeState state = game.snapshot();
+  uint64_t previous = game.getChecksum();
+  for (int tick = 0; tick < 100; tick++) {
+    userInput(chooseTurn(game.getSnake().getHead()), 0);
+    s21::stepReplay();
+    uint64_t checksum = game.getChecksum();
+    EXPECT_NE(checksum, previous);
+    previous = checksum;
+  }
+  // Поле, заполненное заново теми же блоками, дает тот же хеш
+  s21::Field field;
+  for (int i = 0; i < FIELD_HEIGHT; i++)
+    for (int j = 0; j < FIELD_WIDTH; j++)
+      field.setBlock(j, i, game.getField().getBlock(j, i));
+  EXPECT_EQ(field.getHash(), game.getField().getHash());
+  ASSERT_TRUE(game.rewind(100));
+  EXPECT_EQ(game.getChecksum(), s21::checksumState(state));
+  game.resetGame();
+}
@@ -0,0 +1,192 @@
+#include <gtest/gtest.h>
+#include <sys/socket.h>
+
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "../server/session_client.h"
+#include "../server/session_server.h"
+
+#define TEST_SOCKET "test_session.sock"
+
+namespace {
+
+/**
+ * Сервер на отдельном потоке на время теста
+ */
+class SessionServerTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    server_.reset(new s21::SessionServer(TEST_SOCKET, 2));
+    ASSERT_TRUE(server_->open());
+    thread_ = std::thread(&s21::SessionServer::run, server_.get());
+  }
+
+  void TearDown() override {
+    if (thread_.joinable()) {
+      server_->stop();
+      thread_.join();
+    }
+    server_.reset();
+  }
+
+  std::unique_ptr<s21::SessionServer> server_;
+  std::thread thread_;
+};
+
+/**
+ * Та же партия, что на сервере, но в памяти теста
+ */
+struct LocalGame {
+  LocalGame(const SessionEngine* engine, uint32_t seed)
+      : engine(engine), state(new unsigned char[engine->stateSize]) {
+    engine->start(state.get(), seed);
+  }
+
+  LocalGame(const LocalGame& other)
+      : engine(other.engine), state(new unsigned char[engine->stateSize]) {
+    std::memcpy(state.get(), other.state.get(), engine->stateSize);
+  }
+
+  SessionView render() const {
+    SessionView view = {};
+    engine->render(state.get(), &view);
+    return view;
+  }
+
+  const SessionEngine* engine;
+  std::unique_ptr<unsigned char[]> state;
+};
+
+/**
+ * Номер клетки головы змейки в кадре
+ */
+int findHead(const SessionView& view) {
+  for (int i = 0; i < SESSION_CELLS; i++)
+    if (view.cells[i] == 2) return i;
+  return -1;
+}
+
+}  // namespace
+
+TEST_F(SessionServerTest, KeyframeAndDeltaMatchLocalGame) {
+  SessionClient client;
+  ASSERT_EQ(connectSession(&client, TEST_SOCKET, SESSION_TETRIS, 7), 0);
+  ASSERT_EQ(receiveSessionFrame(&client, 1000), 1);
+  LocalGame local(getTetrisSessionEngine(), 7);
+  SessionView view = local.render();
+  EXPECT_EQ(std::memcmp(client.view.cells, view.cells, SESSION_CELLS), 0);
+  EXPECT_EQ(client.view.next, view.next);
+  EXPECT_EQ(client.view.state, SESSION_PLAYING);
+
+  // Такт мог прийти раньше ввода отдельным кадром или в одном кадре с ним:
+  // каждый кадр сверяется с моделью, где ввод либо применен перед тактами
+  // кадра, либо еще не пришел
+  ASSERT_EQ(sendSessionInput(&client, Down), 0);
+  uint32_t ticks = 0;
+  bool applied = false;
+  for (int frame = 0; frame < 3 && !applied; frame++) {
+    ASSERT_EQ(receiveSessionFrame(&client, 2000), 1);
+    LocalGame input(local);
+    input.engine->input(input.state.get(), Down);
+    for (uint32_t i = ticks; i < client.view.tick; i++) {
+      input.engine->tick(input.state.get());
+      local.engine->tick(local.state.get());
+    }
+    ticks = client.view.tick;
+    view = input.render();
+    applied = !std::memcmp(client.view.cells, view.cells, SESSION_CELLS);
+    if (!applied) {
+      view = local.render();
+      ASSERT_EQ(std::memcmp(client.view.cells, view.cells, SESSION_CELLS), 0);
+    }
+  }
+  EXPECT_TRUE(applied);
+
+  ASSERT_EQ(sendSessionInput(&client, Pause), 0);
+  ASSERT_EQ(receiveSessionFrame(&client, 1000), 1);
+  EXPECT_TRUE(client.view.paused);
+  closeSession(&client);
+}
+
+TEST_F(SessionServerTest, SnakeTicksOnDeadline) {
+  SessionClient client;
+  ASSERT_EQ(connectSession(&client, TEST_SOCKET, SESSION_SNAKE, 3), 0);
+  ASSERT_EQ(receiveSessionFrame(&client, 1000), 1);
+  EXPECT_EQ(client.view.tick, 0u);
+  ASSERT_EQ(receiveSessionFrame(&client, 2000), 1);
+  EXPECT_EQ(client.view.tick, 1u);
+  LocalGame local(getSnakeSessionEngine(), 3);
+  local.engine->tick(local.state.get());
+  SessionView view = local.render();
+  EXPECT_EQ(std::memcmp(client.view.cells, view.cells, SESSION_CELLS), 0);
+  EXPECT_EQ(client.view.score, view.score);
+  closeSession(&client);
+}
+
+TEST(SnakeSessionTest, TurnsWithinOneTickAreKept) {
+  LocalGame local(getSnakeSessionEngine(), 3);
+  local.engine->tick(local.state.get());
+  int head = findHead(local.render());
+  ASSERT_GE(head, 0);
+  // Разворот из двух поворотов за один такт: влево, затем вниз
+  local.engine->input(local.state.get(), Left);
+  local.engine->input(local.state.get(), Down);
+  local.engine->tick(local.state.get());
+  EXPECT_EQ(findHead(local.render()), head - 1);
+  local.engine->tick(local.state.get());
+  EXPECT_EQ(findHead(local.render()), head - 1 + SESSION_WIDTH);
+}
+
+TEST(SnakeSessionTest, RestartContinuesGenerator) {
+  LocalGame first(getSnakeSessionEngine(), 1);
+  LocalGame second(getSnakeSessionEngine(), 2);
+  first.engine->restart(first.state.get());
+  second.engine->restart(second.state.get());
+  SessionView a = first.render(), b = second.render();
+  EXPECT_NE(std::memcmp(a.cells, b.cells, SESSION_CELLS), 0);
+}
+
+TEST(SnakeSessionTest, ActionBoostsInterval) {
+  LocalGame local(getSnakeSessionEngine(), 3);
+  long interval = local.engine->interval(local.state.get());
+  local.engine->input(local.state.get(), Action);
+  EXPECT_LT(local.engine->interval(local.state.get()), interval);
+  local.engine->input(local.state.get(), Action);
+  EXPECT_EQ(local.engine->interval(local.state.get()), interval);
+}
+
+TEST_F(SessionServerTest, BurstOfRequestsIsNotDropped) {
+  SessionClient client;
+  ASSERT_EQ(connectSession(&client, TEST_SOCKET, SESSION_TETRIS, 1), 0);
+  ASSERT_EQ(receiveSessionFrame(&client, 1000), 1);
+  // Больше двух очередей сообщений за раз; нечетное число пауз оставляет
+  // партию на паузе, только если ни одно сообщение не потеряно
+  std::vector<SessionRequest> burst(SESSION_INPUT_QUEUE * 2 + 1,
+                                    {SESSION_INPUT, 0, Pause, 0, 0});
+  size_t size = burst.size() * sizeof(SessionRequest);
+  ASSERT_EQ(send(client.fd, burst.data(), size, 0), ssize_t(size));
+  while (receiveSessionFrame(&client, 200) == 1) {
+  }
+  EXPECT_TRUE(client.view.paused);
+  closeSession(&client);
+}
+
+TEST_F(SessionServerTest, SessionsAreCountedAndDropped) {
+  std::vector<SessionClient> clients(8);
+  for (size_t i = 0; i < clients.size(); i++) {
+    SessionGame_t game = i % 2 ? SESSION_SNAKE : SESSION_TETRIS;
+    ASSERT_EQ(connectSession(&clients[i], TEST_SOCKET, game, i), 0);
+    ASSERT_EQ(receiveSessionFrame(&clients[i], 1000), 1);
+    EXPECT_TRUE(clients[i].view.state == SESSION_PLAYING);
+  }
+  EXPECT_EQ(server_->getSessions(), clients.size());
+  EXPECT_EQ(server_->getThreads(), 2u);
+  for (SessionClient& client : clients) closeSession(&client);
+  for (int i = 0; i < 100 && server_->getSessions(); i++)
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  EXPECT_EQ(server_->getSessions(), 0u);
+}
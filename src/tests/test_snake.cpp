@@ -3,11 +3,9 @@
 TEST(SnakeTest, Constructor) {
   s21::Snake snake;
 
-  std::deque<std::pair<int, int>> expectedBody = {{START_X, START_Y},
-                                                  {START_X, START_Y + 1},
-                                                  {START_X, START_Y + 2},
-                                                  {START_X, START_Y + 3}};
-  EXPECT_EQ(snake.getBody(), expectedBody);
+  ASSERT_EQ(snake.getLength(), 4u);
+  for (int i = 0; i < 4; i++)
+    EXPECT_EQ(snake.getSegment(i), std::make_pair(START_X, START_Y + i));
 
   EXPECT_EQ(snake.getDirection(), s21::Snake::Direction::Up);
 
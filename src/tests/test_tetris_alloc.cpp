@@ -0,0 +1,38 @@
+#include <gtest/gtest.h>
+
+#include "alloc_counter.h"
+
+extern "C" {
+#include "../brick_game/tetris/tetris.h"
+}
+
+TEST(AllocTest, TetrisSteadyState) {
+  seedGame(RANDOM_DEFAULT_SEED);
+  Game* game = getGame();
+  int score = 0;
+
+  startAllocCounting();
+  for (int figure = 0; figure < 200; figure++) {
+    // Нижняя строка заполнена, поэтому каждое падение стирает линию
+    memset(game->field.blocks, 0, sizeof(game->field.blocks));
+    memset(game->field.blocks + (FIELD_HEIGHT - 1) * FIELD_WIDTH, 1,
+           FIELD_WIDTH);
+    userInput(Left, 0);
+    userInput(Action, 0);
+    userInput(Right, 0);
+    userInput(Pause, 0);
+    userInput(Pause, 0);
+    stepGame();
+    *getFrameDelayLeft() = 0;
+    updateCurrentState();
+    userInput(Down, 0);
+    score += game->score;
+  }
+  unsigned long allocs = stopAllocCounting();
+  if (allocs) printAllocSites(stderr);
+  EXPECT_EQ(allocs, 0u);
+
+  EXPECT_EQ(game->playing, PLAYING);
+  EXPECT_GT(score, 0);
+  resetSingletones();
+}
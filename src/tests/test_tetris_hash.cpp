@@ -0,0 +1,166 @@
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <thread>
+
+#include "../brick_game/common/transposition.h"
+
+extern "C" {
+#include "../brick_game/tetris/tetris.h"
+}
+
+namespace {
+
+/**
+ * Сверка хешей, обновленных по ходу игры, с посчитанными с нуля
+ */
+void expectHashesFresh() {
+  Game* game = getGame();
+  ASSERT_EQ(game->fieldHash, hashField(&game->field));
+  ASSERT_EQ(game->figureHash, hashFigure(&game->figure));
+}
+
+/**
+ * Запись и чтение своих ключей из нескольких потоков: найденная оценка
+ * всегда принадлежит искомому ключу
+ */
+void hammerTable(TranspositionTable* table, uint64_t first) {
+  for (uint64_t i = 0; i < 100000; i++) {
+    uint64_t key = zobristKey(first + i % 4096);
+    storeTransposition(table, key, static_cast<double>(key >> 11));
+    double value;
+    if (probeTransposition(table, key, &value)) {
+      ASSERT_EQ(value, static_cast<double>(key >> 11));
+    }
+  }
+}
+
+}  // namespace
+
+TEST(TetrisHashTest, IncrementalMatchesRecompute) {
+  seedGame(RANDOM_DEFAULT_SEED);
+  expectHashesFresh();
+  Game* game = getGame();
+  for (int figure = 0; figure < 200 && game->playing == PLAYING; figure++) {
+    userInput(figure % 3 ? Left : Right, 0);
+    expectHashesFresh();
+    if (figure % 2) userInput(Action, 0);
+    expectHashesFresh();
+    stepGame();
+    expectHashesFresh();
+    userInput(Down, 0);
+    expectHashesFresh();
+  }
+
+  // Горизонтальная палка в столбцах 3-6 достраивает нижнюю строку
+  resetSingletones();
+  for (int x = 0; x < FIELD_WIDTH; x++)
+    if (x < 3 || x > 6)
+      game->field.blocks[(FIELD_HEIGHT - 1) * FIELD_WIDTH + x] = 2;
+  game->field.blocks[(FIELD_HEIGHT - 2) * FIELD_WIDTH] = 3;
+  std::memcpy(game->figure.blocks, getFigureFromTemplate(0), FIGURE_AREA);
+  rehashGame(game);
+  userInput(Down, 0);
+  EXPECT_EQ(game->score, 100);
+  EXPECT_EQ(game->field.blocks[(FIELD_HEIGHT - 1) * FIELD_WIDTH], 3);
+  expectHashesFresh();
+  resetSingletones();
+}
+
+TEST(TetrisHashTest, SamePositionSameHash) {
+  seedGame(RANDOM_DEFAULT_SEED);
+  uint64_t start = getGameHash();
+  userInput(Left, 0);
+  userInput(Action, 0);
+  uint64_t leftFirst = getGameHash();
+  userInput(Right, 0);
+  EXPECT_NE(getGameHash(), leftFirst);
+  userInput(Left, 0);
+  EXPECT_EQ(getGameHash(), leftFirst);
+
+  seedGame(RANDOM_DEFAULT_SEED);
+  EXPECT_EQ(getGameHash(), start);
+  userInput(Action, 0);
+  userInput(Left, 0);
+  EXPECT_EQ(getGameHash(), leftFirst);
+
+  // Снимок в кольце отката хранит хеш вместе с позицией
+  stepGame();
+  uint64_t stepped = getGameHash();
+  stepGame();
+  EXPECT_NE(getGameHash(), stepped);
+  ASSERT_EQ(rewindGame(1), 0);
+  EXPECT_EQ(getGameHash(), stepped);
+  resetSingletones();
+}
+
+TEST(TetrisHashTest, ChecksumFollowsState) {
+  uint64_t checksums[2][50];
+  for (int run = 0; run < 2; run++) {
+    seedGame(RANDOM_DEFAULT_SEED);
+    for (int tick = 0; tick < 50; tick++) {
+      userInput(tick % 3 ? Left : Action, 0);
+      stepGame();
+      checksums[run][tick] = getGameChecksum();
+      if (tick) {
+        EXPECT_NE(checksums[run][tick], checksums[run][tick - 1]);
+      }
+    }
+  }
+  EXPECT_EQ(std::memcmp(checksums[0], checksums[1], sizeof(checksums[0])), 0);
+  // Пауза и генератор входят в сумму
+  userInput(Pause, 0);
+  EXPECT_NE(getGameChecksum(), checksums[1][49]);
+  userInput(Pause, 0);
+  EXPECT_EQ(getGameChecksum(), checksums[1][49]);
+  ASSERT_EQ(rewindGame(10), 0);
+  EXPECT_EQ(getGameChecksum(), checksums[1][39]);
+  resetSingletones();
+}
+
+TEST(TetrisHashTest, GenerationFollowsChanges) {
+  seedGame(RANDOM_DEFAULT_SEED);
+  unsigned long generation = *getGeneration();
+  // Упор в левую стенку: последние сдвиги игру не меняют
+  for (int i = 0; i < FIELD_WIDTH; i++) userInput(Left, 0);
+  unsigned long moved = *getGeneration();
+  EXPECT_GT(moved, generation);
+  EXPECT_LT(moved, generation + FIELD_WIDTH);
+  userInput(Left, 0);
+  userInput(Up, 0);
+  EXPECT_EQ(*getGeneration(), moved);
+  userInput(Pause, 0);
+  userInput(Left, 0);
+  EXPECT_EQ(*getGeneration(), moved + 1);
+  userInput(Pause, 0);
+  EXPECT_EQ(*getGeneration(), moved + 2);
+  resetSingletones();
+}
+
+TEST(TranspositionTest, StoresAndProbes) {
+  TranspositionTable* table = createTranspositionTable(4);
+  ASSERT_NE(table, nullptr);
+  double value = 1;
+  EXPECT_FALSE(probeTransposition(table, 0, &value));
+  storeTransposition(table, 0, -2.5);
+  ASSERT_TRUE(probeTransposition(table, 0, &value));
+  EXPECT_EQ(value, -2.5);
+  // Ключ из того же слота вытесняет прежний
+  storeTransposition(table, 16, 7);
+  EXPECT_FALSE(probeTransposition(table, 0, &value));
+  ASSERT_TRUE(probeTransposition(table, 16, &value));
+  EXPECT_EQ(value, 7);
+  clearTranspositionTable(table);
+  EXPECT_FALSE(probeTransposition(table, 16, &value));
+  freeTranspositionTable(table);
+}
+
+TEST(TranspositionTest, SharedBetweenThreads) {
+  TranspositionTable* table = createTranspositionTable(8);
+  std::thread first(hammerTable, table, 0);
+  std::thread second(hammerTable, table, 1000);
+  hammerTable(table, 2000);
+  first.join();
+  second.join();
+  freeTranspositionTable(table);
+}
@@ -0,0 +1,71 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <thread>
+
+extern "C" {
+#include "../brick_game/tetris/tetris.h"
+}
+
+#define TETRIS_HIGH_SCORE_PATH "tetris_high_score.bin"
+#define TETRIS_HIGH_SCORE_BACKUP "tetris_high_score.bin.bak"
+
+namespace {
+
+/**
+ * Партия со сдвигами в разные стороны до конца игры
+ */
+void playScript(unsigned int seed, int* score, unsigned int* tick) {
+  seedGame(seed);
+  Game* game = getGame();
+  for (int figure = 0; figure < 500 && game->playing == PLAYING; figure++) {
+    userInput(figure % 3 ? Left : Right, 0);
+    if (figure % 2) userInput(Action, 0);
+    stepGame();
+    userInput(Down, 0);
+  }
+  *score = game->score;
+  *tick = game->tick;
+  freeSingletones();
+}
+
+}  // namespace
+
+TEST(TetrisThreadsTest, GamesArePerThread) {
+  seedGame(RANDOM_DEFAULT_SEED);
+  stepGame();
+  unsigned int mainTick = getGame()->tick;
+
+  int scores[2];
+  unsigned int ticks[2];
+  std::thread first(playScript, 7, &scores[0], &ticks[0]);
+  std::thread second(playScript, 7, &scores[1], &ticks[1]);
+  first.join();
+  second.join();
+  EXPECT_EQ(scores[0], scores[1]);
+  EXPECT_EQ(ticks[0], ticks[1]);
+  EXPECT_GT(ticks[0], 1u);
+  EXPECT_EQ(getGame()->tick, mainTick);
+  resetSingletones();
+}
+
+TEST(TetrisThreadsTest, HighScoreSwitch) {
+  // Рекорд игрока переносится на время теста, а не удаляется
+  bool backedUp =
+      !std::rename(TETRIS_HIGH_SCORE_PATH, TETRIS_HIGH_SCORE_BACKUP);
+  *getSaveHighScore() = 0;
+  std::thread game([] {
+    seedGame(RANDOM_DEFAULT_SEED);
+    getGame()->score = 1000;
+    userInput(Terminate, 0);
+    EXPECT_EQ(getGame()->high_score, 1000);
+    freeSingletones();
+  });
+  game.join();
+  std::FILE* file = std::fopen(TETRIS_HIGH_SCORE_PATH, "rb");
+  if (file) std::fclose(file);
+  EXPECT_EQ(file, nullptr);
+  *getSaveHighScore() = 1;
+  std::remove(TETRIS_HIGH_SCORE_PATH);
+  if (backedUp) std::rename(TETRIS_HIGH_SCORE_BACKUP, TETRIS_HIGH_SCORE_PATH);
+}
@@ -0,0 +1,142 @@
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <vector>
+
+#include "alloc_counter.h"
+
+extern "C" {
+#include "../brick_game/tetris/tetris_vec.h"
+}
+
+namespace {
+
+/**
+ * Действие среды env на шаге step: сдвиги, повороты и редкие сбросы
+ */
+UserAction_t scriptAction(unsigned int env, int step) {
+  const UserAction_t actions[] = {Left, Right, Action, Up, Left, Down};
+  return actions[(env * 7 + step * 3) % 6];
+}
+
+/**
+ * Прогон пакета по сценарию, результат - наблюдения после каждого шага
+ */
+std::vector<TetrisObservation> runScript(unsigned int threads, int steps,
+                                         unsigned long* episodes) {
+  const unsigned int count = 16;
+  TetrisVec* vec = createTetrisVec(count, 5, threads);
+  std::vector<UserAction_t> actions(count);
+  std::vector<float> rewards(count);
+  std::vector<uint8_t> dones(count);
+  std::vector<TetrisObservation> observations(count * steps);
+  for (int step = 0; step < steps; step++) {
+    for (unsigned int env = 0; env < count; env++)
+      actions[env] = scriptAction(env, step);
+    stepTetrisVec(vec, actions.data(), rewards.data(), dones.data(),
+                  &observations[count * step]);
+  }
+  *episodes = getTetrisVecEpisodes(vec);
+  freeTetrisVec(vec);
+  return observations;
+}
+
+}  // namespace
+
+TEST(TetrisVecTest, ThreadsDoNotChangeResult) {
+  unsigned long single = 0, parallel = 0;
+  std::vector<TetrisObservation> first = runScript(1, 400, &single);
+  std::vector<TetrisObservation> second = runScript(4, 400, &parallel);
+  EXPECT_EQ(single, parallel);
+  EXPECT_GT(single, 0u);
+  EXPECT_EQ(std::memcmp(first.data(), second.data(),
+                        first.size() * sizeof(TetrisObservation)),
+            0);
+}
+
+TEST(TetrisVecTest, ResetsFinishedEpisodes) {
+  TetrisVec* vec = createTetrisVec(3, 9, 1);
+  UserAction_t actions[3] = {Down, Down, Down};
+  float rewards[3];
+  uint8_t dones[3];
+  TetrisObservation observations[3];
+  bool done = false;
+  for (int step = 0; step < 100 && !done; step++) {
+    stepTetrisVec(vec, actions, rewards, dones, observations);
+    done = dones[0];
+  }
+  ASSERT_TRUE(done);
+  EXPECT_EQ(getTetrisVecGame(vec, 0)->playing, PLAYING);
+  EXPECT_EQ(observations[0].score, 0);
+  for (int row = 0; row < FIELD_HEIGHT; row++)
+    EXPECT_EQ(observations[0].rows[row], 0);
+  EXPECT_GE(getTetrisVecEpisodes(vec), 1u);
+  resetTetrisVec(vec);
+  EXPECT_EQ(getTetrisVecEpisodes(vec), 0u);
+  freeTetrisVec(vec);
+}
+
+TEST(TetrisVecTest, ObservationMatchesGame) {
+  TetrisVec* vec = createTetrisVec(2, 3, 1);
+  TetrisPlacement placements[2] = {{1, 0}, {0, 5}};
+  float rewards[2];
+  uint8_t dones[2];
+  TetrisObservation observations[2];
+  for (int step = 0; step < 5; step++)
+    placeTetrisVec(vec, placements, rewards, dones, observations);
+  for (unsigned int env = 0; env < 2; env++) {
+    const Game* game = getTetrisVecGame(vec, env);
+    EXPECT_EQ(observations[env].x, game->figure.x);
+    EXPECT_EQ(observations[env].y, game->figure.y);
+    EXPECT_EQ(observations[env].score, game->score);
+    int blocks = 0;
+    for (int row = 0; row < FIELD_HEIGHT; row++)
+      for (int col = 0; col < FIELD_WIDTH; col++) {
+        bool block = observations[env].rows[row] >> col & 1;
+        EXPECT_EQ(block, game->field.blocks[row * FIELD_WIDTH + col] != 0);
+        blocks += block;
+      }
+    EXPECT_GT(blocks, 0);
+    for (int row = 0; row < FIGURE_SIZE; row++)
+      for (int col = 0; col < FIGURE_SIZE; col++)
+        EXPECT_EQ(observations[env].next[row] >> col & 1,
+                  game->next.blocks[row * FIGURE_SIZE + col] != 0);
+  }
+  freeTetrisVec(vec);
+}
+
+TEST(TetrisVecTest, OwnGameIsUntouched) {
+  seedGame(RANDOM_DEFAULT_SEED);
+  Game own = *getGame();
+  uint32_t random = *getRandomState();
+
+  TetrisVec* vec = createTetrisVec(8, 1, 2);
+  UserAction_t actions[8] = {Down, Down, Down, Down, Down, Down, Down, Down};
+  float rewards[8];
+  uint8_t dones[8];
+  for (int step = 0; step < 200; step++)
+    stepTetrisVec(vec, actions, rewards, dones, nullptr);
+  EXPECT_GT(getTetrisVecEpisodes(vec), 0u);
+  freeTetrisVec(vec);
+
+  EXPECT_EQ(std::memcmp(&own, getGame(), sizeof(Game)), 0);
+  EXPECT_EQ(*getRandomState(), random);
+  resetSingletones();
+}
+
+TEST(TetrisVecTest, StepDoesNotAllocate) {
+  TetrisVec* vec = createTetrisVec(4, 2, 1);
+  UserAction_t actions[4];
+  float rewards[4];
+  uint8_t dones[4];
+  TetrisObservation observations[4];
+  startAllocCounting();
+  for (int step = 0; step < 500; step++) {
+    for (unsigned int env = 0; env < 4; env++)
+      actions[env] = scriptAction(env, step);
+    stepTetrisVec(vec, actions, rewards, dones, observations);
+  }
+  unsigned long allocs = stopAllocCounting();
+  EXPECT_EQ(allocs, 0u);
+  freeTetrisVec(vec);
+}
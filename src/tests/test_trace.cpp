@@ -0,0 +1,57 @@
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include "test.h"
+
+#define TRACE_PATH "test_trace.json"
+
+namespace {
+
+int countOccurrences(const std::string& text, const std::string& pattern) {
+  int count = 0;
+  for (size_t i = text.find(pattern); i != std::string::npos;
+       i = text.find(pattern, i + 1))
+    count++;
+  return count;
+}
+
+}  // namespace
+
+TEST(TraceTest, DumpPerThreadSpans) {
+  setenv(TRACE_ENV, TRACE_PATH, 1);
+  ASSERT_TRUE(initTrace());
+  EXPECT_FALSE(initTrace());
+  setTraceThreadName("main");
+
+  TRACE_BEGIN("mainSpan");
+  std::thread worker([] {
+    setTraceThreadName("worker");
+    for (int i = 0; i < 3; i++) {
+      TRACE_BEGIN("workerSpan");
+      TRACE_END("workerSpan");
+    }
+  });
+  worker.join();
+  TRACE_END("mainSpan");
+  ASSERT_EQ(dumpTrace(), 0);
+
+  std::ifstream file(TRACE_PATH);
+  std::stringstream buffer;
+  buffer << file.rdbuf();
+  std::string trace = buffer.str();
+  EXPECT_EQ(trace.rfind("{\"displayTimeUnit\"", 0), 0u);
+  EXPECT_EQ(countOccurrences(trace, "\"name\":\"mainSpan\""), 2);
+  EXPECT_EQ(countOccurrences(trace, "\"name\":\"workerSpan\",\"ph\":\"B\""), 3);
+  EXPECT_EQ(countOccurrences(trace, "\"name\":\"workerSpan\",\"ph\":\"E\""), 3);
+  EXPECT_EQ(countOccurrences(trace, "\"args\":{\"name\":\"worker 2\"}"), 1);
+
+  freeTrace();
+  unsetenv(TRACE_ENV);
+  std::remove(TRACE_PATH);
+  EXPECT_EQ(dumpTrace(), -1);
+  EXPECT_FALSE(initTrace());
+}
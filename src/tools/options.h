@@ -0,0 +1,40 @@
+#ifndef OPTIONS_H
+#define OPTIONS_H
+
+#include <cstdlib>
+#include <cstring>
+
+/**
+ * Получение значения параметра командной строки
+ *
+ * @return значение, fallback - параметр не задан
+ */
+inline unsigned long parseNumber(int argc, char* argv[], const char* flag,
+                                 unsigned long fallback) {
+  for (int i = 1; i + 1 < argc; i++)
+    if (!std::strcmp(argv[i], flag)) return std::strtoul(argv[i + 1], 0, 10);
+  return fallback;
+}
+
+/**
+ * Получение строкового значения параметра командной строки
+ *
+ * @return значение, fallback - параметр не задан
+ */
+inline const char* parseString(int argc, char* argv[], const char* flag,
+                               const char* fallback) {
+  for (int i = 1; i + 1 < argc; i++)
+    if (!std::strcmp(argv[i], flag)) return argv[i + 1];
+  return fallback;
+}
+
+/**
+ * Проверка наличия флага командной строки без значения
+ */
+inline bool hasFlag(int argc, char* argv[], const char* flag) {
+  for (int i = 1; i < argc; i++)
+    if (!std::strcmp(argv[i], flag)) return true;
+  return false;
+}
+
+#endif  // OPTIONS_H
@@ -0,0 +1,43 @@
+#include <csignal>
+#include <cstdio>
+
+#include "../server/session_server.h"
+#include "options.h"
+
+#define SOCKET_FLAG "--socket"
+#define THREADS_FLAG "--threads"
+
+// Небольшой постоянный пул: поток обслуживает сотни сессий
+#define DEFAULT_THREADS 2
+
+namespace {
+
+s21::SessionServer* server = nullptr;
+
+/**
+ * Остановка сервера по SIGINT и SIGTERM
+ */
+void handleSignal(int) {
+  if (server) server->stop();
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  const char* path = parseString(argc, argv, SOCKET_FLAG, SESSION_SOCKET_PATH);
+  s21::SessionServer sessions(
+      path, parseNumber(argc, argv, THREADS_FLAG, DEFAULT_THREADS));
+  if (!sessions.open()) {
+    std::fprintf(stderr, "could not listen on %s\n", path);
+    return 1;
+  }
+  server = &sessions;
+  std::signal(SIGINT, handleSignal);
+  std::signal(SIGTERM, handleSignal);
+  std::printf("listening on %s with %u threads\n", path,
+              sessions.getThreads());
+  sessions.run();
+  server = nullptr;
+  std::printf("missed deadlines %lu\n", sessions.getMissedDeadlines());
+  return 0;
+}
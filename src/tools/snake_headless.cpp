@@ -0,0 +1,245 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <thread>
+
+#include "../brick_game/common/npy_writer.h"
+#include "../brick_game/common/perf_counters.h"
+#include "../brick_game/snake/autopilot.h"
+#include "../brick_game/snake/batch.h"
+#include "../brick_game/snake/hamiltonian.h"
+#include "../brick_game/snake/planner.h"
+#include "options.h"
+
+#define GAMES_FLAG "--games"
+#define SEED_FLAG "--seed"
+#define STALL_FLAG "--stall"
+#define SOLVER_FLAG "--solver"
+#define THREADS_FLAG "--threads"
+#define EXPORT_FLAG "--export"
+#define HAMILTONIAN_SOLVER "hamiltonian"
+#define MONTE_CARLO_SOLVER "montecarlo"
+
+#define DEFAULT_GAMES 100
+// Шагов без яблока, после которых игра считается зациклившейся
+#define DEFAULT_STALL (BOARD_CELLS * 4)
+
+namespace {
+
+/**
+ * Столбцы выгрузки: наблюдение перед шагом, выбранное направление,
+ * награда шага и конец партии
+ */
+enum ExportColumn {
+  EXPORT_BODY,
+  EXPORT_HEAD,
+  EXPORT_APPLE,
+  EXPORT_DIRECTION,
+  EXPORT_LENGTH,
+  EXPORT_ACTION,
+  EXPORT_REWARD,
+  EXPORT_DONE,
+  EXPORT_COLUMNS
+};
+
+const NpyColumn kExportColumns[EXPORT_COLUMNS] = {
+    {"body", "<u8", BATCH_WORDS}, {"head", "|u1", 1},   {"apple", "|u1", 1},
+    {"direction", "|u1", 1},      {"length", "<u2", 1}, {"action", "|u1", 1},
+    {"reward", "<f4", 1},         {"done", "|u1", 1}};
+
+/**
+ * Итоги прогона
+ */
+struct Summary {
+  unsigned long games;
+  unsigned long wins;
+  unsigned long stalls;
+  unsigned long ticks;
+  unsigned long score;
+  int bestScore;
+  uint64_t decideNs;
+  unsigned long decisions;
+};
+
+/**
+ * Запись шага в выгрузку
+ *
+ * @param observation наблюдение перед шагом
+ * @param action выбранное направление
+ * @param reward награда шага, как у SnakeBatch
+ * @param done 1 - партия закончилась на этом шаге
+ */
+void exportStep(NpyWriter* exporter, const s21::SnakeObservation& observation,
+                uint8_t action, float reward, uint8_t done) {
+  void* record = nextNpyRecord(exporter);
+  setNpyColumn(exporter, record, EXPORT_BODY, observation.body);
+  setNpyColumn(exporter, record, EXPORT_HEAD, &observation.head);
+  setNpyColumn(exporter, record, EXPORT_APPLE, &observation.apple);
+  setNpyColumn(exporter, record, EXPORT_DIRECTION, &observation.direction);
+  setNpyColumn(exporter, record, EXPORT_LENGTH, &observation.length);
+  setNpyColumn(exporter, record, EXPORT_ACTION, &action);
+  setNpyColumn(exporter, record, EXPORT_REWARD, &reward);
+  setNpyColumn(exporter, record, EXPORT_DONE, &done);
+}
+
+/**
+ * Сброс решателя перед новой игрой. Решатели без состояния между играми,
+ * как MonteCarloPlanner, reset() не имеют и пропускаются
+ */
+template <typename Solver>
+auto resetSolver(Solver& solver, int) -> decltype(solver.reset()) {
+  solver.reset();
+}
+
+template <typename Solver>
+void resetSolver(Solver&, long) {}
+
+/**
+ * Одна игра под управлением автопилота или решателя без интерфейса и без
+ * ожидания тактов. С выгрузкой каждый шаг пишется в exporter
+ */
+template <typename Solver>
+void playGame(s21::Game& game, Solver& autopilot, unsigned int seed,
+              unsigned long stallLimit, NpyWriter* exporter,
+              Summary* summary) {
+  game.seed(seed);
+  game.resetGame();
+  resetSolver(autopilot, 0);
+  unsigned long sinceApple = 0;
+  int score = 0;
+  s21::SnakeObservation observation;
+  while (game.getPlaying() == s21::PLAYING && sinceApple < stallLimit) {
+    if (exporter) s21::observeState(game.snapshot(), &observation);
+    uint64_t start = engineStatsNow();
+    s21::Snake::Direction direction = autopilot.decide(game);
+    summary->decideNs += engineStatsNow() - start;
+    game.getSnake().setDirection(direction);
+    game.step(std::chrono::steady_clock::time_point::max());
+    summary->ticks++;
+    sinceApple++;
+    bool ate = game.getGameInfo().score != score;
+    if (ate) {
+      score = game.getGameInfo().score;
+      sinceApple = 0;
+    }
+    if (exporter) {
+      int playing = game.getPlaying();
+      float reward = ate ? BATCH_APPLE_REWARD : 0;
+      if (playing == s21::GAMEOVER) reward = BATCH_DEATH_REWARD;
+      bool done = playing != s21::PLAYING || sinceApple >= stallLimit;
+      exportStep(exporter, observation, direction, reward, done);
+    }
+  }
+  summary->games++;
+  summary->wins += game.getPlaying() == s21::WIN;
+  summary->stalls += sinceApple >= stallLimit;
+  summary->score += score;
+  if (score > summary->bestScore) summary->bestScore = score;
+  summary->decisions = autopilot.getDecisions();
+}
+
+/**
+ * Прогон партий с замером аппаратных счетчиков
+ *
+ * @return время прогона в секундах
+ */
+template <typename Solver>
+double playGames(Solver& autopilot, unsigned long games, unsigned int seed,
+                 unsigned long stall, NpyWriter* exporter,
+                 PerfCounters* counters, Summary* summary) {
+  s21::Game& game = s21::Game::getGame();
+  uint64_t start = engineStatsNow();
+  startPerfCounters(counters);
+  for (unsigned long i = 0; i < games; i++)
+    playGame(game, autopilot, seed + i, stall, exporter, summary);
+  stopPerfCounters(counters);
+  return (engineStatsNow() - start) / 1e9;
+}
+
+}  // namespace
+
+/**
+ * Прогон партий змейки под управлением автопилота, а с параметром
+ * --solver hamiltonian - решателя по гамильтонову циклу, с параметром
+ * --solver montecarlo - планировщика Монте-Карло на --threads потоках.
+ * Печатает средний счет, скорость шагов и решений, а при заданной
+ * переменной окружения BRICK_GAME_PERF - аппаратные счетчики в пересчете на
+ * шаг. С параметром --export каждый шаг пишется в файл .npy: наблюдение
+ * перед шагом, направление, награда и конец партии
+ */
+int main(int argc, char* argv[]) {
+  unsigned long games = parseNumber(argc, argv, GAMES_FLAG, DEFAULT_GAMES);
+  unsigned int seed = parseNumber(argc, argv, SEED_FLAG, RANDOM_DEFAULT_SEED);
+  unsigned long stall = parseNumber(argc, argv, STALL_FLAG, DEFAULT_STALL);
+  const char* solverName = parseString(argc, argv, SOLVER_FLAG, "");
+  bool hamiltonian = !std::strcmp(solverName, HAMILTONIAN_SOLVER);
+  bool monteCarlo = !std::strcmp(solverName, MONTE_CARLO_SOLVER);
+  unsigned int threads = parseNumber(argc, argv, THREADS_FLAG,
+                                     std::thread::hardware_concurrency());
+  s21::Autopilot autopilot;
+  s21::HamiltonianSolver solver;
+  std::unique_ptr<s21::MonteCarloPlanner> planner;
+  if (monteCarlo) planner.reset(new s21::MonteCarloPlanner(threads));
+  Summary summary = {};
+  const char* exportPath = parseString(argc, argv, EXPORT_FLAG, nullptr);
+  NpyWriter* exporter = nullptr;
+  if (exportPath) {
+    exporter = openNpyWriter(exportPath, kExportColumns, EXPORT_COLUMNS,
+                             NPY_CHUNK_RECORDS);
+    if (!exporter) {
+      std::fprintf(stderr, "could not create %s\n", exportPath);
+      return 1;
+    }
+  }
+
+  PerfCounters counters = {{-1, -1, -1, -1, -1}, {}};
+  if (std::getenv(PERF_COUNTERS_ENV) && !openPerfCounters(&counters))
+    std::fprintf(stderr, "perf counters are not available\n");
+  double seconds;
+  if (monteCarlo)
+    seconds = playGames(*planner, games, seed, stall, exporter, &counters,
+                        &summary);
+  else if (hamiltonian)
+    seconds = playGames(solver, games, seed, stall, exporter, &counters,
+                        &summary);
+  else
+    seconds = playGames(autopilot, games, seed, stall, exporter, &counters,
+                        &summary);
+
+  std::printf("games          %lu\n", summary.games);
+  std::printf("wins           %lu\n", summary.wins);
+  std::printf("stalls         %lu\n", summary.stalls);
+  std::printf("average score  %.2f\n",
+              summary.games ? (double)summary.score / summary.games : 0.0);
+  std::printf("best score     %d\n", summary.bestScore);
+  std::printf("ticks          %lu\n", summary.ticks);
+  std::printf("ticks/sec      %.0f\n", summary.ticks / seconds);
+  std::printf("decisions/sec  %.0f\n",
+              summary.decideNs ? summary.decisions * 1e9 / summary.decideNs
+                               : 0.0);
+  if (monteCarlo) {
+    std::printf("threads        %u\n", planner->getPool().getThreads());
+    std::printf("playouts/sec   %.0f\n", planner->getPlayouts() / seconds);
+    std::printf("skipped tasks  %lu\n", planner->getSkipped());
+    std::printf("steals         %lu\n", planner->getPool().getSteals());
+  } else if (hamiltonian) {
+    std::printf("shortcuts      %lu\n", solver.getShortcuts());
+  } else {
+    std::printf("recomputes     %lu\n", autopilot.getRecomputes());
+  }
+  if (exporter) {
+    unsigned long records = getNpyRecords(exporter);
+    unsigned long stalls = getNpyStalls(exporter);
+    if (closeNpyWriter(exporter))
+      std::fprintf(stderr, "could not write %s\n", exportPath);
+    std::printf("exported       %lu records, %lu stalls\n", records, stalls);
+  }
+  if (std::getenv(PERF_COUNTERS_ENV)) {
+    std::printf("\nper tick:\n");
+    printPerfCounters(&counters, summary.ticks, stdout);
+  }
+  closePerfCounters(&counters);
+  return 0;
+}
@@ -0,0 +1,589 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../brick_game/common/npy_writer.h"
+#include "../brick_game/common/transposition.h"
+#include "../brick_game/common/work_pool.h"
+
+extern "C" {
+#include "../brick_game/tetris/tetris_vec.h"
+}
+
+#include "options.h"
+
+#define POPULATION_FLAG "--population"
+#define GAMES_FLAG "--games"
+#define GENERATIONS_FLAG "--generations"
+#define PIECES_FLAG "--pieces"
+#define THREADS_FLAG "--threads"
+#define SEED_FLAG "--seed"
+#define CHECKPOINT_FLAG "--checkpoint"
+#define RESUME_FLAG "--resume"
+#define EXPORT_FLAG "--export"
+
+#define DEFAULT_POPULATION 32
+#define DEFAULT_GAMES 8
+#define DEFAULT_GENERATIONS 10
+// Фигур в одной партии: хороший набор весов может играть бесконечно
+#define DEFAULT_PIECES 500
+#define DEFAULT_CHECKPOINT "tetris_tuner.txt"
+
+// Доля худших наборов, заменяемых потомками в каждом поколении
+#define REPLACE_SHARE 0.3
+// Доля популяции, из которой турниром выбирается родитель
+#define TOURNAMENT_SHARE 0.1
+#define MUTATION_CHANCE 0.05
+#define MUTATION_STEP 0.2
+
+namespace {
+
+/**
+ * Признаки поля после установки фигуры
+ */
+enum FEATURE {
+  FEATURE_HEIGHT,
+  FEATURE_LINES,
+  FEATURE_HOLES,
+  FEATURE_BUMPINESS,
+  FEATURES
+};
+
+const char* const kFeatureNames[FEATURES] = {"height", "lines", "holes",
+                                             "bumpiness"};
+
+/**
+ * Столбцы выгрузки: наблюдение перед установкой фигуры, выбранная
+ * установка, прирост очков и конец партии
+ */
+enum ExportColumn {
+  EXPORT_ROWS,
+  EXPORT_FIGURE,
+  EXPORT_NEXT,
+  EXPORT_X,
+  EXPORT_Y,
+  EXPORT_SCORE,
+  EXPORT_ROTATIONS,
+  EXPORT_COLUMN,
+  EXPORT_REWARD,
+  EXPORT_DONE,
+  EXPORT_COLUMNS
+};
+
+const NpyColumn kExportColumns[EXPORT_COLUMNS] = {
+    {"rows", "<u2", FIELD_HEIGHT}, {"figure", "|u1", FIGURE_SIZE},
+    {"next", "|u1", FIGURE_SIZE},  {"x", "|i1", 1},
+    {"y", "|i1", 1},               {"score", "<i4", 1},
+    {"rotations", "|u1", 1},       {"column", "|i1", 1},
+    {"reward", "<f4", 1},          {"done", "|u1", 1}};
+
+/**
+ * Набор весов и его результаты за поколение
+ */
+struct Individual {
+  double weights[FEATURES];
+  double fitness;
+  unsigned long lines;
+  unsigned long score;
+  unsigned long pieces;
+};
+
+/**
+ * Итог одной партии
+ */
+struct Result {
+  unsigned long lines;
+  unsigned long score;
+  unsigned long pieces;
+  unsigned long steps;
+  unsigned long evaluations;
+  unsigned long cached;
+};
+
+/**
+ * Данные поколения для задач пула: задача - одна партия одного набора
+ */
+struct Generation {
+  const std::vector<Individual>* population;
+  std::vector<Result>* results;
+  unsigned int games;
+  unsigned int pieces;
+  unsigned int seed;
+  TranspositionTable* table;
+};
+
+/**
+ * Случайное число от 0 до 1
+ */
+double uniform(uint32_t* random) { return nextRandom(random) / 4294967296.0; }
+
+/**
+ * Приведение вектора весов к единичной длине: веса сравнимы между собой, а
+ * выбор установки от длины вектора не зависит
+ */
+void normalize(double* weights) {
+  double length = 0;
+  for (int i = 0; i < FEATURES; i++) length += weights[i] * weights[i];
+  length = std::sqrt(length);
+  if (length > 0)
+    for (int i = 0; i < FEATURES; i++) weights[i] /= length;
+}
+
+/**
+ * Ключ набора весов: оценка позиции в таблице транспозиций зависит от
+ * весов, поэтому ключ набора входит в ключ записи
+ */
+uint64_t hashWeights(const double* weights) {
+  uint64_t hash = 0;
+  for (int i = 0; i < FEATURES; i++) {
+    uint64_t bits;
+    std::memcpy(&bits, &weights[i], sizeof(bits));
+    hash = zobristKey(hash ^ bits);
+  }
+  return hash;
+}
+
+/**
+ * Столкновение фигуры с границами и блоками поля, как в figureCollision()
+ */
+bool collides(const Field& field, const Figure& figure) {
+  for (int i = 0; i < figure.size; i++)
+    for (int j = 0; j < figure.size; j++) {
+      if (!figure.blocks[i * figure.size + j]) continue;
+      int x = figure.x + j, y = figure.y + i;
+      if (x < 0 || x >= field.width || y < 0 || y >= field.height ||
+          field.blocks[y * field.width + x])
+        return true;
+    }
+  return false;
+}
+
+/**
+ * Оценка поля после установки фигуры и стирания заполненных строк
+ *
+ * @param field поле с установленной фигурой
+ * @param weights веса признаков
+ *
+ * @return оценка, чем больше, тем лучше
+ */
+double evaluate(Field field, const double* weights) {
+  int lines = 0;
+  for (int row = field.height - 1; row >= 0; row--)
+    while (lineIsFull(row, &field)) {
+      shiftLine(row, &field);
+      lines++;
+    }
+  int heights[FIELD_WIDTH] = {};
+  int holes = 0;
+  for (int x = 0; x < field.width; x++) {
+    bool top = false;
+    for (int y = 0; y < field.height; y++) {
+      bool filled = field.blocks[y * field.width + x];
+      if (filled && !top) {
+        top = true;
+        heights[x] = field.height - y;
+      } else if (!filled && top) {
+        holes++;
+      }
+    }
+  }
+  int height = 0, bumpiness = 0;
+  for (int x = 0; x < field.width; x++) {
+    height += heights[x];
+    if (x) bumpiness += std::abs(heights[x] - heights[x - 1]);
+  }
+  return weights[FEATURE_HEIGHT] * height + weights[FEATURE_LINES] * lines +
+         weights[FEATURE_HOLES] * holes +
+         weights[FEATURE_BUMPINESS] * bumpiness;
+}
+
+/**
+ * Выбор установки текущей фигуры: перебор поворотов и столбцов со сбросом
+ * фигуры вниз на копии поля. Хеш поля после установки считается из хеша
+ * поля игры по ключам новых клеток; повторные позиции, например от
+ * симметричных поворотов или из прошлых партий того же набора, берутся
+ * из таблицы транспозиций без оценки
+ *
+ * @param weights веса признаков
+ * @param weightsKey ключ набора весов
+ * @param table таблица транспозиций
+ * @param rotations количество поворотов
+ * @param column столбец левого края фигуры
+ * @param result счетчики оценок партии
+ */
+void choosePlacement(const double* weights, uint64_t weightsKey,
+                     TranspositionTable* table, int* rotations, int* column,
+                     Result* result) {
+  Game* game = getGame();
+  Figure original = game->figure;
+  Figure shapes[4];
+  for (int r = 0; r < 4; r++) {
+    shapes[r] = game->figure;
+    game->figure = rotateFigure();
+  }
+  game->figure = original;
+  double best = -INFINITY;
+  *rotations = 0;
+  *column = original.x;
+  for (int r = 0; r < 4; r++)
+    for (int x = -FIGURE_SIZE; x < FIELD_WIDTH; x++) {
+      Figure figure = shapes[r];
+      figure.x = x;
+      if (collides(game->field, figure)) continue;
+      while (!collides(game->field, figure)) figure.y++;
+      figure.y--;
+      Field field = game->field;
+      uint64_t key = game->fieldHash ^ weightsKey;
+      for (int i = 0; i < figure.size; i++)
+        for (int j = 0; j < figure.size; j++)
+          if (figure.blocks[i * figure.size + j]) {
+            int cell = (figure.y + i) * field.width + figure.x + j;
+            field.blocks[cell] = 1;
+            key ^= hashBlock(cell, 1);
+          }
+      double value;
+      result->evaluations++;
+      if (probeTransposition(table, key, &value)) {
+        result->cached++;
+      } else {
+        value = evaluate(field, weights);
+        storeTransposition(table, key, value);
+      }
+      if (value > best) {
+        best = value;
+        *rotations = r;
+        *column = x;
+      }
+    }
+}
+
+/**
+ * Количество стертых линий по очкам eraseLines()
+ */
+int linesForPoints(int points) {
+  switch (points) {
+    case 100:
+      return 1;
+    case 300:
+      return 2;
+    case 700:
+      return 3;
+    case 1500:
+      return 4;
+    default:
+      return 0;
+  }
+}
+
+/**
+ * Запись установки фигуры в выгрузку
+ *
+ * @param observation наблюдение перед установкой
+ * @param rotations количество поворотов
+ * @param column столбец левого края фигуры
+ * @param reward прирост очков
+ * @param done 1 - партия закончилась на этой фигуре
+ */
+void exportPlacement(NpyWriter* exporter,
+                     const TetrisObservation& observation, uint8_t rotations,
+                     int8_t column, float reward, uint8_t done) {
+  void* record = nextNpyRecord(exporter);
+  setNpyColumn(exporter, record, EXPORT_ROWS, observation.rows);
+  setNpyColumn(exporter, record, EXPORT_FIGURE, observation.figure);
+  setNpyColumn(exporter, record, EXPORT_NEXT, observation.next);
+  setNpyColumn(exporter, record, EXPORT_X, &observation.x);
+  setNpyColumn(exporter, record, EXPORT_Y, &observation.y);
+  setNpyColumn(exporter, record, EXPORT_SCORE, &observation.score);
+  setNpyColumn(exporter, record, EXPORT_ROTATIONS, &rotations);
+  setNpyColumn(exporter, record, EXPORT_COLUMN, &column);
+  setNpyColumn(exporter, record, EXPORT_REWARD, &reward);
+  setNpyColumn(exporter, record, EXPORT_DONE, &done);
+}
+
+/**
+ * Партия бота через userInput(), как у игрока: повороты, сдвиги и сброс
+ * фигуры. Игра своя у каждого потока. С выгрузкой каждая установка
+ * пишется в exporter
+ */
+void playGame(const double* weights, unsigned int seed, unsigned int pieces,
+              TranspositionTable* table, Result* result,
+              NpyWriter* exporter) {
+  seedGame(seed);
+  Game* game = getGame();
+  *result = Result();
+  uint64_t weightsKey = hashWeights(weights);
+  TetrisObservation observation;
+  while (game->playing == PLAYING && result->pieces < pieces) {
+    int rotations, column;
+    choosePlacement(weights, weightsKey, table, &rotations, &column, result);
+    if (exporter) observeTetrisGame(game, &observation);
+    for (int r = 0; r < rotations; r++) userInput(Action, 0);
+    result->steps += rotations;
+    while (game->figure.x != column) {
+      int x = game->figure.x;
+      userInput(x < column ? Right : Left, 0);
+      result->steps++;
+      if (game->figure.x == x) break;
+    }
+    int score = game->score;
+    userInput(Down, 0);
+    result->steps++;
+    result->pieces++;
+    result->lines += linesForPoints(game->score - score);
+    if (exporter) {
+      bool done = game->playing != PLAYING || result->pieces == pieces;
+      exportPlacement(exporter, observation, rotations, column,
+                      game->score - score, done);
+    }
+  }
+  result->score = game->score;
+}
+
+/**
+ * Задача пула: партия index % games набора index / games. Все наборы
+ * поколения играют на одних и тех же зернах
+ */
+void playTask(void* context, unsigned int index, unsigned int) {
+  Generation* generation = static_cast<Generation*>(context);
+  const Individual& individual =
+      (*generation->population)[index / generation->games];
+  playGame(individual.weights, generation->seed + index % generation->games,
+           generation->pieces, generation->table,
+           &(*generation->results)[index], nullptr);
+}
+
+/**
+ * Выбор родителя турниром: лучший из случайной выборки
+ */
+const Individual& tournament(const std::vector<Individual>& population,
+                             uint32_t* random) {
+  size_t size = std::max<size_t>(2, population.size() * TOURNAMENT_SHARE);
+  const Individual* best = nullptr;
+  for (size_t i = 0; i < size; i++) {
+    const Individual& candidate =
+        population[nextRandom(random) % population.size()];
+    if (!best || candidate.fitness > best->fitness) best = &candidate;
+  }
+  return *best;
+}
+
+/**
+ * Потомок двух наборов: среднее весов, взвешенное по приспособленности, и
+ * редкая мутация одного веса
+ */
+Individual crossover(const Individual& a, const Individual& b,
+                     uint32_t* random) {
+  Individual child = Individual();
+  double total = a.fitness + b.fitness;
+  double share = total > 0 ? a.fitness / total : 0.5;
+  for (int i = 0; i < FEATURES; i++)
+    child.weights[i] = a.weights[i] * share + b.weights[i] * (1 - share);
+  if (uniform(random) < MUTATION_CHANCE)
+    child.weights[nextRandom(random) % FEATURES] +=
+        (uniform(random) * 2 - 1) * MUTATION_STEP;
+  normalize(child.weights);
+  return child;
+}
+
+/**
+ * Сохранение популяции следующего поколения и состояния генератора. Файл
+ * пишется во временный и переименовывается, так что прерванный прогон не
+ * портит прошлую контрольную точку
+ *
+ * @return true - популяция сохранена
+ */
+bool saveCheckpoint(const char* path, unsigned int generation,
+                    const std::vector<Individual>& population,
+                    uint32_t random) {
+  std::string temp = std::string(path) + ".tmp";
+  std::FILE* file = std::fopen(temp.c_str(), "w");
+  if (!file) return false;
+  std::fprintf(file, "generation %u population %zu random %u\n", generation,
+               population.size(), random);
+  for (const Individual& individual : population) {
+    for (int i = 0; i < FEATURES; i++)
+      std::fprintf(file, "%.17g ", individual.weights[i]);
+    std::fprintf(file, "%.17g %lu %lu %lu\n", individual.fitness,
+                 individual.lines, individual.score, individual.pieces);
+  }
+  bool written = !std::ferror(file);
+  written = !std::fclose(file) && written;
+  return written && !std::rename(temp.c_str(), path);
+}
+
+/**
+ * Загрузка популяции и состояния генератора из контрольной точки
+ *
+ * @return true - популяция загружена
+ */
+bool loadCheckpoint(const char* path, unsigned int* generation,
+                    std::vector<Individual>* population, uint32_t* random) {
+  std::FILE* file = std::fopen(path, "r");
+  if (!file) return false;
+  size_t size = 0;
+  uint32_t state = 0;
+  bool loaded = std::fscanf(file, "generation %u population %zu random %u",
+                            generation, &size, &state) == 3 &&
+                size > 1;
+  std::vector<Individual> individuals(loaded ? size : 0);
+  for (Individual& individual : individuals) {
+    for (int i = 0; i < FEATURES && loaded; i++)
+      loaded = std::fscanf(file, "%lf", &individual.weights[i]) == 1;
+    loaded = loaded && std::fscanf(file, "%lf %lu %lu %lu",
+                                   &individual.fitness, &individual.lines,
+                                   &individual.score, &individual.pieces) == 4;
+  }
+  std::fclose(file);
+  if (loaded) {
+    population->swap(individuals);
+    *random = state;
+  }
+  return loaded;
+}
+
+/**
+ * Выгрузка партий набора на зернах следующего поколения, которых набор
+ * при подборе не видел
+ *
+ * @return true - файл записан
+ */
+bool exportGames(const char* path, const Individual& individual,
+                 unsigned int games, unsigned int pieces,
+                 unsigned int generation, TranspositionTable* table) {
+  NpyWriter* exporter =
+      openNpyWriter(path, kExportColumns, EXPORT_COLUMNS, NPY_CHUNK_RECORDS);
+  if (!exporter) return false;
+  Result result;
+  unsigned int seed = RANDOM_DEFAULT_SEED + generation * games;
+  for (unsigned int game = 0; game < games; game++)
+    playGame(individual.weights, seed + game, pieces, table, &result,
+             exporter);
+  std::printf("exported %lu placements to %s, %lu stalls\n",
+              getNpyRecords(exporter), path, getNpyStalls(exporter));
+  return !closeNpyWriter(exporter);
+}
+
+}  // namespace
+
+/**
+ * Подбор весов эвристики бота Tetris генетическим алгоритмом. Каждое
+ * поколение все наборы играют одни и те же партии параллельно на всех
+ * ядрах, приспособленность - среднее число стертых линий. Худшие наборы
+ * заменяются потомками лучших, популяция сохраняется после каждого
+ * поколения, с --resume прогон продолжается с контрольной точки. С
+ * параметром --export лучший набор после подбора играет партии на новых
+ * зернах, и каждая установка фигуры пишется в файл .npy
+ */
+int main(int argc, char* argv[]) {
+  unsigned int size = parseNumber(argc, argv, POPULATION_FLAG,
+                                  DEFAULT_POPULATION);
+  unsigned int games = parseNumber(argc, argv, GAMES_FLAG, DEFAULT_GAMES);
+  unsigned int generations =
+      parseNumber(argc, argv, GENERATIONS_FLAG, DEFAULT_GENERATIONS);
+  unsigned int pieces = parseNumber(argc, argv, PIECES_FLAG, DEFAULT_PIECES);
+  unsigned int threads = parseNumber(argc, argv, THREADS_FLAG,
+                                     std::thread::hardware_concurrency());
+  uint32_t random = seedRandom(
+      parseNumber(argc, argv, SEED_FLAG, RANDOM_DEFAULT_SEED));
+  const char* checkpoint =
+      parseString(argc, argv, CHECKPOINT_FLAG, DEFAULT_CHECKPOINT);
+  if (size < 2 || !games) {
+    std::fprintf(stderr, "population must be at least 2, games at least 1\n");
+    return 1;
+  }
+  // Тысячи партий подряд не должны читать и писать файл рекорда
+  *getSaveHighScore() = 0;
+
+  std::vector<Individual> population;
+  unsigned int first = 0;
+  if (hasFlag(argc, argv, RESUME_FLAG) &&
+      loadCheckpoint(checkpoint, &first, &population, &random)) {
+    std::printf("resumed %s at generation %u\n", checkpoint, first);
+    first++;
+  } else {
+    population.resize(size);
+    for (Individual& individual : population) {
+      for (int i = 0; i < FEATURES; i++)
+        individual.weights[i] = uniform(&random) * 2 - 1;
+      normalize(individual.weights);
+    }
+  }
+
+  s21::WorkPool pool(threads);
+  TranspositionTable* table = createTranspositionTable(TRANSPOSITION_BITS);
+  if (!table) {
+    std::fprintf(stderr, "could not allocate transposition table\n");
+    return 1;
+  }
+  std::vector<Result> results(population.size() * games);
+  for (unsigned int g = first; g < first + generations; g++) {
+    Generation generation = {&population, &results, games, pieces,
+                             RANDOM_DEFAULT_SEED + g * games, table};
+    uint64_t start = engineStatsNow();
+    pool.run(playTask, &generation, results.size());
+    double seconds = (engineStatsNow() - start) / 1e9;
+
+    unsigned long steps = 0, totalPieces = 0, evaluations = 0, cached = 0;
+    for (size_t i = 0; i < population.size(); i++) {
+      Individual& individual = population[i];
+      individual.lines = individual.score = individual.pieces = 0;
+      for (unsigned int game = 0; game < games; game++) {
+        const Result& result = results[i * games + game];
+        individual.lines += result.lines;
+        individual.score += result.score;
+        individual.pieces += result.pieces;
+        steps += result.steps;
+        evaluations += result.evaluations;
+        cached += result.cached;
+      }
+      individual.fitness = static_cast<double>(individual.lines) / games;
+      totalPieces += individual.pieces;
+    }
+    std::sort(population.begin(), population.end(),
+              [](const Individual& a, const Individual& b) {
+                return a.fitness > b.fitness;
+              });
+
+    double average = 0;
+    for (const Individual& individual : population)
+      average += individual.fitness / population.size();
+    const Individual& best = population.front();
+    std::printf(
+        "generation %u: best %.1f lines, average %.1f, score %.0f, "
+        "pieces %.0f, %.0f pieces/sec, %.0f inputs/sec\n",
+        g, best.fitness, average, static_cast<double>(best.score) / games,
+        static_cast<double>(best.pieces) / games, totalPieces / seconds,
+        steps / seconds);
+    std::printf("  cached %.1f%% of %lu evaluations\n",
+                evaluations ? 100.0 * cached / evaluations : 0.0, evaluations);
+    std::printf("  weights:");
+    for (int i = 0; i < FEATURES; i++)
+      std::printf(" %s %.3f", kFeatureNames[i], best.weights[i]);
+    std::printf("\n");
+    size_t replaced = population.size() * REPLACE_SHARE;
+    std::vector<Individual> children;
+    for (size_t i = 0; i < replaced; i++)
+      children.push_back(crossover(tournament(population, &random),
+                                   tournament(population, &random), &random));
+    std::copy(children.begin(), children.end(),
+              population.end() - children.size());
+    // Точка сохраняется после замены: продолженный прогон оценивает уже
+    // потомков и тянет тот же ряд случайных чисел
+    if (!saveCheckpoint(checkpoint, g, population, random))
+      std::fprintf(stderr, "could not write %s\n", checkpoint);
+  }
+  std::printf("threads %u, steals %lu\n", pool.getThreads(),
+              pool.getSteals());
+  const char* exportPath = parseString(argc, argv, EXPORT_FLAG, nullptr);
+  if (exportPath && !exportGames(exportPath, population.front(), games,
+                                 pieces, first + generations, table))
+    std::fprintf(stderr, "could not write %s\n", exportPath);
+  freeTranspositionTable(table);
+  return 0;
+}